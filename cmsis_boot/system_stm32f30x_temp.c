@@ -175,6 +175,11 @@ void SystemInit1(void)
   /* FPU settings ------------------------------------------------------------*/
   #if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
     SCB->CPACR |= ((3UL << 10*2)|(3UL << 11*2));  /* set CP10 and CP11 Full Access */
+    /* Lazy stacking: exception entry reserves space for the FPU context, it is
+       only saved if the handler executes a floating-point instruction */
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+    __DSB();
+    __ISB();
   #endif
 
   /* Reset the RCC clock configuration to the default reset state ------------*/
@@ -0,0 +1,44 @@
+/**
+ * @file complementary_filter.h
+ * @brief header file for complementary_filter.c
+ *
+ * @author Urban Zrim
+ * @date 13.4.2015
+ *
+ * Include this file instead of mpu6050.h.
+ */
+
+#ifndef __COMPLEMENTARY_FILTER_H
+#define __COMPLEMENTARY_FILTER_H
+
+#include "mpu6050.h"
+
+/* Filter defaults */
+#define MPU6050_CF_TAU_MS			500		//Time constant, gyro is trusted below it and the accelerometer above
+
+/* Roll, pitch and yaw in Q16.16 degrees */
+typedef struct{
+
+	int32_t roll;				//Rotation about X, -180..180
+	int32_t pitch;				//Rotation about Y, -90..90
+	int32_t yaw;				//Rotation about Z, gyro only, -180..180
+
+}MPU6050_Attitude;
+
+/* Complementary filter state */
+typedef struct{
+
+	MPU6050_Attitude angle;
+	int32_t gyroStep;			//Q16 degrees per raw gyro LSB and sample, 16 fractional bits
+	int32_t alpha;				//Gyro weight, Q16
+	uint8_t started;			//First update takes the accelerometer angles
+	uint32_t cycles;			//Core cycles of the last update
+	uint32_t maxCycles;			//Most core cycles of one update
+
+}MPU6050_CF;
+
+void MPU6050_CF_Init(MPU6050_CF* cf, const MPU6050_Device* dev, uint16_t tauMs, uint32_t periodUs);
+void MPU6050_CF_Update(MPU6050_CF* cf, const MPU6050_rawData* data);
+int32_t MPU6050_CF_Atan2(int32_t y, int32_t x);
+
+#endif /* __COMPLEMENTARY_FILTER_H */
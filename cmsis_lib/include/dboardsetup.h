@@ -5,6 +5,9 @@
  *      Author: Urban Zrim
  */
 
+#ifndef __DBOARDSETUP_H
+#define __DBOARDSETUP_H
+
 #include "stm32f30x.h"
 #include "stm32f30x_usart.h"
 #include "stm32f30x_gpio.h"
@@ -13,6 +16,8 @@
 #include "stm32f30x_spi.h"
 #include "stm32f30x_tim.h"
 #include "stm32f30x_misc.h"
+#include "stm32f30x_syscfg.h"
+#include "i2c_timing.h"
 
 
 #define USART_RX_PIN	GPIO_Pin_5
@@ -21,6 +26,15 @@
 #define I2C_SDA_PIN		GPIO_Pin_9	// PORTB
 #define I2C_SCL_PIN		GPIO_Pin_8	// PORTB
 
+#define SPI_SCK_PIN		GPIO_Pin_13	// PORTB
+#define SPI_MISO_PIN	GPIO_Pin_14	// PORTB
+#define SPI_MOSI_PIN	GPIO_Pin_15	// PORTB
+#define SPI_CS_PIN		GPIO_Pin_12	// PORTB
+
+/* SCL and SDA rise and fall times in ns with 4.7k pull-ups on the sensor board */
+#define I2C_RISE_TIME_NS	250
+#define I2C_FALL_TIME_NS	100
+
 #define TIM2_CH2_PIN	GPIO_Pin_1	// PORTA
 #define TIM2_CH4_PIN	GPIO_Pin_3	// PORTA
 #define TIM2_CH3_PIN	GPIO_Pin_2	// PORTA
@@ -35,7 +49,8 @@ void gpio_init(void);
 void tim_init(void);
 void uart_init(void);
 void int_init(void);
-void i2c_init(void);
+I2C_Speed i2c_init(I2C_Speed speed);
+void spi_init(void);
 
 /* Initializes GPIO ports and pins for F3 breakout board */
 void gpio_init(){
@@ -157,10 +172,25 @@ void tim_init(){
     TIM_Cmd(TIM4, ENABLE);
 }
 
-/* Initializes i2c */
-void i2c_init(){
+/* Initializes i2c
+ * Timing is computed from the I2C1 clock for the requested bus speed, check @i2c_speed.
+ * If the I2C1 clock is too slow for the speed, or the rise and fall times of
+ * the board are too long for it, the next slower speed is used.
+ * Returns the bus speed that was set.
+ */
+I2C_Speed i2c_init(I2C_Speed speed){
+
+	RCC_ClocksTypeDef RCC_Clocks;
+	uint32_t timing;
 
 	RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C1, ENABLE);
+	RCC_GetClocksFreq(&RCC_Clocks);
+
+	speed = I2C_Timing_Select(RCC_Clocks.I2C1CLK_Frequency, speed, I2C_RISE_TIME_NS, I2C_FALL_TIME_NS, &timing);
+
+	/* Fast-mode Plus needs the 20 mA drivers on the I2C1 pins */
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+	SYSCFG_I2CFastModePlusConfig(SYSCFG_I2CFastModePlus_I2C1, (speed == I2C_SPEED_FAST_PLUS) ? ENABLE : DISABLE);
 
 	I2C_InitTypeDef I2C_InitStructure;
 	I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
@@ -169,9 +199,58 @@ void i2c_init(){
 	I2C_InitStructure.I2C_AnalogFilter = I2C_AnalogFilter_Enable;
 	I2C_InitStructure.I2C_DigitalFilter = 0x00;
 	I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
-	I2C_InitStructure.I2C_Timing = 0xF010C0FF;
+	I2C_InitStructure.I2C_Timing = timing;
 	I2C_Init(I2C1, &I2C_InitStructure);
 
 	I2C_Cmd(I2C1, ENABLE);
 
+	return speed;
+}
+
+/* Initializes SPI2 for MPU-6000
+ * Mode 3, 8-bit frames, chip select driven in software. Baud rate is changed
+ * per transfer by the MPU6050 driver.
+ */
+void spi_init(){
+
+	GPIO_InitTypeDef GPIO_InitStructure;
+	SPI_InitTypeDef SPI_InitStructure;
+
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_SPI2, ENABLE);
+
+	/* Set up Alternate function for pins 13, 14 and 15 on port B to SPI2 */
+	GPIO_PinAFConfig(GPIOB, GPIO_PinSource13, GPIO_AF_5);
+	GPIO_PinAFConfig(GPIOB, GPIO_PinSource14, GPIO_AF_5);
+	GPIO_PinAFConfig(GPIOB, GPIO_PinSource15, GPIO_AF_5);
+
+	GPIO_InitStructure.GPIO_Pin = SPI_SCK_PIN | SPI_MISO_PIN | SPI_MOSI_PIN;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+	GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_NOPULL;
+	GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+	/* Chip select, idle high */
+	GPIO_SetBits(GPIOB, SPI_CS_PIN);
+	GPIO_InitStructure.GPIO_Pin = SPI_CS_PIN;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
+	GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_UP;
+	GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+	SPI_StructInit(&SPI_InitStructure);
+	SPI_InitStructure.SPI_Direction = SPI_Direction_2Lines_FullDuplex;
+	SPI_InitStructure.SPI_Mode = SPI_Mode_Master;
+	SPI_InitStructure.SPI_DataSize = SPI_DataSize_8b;
+	SPI_InitStructure.SPI_CPOL = SPI_CPOL_High;
+	SPI_InitStructure.SPI_CPHA = SPI_CPHA_2Edge;
+	SPI_InitStructure.SPI_NSS = SPI_NSS_Soft;
+	SPI_InitStructure.SPI_BaudRatePrescaler = SPI_BaudRatePrescaler_256;
+	SPI_InitStructure.SPI_FirstBit = SPI_FirstBit_MSB;
+	SPI_Init(SPI2, &SPI_InitStructure);
+
+	SPI_RxFIFOThresholdConfig(SPI2, SPI_RxFIFOThreshold_QF);
+	SPI_Cmd(SPI2, ENABLE);
+
 }
+
+#endif /* __DBOARDSETUP_H */
@@ -0,0 +1,25 @@
+/**
+ * @file i2c_timing.h
+ * @brief header file for i2c_timing.c
+ */
+
+#ifndef __I2C_TIMING_H
+#define __I2C_TIMING_H
+
+#include "stm32f30x.h"
+
+/* I2C bus speeds		@i2c_speed */
+typedef enum{
+
+	I2C_SPEED_STANDARD = 100000,	//Standard-mode, 100 kHz
+	I2C_SPEED_FAST = 400000,		//Fast-mode, 400 kHz
+	I2C_SPEED_FAST_PLUS = 1000000	//Fast-mode Plus, 1 MHz
+}I2C_Speed;
+
+/* Slowest TIMINGR setting, used if no speed has a legal setting */
+#define I2C_TIMING_SLOWEST		0xF010C0FF
+
+uint8_t I2C_Timing_Calc(uint32_t clockHz, I2C_Speed speed, uint32_t riseNs, uint32_t fallNs, uint32_t* timing);
+I2C_Speed I2C_Timing_Select(uint32_t clockHz, I2C_Speed speed, uint32_t riseNs, uint32_t fallNs, uint32_t* timing);
+
+#endif /* __I2C_TIMING_H */
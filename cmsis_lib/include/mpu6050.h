@@ -28,10 +28,68 @@
  *  --------------------------------------------------------------------------------
  */
 
+#ifndef __MPU6050_H
+#define __MPU6050_H
+
 #include "stm32f30x_i2c.h"
+#include "stm32f30x_dma.h"
+#include "stm32f30x_rcc.h"
+#include "stm32f30x_misc.h"
+#include "stm32f30x_gpio.h"
+#include "stm32f30x_exti.h"
+#include "stm32f30x_syscfg.h"
+#include "stm32f30x_spi.h"
+#include "stm32f30x_tim.h"
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
 
 #define MPU6050_I2C			I2C1
-#define MPU6050_ADDRESS		0x68
+#define MPU6050_ADDRESS		0x68	//7-bit address with AD0 pin low
+#define MPU6050_ADDRESS_AD0_HIGH	0x69	//7-bit address with AD0 pin high
+
+/* I2C pins, driven as GPIO during bus recovery */
+#define MPU6050_I2C_GPIO_PORT	GPIOB
+#define MPU6050_I2C_SCL_PIN		GPIO_Pin_8
+#define MPU6050_I2C_SDA_PIN		GPIO_Pin_9
+
+/* SPI connection of an MPU-6000 */
+#define MPU6050_SPI				SPI2
+#define MPU6050_SPI_CS_PORT		GPIOB
+#define MPU6050_SPI_CS_PIN		GPIO_Pin_12
+
+/* MPU-6000 SPI clock limits in Hz */
+#define MPU6050_SPI_SLOW_HZ		1000000		//All registers
+#define MPU6050_SPI_FAST_HZ		20000000	//Reading sensor and interrupt registers
+
+/* Register address bit selecting a read over SPI */
+#define MPU6050_SPI_READ		0x80
+
+/* DMA channel serving I2C1_RX requests */
+#define MPU6050_DMA_CHANNEL		DMA1_Channel7
+#define MPU6050_DMA_IRQn		DMA1_Channel7_IRQn
+#define MPU6050_DMA_FLAG_TC		DMA1_FLAG_TC7
+#define MPU6050_DMA_FLAG_TE		DMA1_FLAG_TE7
+#define MPU6050_DMA_FLAG_GL		DMA1_FLAG_GL7
+
+/* MPU6050 INT pin connection */
+#define MPU6050_INT_PORT		GPIOC
+#define MPU6050_INT_PIN			GPIO_Pin_1
+#define MPU6050_INT_CLK			RCC_AHBPeriph_GPIOC
+#define MPU6050_INT_PORT_SOURCE	EXTI_PortSourceGPIOC
+#define MPU6050_INT_PIN_SOURCE	EXTI_PinSource1
+#define MPU6050_INT_EXTI_LINE	EXTI_Line1
+#define MPU6050_INT_IRQn		EXTI1_IRQn
+
+/* 32-bit timer counting microseconds while the MCU sleeps in MPU6050_Motion_Park */
+#define MPU6050_WOM_TIM			TIM2
+#define MPU6050_WOM_TIM_CLK		RCC_APB1Periph_TIM2
+
+/* Number of requests the asynchronous transaction engine can queue */
+#define MPU6050_QUEUE_SIZE		8
+/* Maximum number of data bytes in one asynchronous request */
+#define MPU6050_ASYNC_MAX_BYTES	254
 
 /* Register map */
 #define SELF_TEST_X			0x0D
@@ -43,6 +101,7 @@
 #define GYRO_CONFIG			0x1B
 #define ACCEL_CONFIG		0x1C
 #define MOT_THR				0x1F
+#define MOT_DUR				0x20
 #define FIFO_EN				0x23
 #define I2C_MST_CTRL		0x24
 #define I2C_SLV0_ADDR		0x25
@@ -131,19 +190,278 @@
 #define MPU6050_ACCEL_RANGE_8g		((float)4096)
 #define MPU6050_ACCEL_RANGE_16g		((float)2048)
 
-/* Maximum values for timeout flags waiting loops. These timeouts are not "time" defined
- * and are used just that application doesn't get stuck if I2C communication is corrupted.
+/* Raw data multipliers, folded to integers at compile time. Accelerometer
+ * scales are whole Q16.16 numbers. Gyroscope and temperature scales are not,
+ * their multipliers are Q0.32 and the 64-bit product is rounded back to Q16.16
+ * by MPU6050_Q32_TO_Q16, within one LSB of the exact value for any raw value. */
+#define MPU6050_Q16_SHIFT			16
+#define MPU6050_FRAC_SHIFT			16
+#define MPU6050_GYRO_Q32(range)		((int32_t)(4294967296.0 / (range) + 0.5))	//deg/s per LSB, Q0.32
+#define MPU6050_ACCEL_Q16(range)	((int32_t)(65536000 / (range) + 0.5f))	//mg per LSB
+#define MPU6050_TEMP_Q32_MUL		((int32_t)(4294967296.0 / 340 + 0.5))		//degrees celsius per LSB, Q0.32
+#define MPU6050_TEMP_Q16_OFFSET		((int32_t)(36.53f * 65536 + 0.5f))		//degrees celsius at raw 0
+#define MPU6050_Q32_TO_Q16(raw, mul)	((int32_t)(((int64_t)(raw) * (mul) + (1 << (MPU6050_FRAC_SHIFT - 1))) >> MPU6050_FRAC_SHIFT))
+
+/* GYRO_CONFIG and ACCEL_CONFIG full scale range bits */
+#define MPU6050_RANGE_MASK				0x18
+
+/* Number of configuration registers kept in the register shadow */
+#define MPU6050_SHADOW_SIZE				11
+
+/* Maximum time in microseconds to wait for one I2C flag, measured with the DWT cycle counter.
+ * It must cover one byte at the configured bus speed. When it expires the bus is recovered.
+ */
+#define MPU6050_TIMEOUT_US               (uint32_t)20000
+
+/* Number of bytes from ACCEL_XOUT_H to GYRO_ZOUT_L */
+#define MPU6050_SAMPLE_LENGTH			14
+
+/* Number of EXT_SENS_DATA registers filled by the auxiliary I2C master */
+#define MPU6050_AUX_MAX_BYTES			24
+/* Number of auxiliary slaves read into EXT_SENS_DATA (SLV0..SLV3) */
+#define MPU6050_AUX_MAX_SLAVES			4
+
+/* Maximum number of registers merged into one burst by MPU6050_Write_Table */
+#define MPU6050_WRITE_BURST_MAX			16
+
+/* Number of samples one MPU6050_Block holds */
+#define MPU6050_BLOCK_SIZE				32
+
+/* Maximum number of devices read in one MPU6050_Read_Batch call */
+#define MPU6050_BATCH_MAX				4
+
+/* Size of the internal FIFO buffer in bytes */
+#define MPU6050_FIFO_SIZE				1024
+/* Maximum number of bytes in one FIFO burst (I2C NBYTES is 8 bits wide) */
+#define MPU6050_FIFO_BURST				255
+
+/* FIFO_EN register bits, can be combined with | 	@fifo_sensors */
+#define MPU6050_FIFO_TEMP				0x80
+#define MPU6050_FIFO_XG					0x40
+#define MPU6050_FIFO_YG					0x20
+#define MPU6050_FIFO_ZG					0x10
+#define MPU6050_FIFO_GYRO				(MPU6050_FIFO_XG | MPU6050_FIFO_YG | MPU6050_FIFO_ZG)
+#define MPU6050_FIFO_ACCEL				0x08
+#define MPU6050_FIFO_SLV2				0x04
+#define MPU6050_FIFO_SLV1				0x02
+#define MPU6050_FIFO_SLV0				0x01
+
+/* CONFIG register bits */
+#define MPU6050_DLPF_CFG_MASK			0x07
+
+/* Output data rate and low-pass bandwidth set by MPU6050_Initialization */
+#define MPU6050_DEFAULT_RATE_HZ			1000
+#define MPU6050_DEFAULT_BANDWIDTH_HZ	188
+
+/* DLPF_CFG with the narrowest gyroscope bandwidth that still passes bw Hz */
+#define MPU6050_DLPF_SELECT(bw)		((bw) <= 5 ? 6 : (bw) <= 10 ? 5 : (bw) <= 20 ? 4 : (bw) <= 42 ? 3 : \
+									 (bw) <= 98 ? 2 : (bw) <= 188 ? 1 : 0)
+/* Gyroscope bandwidth in Hz of a DLPF_CFG value */
+#define MPU6050_DLPF_BANDWIDTH(cfg)	((cfg) == 6 ? 5 : (cfg) == 5 ? 10 : (cfg) == 4 ? 20 : (cfg) == 3 ? 42 : \
+									 (cfg) == 2 ? 98 : (cfg) == 1 ? 188 : 256)
+/* Gyroscope output rate in Hz of a DLPF_CFG value, sample rate is this divided by 1 + SMPLRT_DIV */
+#define MPU6050_DLPF_BASE_RATE(cfg)	((cfg) == 0 ? 8000 : 1000)
+
+/* Rate and bandwidth are legal if the rate divides the gyroscope output rate
+ * with SMPLRT_DIV 0..255 and is at least twice the selected bandwidth
  */
-#define MPU6050_FLAG_TIMEOUT             (uint32_t)0x1000
-#define MPU6050_LONG_TIMEOUT             (uint32_t)(10 * MPU6050_FLAG_TIMEOUT)
+#define MPU6050_RATE_VALID(rate, bw)	((rate) > 0 && \
+		MPU6050_DLPF_BASE_RATE(MPU6050_DLPF_SELECT(bw)) % (rate) == 0 && \
+		MPU6050_DLPF_BASE_RATE(MPU6050_DLPF_SELECT(bw)) / (rate) <= 256 && \
+		(rate) >= 2 * MPU6050_DLPF_BANDWIDTH(MPU6050_DLPF_SELECT(bw)))
+
+/* Fails to compile if a constant rate and bandwidth pair is not legal */
+#define MPU6050_RATE_ASSERT(rate, bw)	extern char MPU6050_Rate_Assert[MPU6050_RATE_VALID(rate, bw) ? 1 : -1]
+
+/* USER_CTRL register bits */
+#define MPU6050_USER_FIFO_EN			0x40
+#define MPU6050_USER_I2C_MST_EN			0x20	//Enable auxiliary I2C master
+#define MPU6050_USER_I2C_IF_DIS			0x10	//Disable I2C interface, MPU-6000 on SPI
+#define MPU6050_USER_FIFO_RESET			0x04
+
+/* I2C_MST_CTRL register bits */
+#define MPU6050_MST_WAIT_FOR_ES			0x40	//Delay data ready until external sensor data is loaded
+#define MPU6050_MST_SLV3_FIFO_EN		0x20
+#define MPU6050_MST_P_NSR				0x10	//Stop between reads of consecutive slaves
+#define MPU6050_MST_CLK_MASK			0x0F
+
+/* Auxiliary I2C master clock, I2C_MST_CLK values 	@aux_clock */
+#define MPU6050_AUX_CLK_258KHZ			0x08
+#define MPU6050_AUX_CLK_348KHZ			0x00
+#define MPU6050_AUX_CLK_400KHZ			0x0D
+
+/* I2C_SLVx_ADDR and I2C_SLVx_CTRL register bits */
+#define MPU6050_SLV_READ				0x80
+#define MPU6050_SLV_EN					0x80
+#define MPU6050_SLV_LEN_MASK			0x0F
+
+/* I2C_MST_STATUS register bits */
+#define MPU6050_MST_SLV4_DONE			0x40
+#define MPU6050_MST_SLV4_NACK			0x10
+
+/* INT_PIN_CFG register bits */
+#define MPU6050_INTCFG_INT_LEVEL		0x80	//INT pin active low
+#define MPU6050_INTCFG_INT_OPEN			0x40	//INT pin open drain
+#define MPU6050_INTCFG_LATCH_INT_EN		0x20	//INT pin held until cleared
+#define MPU6050_INTCFG_INT_RD_CLEAR		0x10	//Interrupt status cleared on any read
+#define MPU6050_INTCFG_I2C_BYPASS_EN	0x02	//Connect auxiliary bus to the main I2C bus
+
+/* INT_ENABLE and INT_STATUS register bits */
+#define MPU6050_INT_MOT					0x40
+#define MPU6050_INT_FIFO_OFLOW			0x10
+#define MPU6050_INT_DATA_RDY			0x01
+
+/* ACCEL_CONFIG accelerometer high-pass filter used by motion detection */
+#define MPU6050_ACCEL_HPF_MASK			0x07
+#define MPU6050_ACCEL_HPF_RESET			0x00
+#define MPU6050_ACCEL_HPF_HOLD			0x07
+
+/* MOT_DETECT_CTRL: 1 ms accelerometer power-on delay, motion counter decrement 1 */
+#define MPU6050_MOT_DETECT_DEFAULT		0x15
+
+/* PWR_MGMT_1 register bits */
+#define MPU6050_PWR1_SLEEP				0x40
+#define MPU6050_PWR1_CYCLE				0x20
+#define MPU6050_PWR1_TEMP_DIS			0x08
+#define MPU6050_PWR1_CLKSEL_MASK		0x07
+
+/* PWR_MGMT_2 register bits */
+#define MPU6050_PWR2_LP_WAKE_MASK		0xC0
+#define MPU6050_PWR2_STBY_GYRO			0x07	//STBY_XG, STBY_YG and STBY_ZG
+
+/* Motion threshold resolution, MOT_THR LSB in mg */
+#define MPU6050_MOT_THR_MG				2
+
+/* Longest time in microseconds from a motion interrupt to the first full-rate sample.
+ * Gyroscope start-up from standby takes about 30 ms, the rest is margin.
+ */
+#define MPU6050_WAKE_TIMEOUT_US			(uint32_t)150000
+
+
+/* Sensor on the auxiliary I2C bus, polled by the MPU6050 at the sample rate */
+typedef struct{
+
+	uint8_t address;		//7-bit I2C address
+	uint8_t reg;			//First register to read
+	uint8_t length;			//Number of bytes to read, 1..15
+	uint8_t fifo;			//1 to also write the bytes to the FIFO
+
+}MPU6050_AuxSlave;
+
+/* Interface a sensor is connected with */
+typedef enum{
+
+	MPU6050_INTERFACE_I2C = 0,
+	MPU6050_INTERFACE_SPI = 1		//MPU-6000 only
+}MPU6050_Interface;
+
+/* Bus a sensor is connected to */
+typedef struct{
 
+	MPU6050_Interface interface;
+	I2C_TypeDef* I2Cx;			//I2C peripheral, 0 for SPI
+	SPI_TypeDef* SPIx;			//SPI peripheral, 0 for I2C
+	GPIO_TypeDef* GPIOx;		//Port of SCL and SDA, driven as GPIO during I2C bus recovery
+	uint16_t sclPin;
+	uint16_t sdaPin;
 
+}MPU6050_Bus;
+
+/* One entry of a register write table, check MPU6050_Write_Table */
+typedef struct{
+
+	uint8_t reg;		//Register address
+	uint8_t value;		//Value to write
+
+}MPU6050_RegValue;
+
+/* Transfer and bus recovery statistics of one device */
+typedef struct{
+
+	uint32_t transfers;		//Number of blocking transfers
+	uint32_t errors;		//Number of failed blocking transfers
+	uint32_t recoveries;	//Number of bus recoveries
+	uint32_t lastRecoveryUs;	//Duration of the last recovery in microseconds
+	uint32_t maxRecoveryUs;		//Longest recovery in microseconds
+	uint32_t initUs;			//Duration of MPU6050_Initialization in microseconds
+	uint32_t firstSampleUs;		//Time from the start of MPU6050_Initialization to the first sample, 0 until then
+	uint32_t wakeLatencyUs;		//Time from the last motion interrupt to the first full-rate sample
+	uint32_t maxWakeLatencyUs;	//Longest wake latency in microseconds
+	uint32_t parkedUs;			//Total time spent in MPU6050_Motion_Park waiting for motion
+	uint32_t sleepUs;			//Part of parkedUs the MCU spent in WFI
+
+}MPU6050_stats;
+
+/* Device handle, one per sensor. Initialize with MPU6050_Device_Init */
+typedef struct{
+
+	const MPU6050_Bus* bus;		//Bus the sensor is connected to
+	uint8_t address;			//7-bit I2C address, MPU6050_ADDRESS or MPU6050_ADDRESS_AD0_HIGH
+	GPIO_TypeDef* csPort;		//SPI chip select
+	uint16_t csPin;
+	uint16_t spiSlow;			//SPI baud rate prescaler for MPU6050_SPI_SLOW_HZ
+	uint16_t spiFast;			//SPI baud rate prescaler for MPU6050_SPI_FAST_HZ
+	float gyroMul;		//Gyroscope raw data multiplier, deg/s per LSB
+	float accelMul;		//Accelerometer raw data multiplier, g per LSB
+	int32_t gyroMulQ32;		//Gyroscope raw data multiplier, Q0.32 deg/s per LSB
+	int32_t accelMulQ16;	//Accelerometer raw data multiplier, Q16.16 mg per LSB
+	uint8_t fifoSensors;	//Sensors written to FIFO, check @fifo_sensors
+	uint8_t fifoFrameLen;	//Number of bytes one sample takes in FIFO
+	uint8_t auxLen;			//Number of EXT_SENS_DATA bytes read after each sample
+	uint8_t auxFifoLen;		//Number of auxiliary bytes in one FIFO frame
+	uint8_t auxFifo;		//FIFO_EN bits of auxiliary slaves, SLV3 is set in I2C_MST_CTRL
+	uint8_t shadow[MPU6050_SHADOW_SIZE];	//Register shadow
+	uint16_t shadowValid;		//Bit i set if shadow[i] matches the sensor
+	uint16_t sampleRateHz;		//Output data rate set by MPU6050_Set_Rate
+	uint32_t samplePeriodUs;	//Time between two samples in microseconds
+	uint32_t initStart;			//DWT->CYCCNT at the start of MPU6050_Initialization
+	MPU6050_stats stats;
+
+}MPU6050_Device;
+
+/* One complete raw sample as read from ACCEL_XOUT_H..GYRO_ZOUT_L */
 typedef struct{
 
-	float gyroMul;		//Gyroscope raw data multiplier
-	float accelMul;		//Accelerometer raw data multiplier
+	int16_t accelX;
+	int16_t accelY;
+	int16_t accelZ;
+	int16_t temp;		//Raw temperature
+	int16_t gyroX;
+	int16_t gyroY;
+	int16_t gyroZ;
 
-}MPU6050_dataStruct;
+}MPU6050_rawData;
+
+/* One sample converted to Q16.16 fixed point */
+typedef struct{
+
+	int32_t accelX;		//mg
+	int32_t accelY;
+	int32_t accelZ;
+	int32_t temp;		//Degrees celsius
+	int32_t gyroX;		//deg/s
+	int32_t gyroY;
+	int32_t gyroZ;
+
+}MPU6050_fixedData;
+
+/* Block of raw samples stored as one array per channel, oldest sample first.
+ * Batch stages (FIFO drain, calibration, filters, telemetry) work on the
+ * arrays in place.
+ */
+typedef struct{
+
+	int16_t accelX[MPU6050_BLOCK_SIZE];
+	int16_t accelY[MPU6050_BLOCK_SIZE];
+	int16_t accelZ[MPU6050_BLOCK_SIZE];
+	int16_t temp[MPU6050_BLOCK_SIZE];
+	int16_t gyroX[MPU6050_BLOCK_SIZE];
+	int16_t gyroY[MPU6050_BLOCK_SIZE];
+	int16_t gyroZ[MPU6050_BLOCK_SIZE];
+	uint32_t timestamp[MPU6050_BLOCK_SIZE];		//Sample time in microseconds, check MPU6050_Time_Us
+	uint16_t count;								//Number of valid samples
+
+}MPU6050_Block;
 
 typedef enum{
 	/* MPU6050 I2C success */
@@ -154,9 +472,44 @@ typedef enum{
 	MPU6050_I2C_TX_ERROR = 2,
 	/* TX error */
 	MPU6050_I2C_RX_ERROR = 3,
+	/* FIFO overflowed, samples were lost and FIFO was reset */
+	MPU6050_FIFO_OVERFLOW = 4,
+	/* Asynchronous request queue is full */
+	MPU6050_QUEUE_FULL = 5,
+	/* Slave did not acknowledge address or data */
+	MPU6050_I2C_NACK = 6,
+	/* SPI transfer timed out */
+	MPU6050_SPI_ERROR = 7,
+	/* Requested configuration is not supported by the sensor, or an argument is out of range */
+	MPU6050_CONFIG_ERROR = 8,
+	/* No sample arrived within MPU6050_WAKE_TIMEOUT_US after motion */
+	MPU6050_WAKE_TIMEOUT = 9,
 
 }MPU6050_errorstatus;
 
+/* Called when an asynchronous transfer finishes, status is @MPU6050_errorstatus */
+typedef void (*MPU6050_Callback)(MPU6050_errorstatus status);
+
+/* Direction of an asynchronous request */
+typedef enum{
+
+	MPU6050_ASYNC_READ = 0,
+	MPU6050_ASYNC_WRITE = 1
+}MPU6050_Direction;
+
+/* Queued asynchronous I2C request */
+typedef struct{
+
+	MPU6050_Device* dev;			//Device recovered when the request times out
+	uint8_t SlaveAddr;				//Slave I2C address
+	uint8_t RegAddr;				//First register address
+	uint8_t* pBuffer;				//Buffer to read to or write from
+	uint8_t NumBytes;				//Number of data bytes
+	MPU6050_Direction direction;
+	MPU6050_Callback callback;		//Called from interrupt when request is done, can be 0
+
+}MPU6050_Request;
+
 /* Gyroscope Full scale range options 	@gyro_scale_range */
 typedef enum{
 
@@ -176,6 +529,16 @@ typedef enum{
 	MPU6050_ACCEL_16g = 0x18
 }MPU6050_Accel_Range;
 
+/* Sensor configuration, check MPU6050_Initialization_Config */
+typedef struct{
+
+	MPU6050_Gyro_Range gyroRange;
+	MPU6050_Accel_Range accelRange;
+	uint16_t rateHz;			//Output data rate in Hz
+	uint16_t bandwidthHz;		//Lowest acceptable gyroscope bandwidth in Hz
+
+}MPU6050_Config;
+
 /* Power management 1 	@pwr_mngt_1 */
 typedef enum{
 
@@ -188,27 +551,117 @@ typedef enum{
 	MPU6050_STOP_CLOCK = 0x07
 }MPU6050_Clock_Select;
 
-MPU6050_errorstatus MPU6050_Read(uint8_t SlaveAddr, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead);
-MPU6050_errorstatus MPU6050_Write(uint8_t SlaveAddr, uint8_t RegAddr, uint8_t* pBuffer);
-MPU6050_errorstatus MPU6050_Test(void);
+/* Accelerometer wake-up rate in cycle mode, PWR_MGMT_2 LP_WAKE_CTRL		@wake_rate */
+typedef enum{
+
+	MPU6050_WAKE_1_25HZ = 0x00,
+	MPU6050_WAKE_5HZ = 0x40,
+	MPU6050_WAKE_20HZ = 0x80,
+	MPU6050_WAKE_40HZ = 0xC0
+}MPU6050_Wake_Rate;
+
+/* I2C1 on PB8 (SCL) and PB9 (SDA) */
+extern const MPU6050_Bus MPU6050_Bus1;
+/* SPI2 on PB13 (SCK), PB14 (MISO) and PB15 (MOSI) */
+extern const MPU6050_Bus MPU6050_SPI_Bus2;
+
+void MPU6050_Device_Init(MPU6050_Device* dev, const MPU6050_Bus* bus, uint8_t address);
+void MPU6050_Device_Init_SPI(MPU6050_Device* dev, const MPU6050_Bus* bus, GPIO_TypeDef* csPort, uint16_t csPin);
+
+MPU6050_errorstatus MPU6050_Read(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead);
+MPU6050_errorstatus MPU6050_Write(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToWrite);
+MPU6050_errorstatus MPU6050_Test(MPU6050_Device* dev);
+
+/* Timeout and bus recovery functions */
+void MPU6050_Timebase_Init(void);
+uint32_t MPU6050_Time_Us(void);
+void MPU6050_Bus_Recover(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_Shadow_Restore(MPU6050_Device* dev);
+
+/* Register shadow functions */
+MPU6050_errorstatus MPU6050_Write_Reg(MPU6050_Device* dev, uint8_t RegAddr, uint8_t value);
+MPU6050_errorstatus MPU6050_Read_Reg(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* value);
+MPU6050_errorstatus MPU6050_Modify_Reg(MPU6050_Device* dev, uint8_t RegAddr, uint8_t mask, uint8_t value);
+MPU6050_errorstatus MPU6050_Write_Regs(MPU6050_Device* dev, uint8_t RegAddr, const uint8_t* values, uint8_t count);
+MPU6050_errorstatus MPU6050_Write_Table(MPU6050_Device* dev, const MPU6050_RegValue* table, uint8_t count);
+MPU6050_errorstatus MPU6050_Shadow_Resync(MPU6050_Device* dev);
+
+/* DMA receive path, only for devices on MPU6050_I2C */
+void MPU6050_DMA_Config(void);
+MPU6050_errorstatus MPU6050_Read_DMA(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead, MPU6050_Callback callback);
+uint8_t MPU6050_DMA_Busy(void);
+MPU6050_errorstatus MPU6050_DMA_Status(void);
+
+/* Interrupt driven asynchronous transaction engine, only for devices on MPU6050_I2C */
+void MPU6050_Async_Config(void);
+MPU6050_errorstatus MPU6050_Read_Async(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint8_t NumByteToRead, MPU6050_Callback callback);
+MPU6050_errorstatus MPU6050_Write_Async(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint8_t NumByteToWrite, MPU6050_Callback callback);
+uint8_t MPU6050_Async_Pending(void);
 
 /* Gyroscope Full scale range functions */
-uint8_t MPU6050_Gyro_Get_Range(void);
-MPU6050_errorstatus MPU6050_Gyro_Set_Range(MPU6050_Gyro_Range range);
+uint8_t MPU6050_Gyro_Get_Range(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_Gyro_Set_Range(MPU6050_Device* dev, MPU6050_Gyro_Range range);
 
 /* Accelerometer Full scale range functions */
-MPU6050_errorstatus MPU6050_Accel_Get_Range(void);
-MPU6050_errorstatus MPU6050_Accel_Set_Range(MPU6050_Accel_Range range);
+uint8_t MPU6050_Accel_Get_Range(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_Accel_Set_Range(MPU6050_Device* dev, MPU6050_Accel_Range range);
 
-MPU6050_errorstatus MPU6050_Accel_Config(void);
-MPU6050_errorstatus MPU6050_Set_Clock(MPU6050_Clock_Select clock);
+MPU6050_errorstatus MPU6050_Set_Clock(MPU6050_Device* dev, MPU6050_Clock_Select clock);
+MPU6050_errorstatus MPU6050_Set_Rate(MPU6050_Device* dev, uint16_t rateHz, uint16_t bandwidthHz);
 
-MPU6050_errorstatus MPU6050_Initialization(void);
+MPU6050_errorstatus MPU6050_Initialization(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_Initialization_Config(MPU6050_Device* dev, const MPU6050_Config* config);
 
 /* Data functions prototypes */
-MPU6050_errorstatus MPU6050_Get_Gyro_Data_Raw(int16_t* X, int16_t* Y, int16_t* Z);
-MPU6050_errorstatus MPU6050_Get_Accel_Data_Raw(int16_t* X, int16_t* Y, int16_t* Z);
-MPU6050_errorstatus MPU6050_Get_Gyro_Data(float* X, float* Y, float* Z);
-MPU6050_errorstatus MPU6050_Get_Accel_Data(float* X, float* Y, float* Z);
-int16_t MPU6050_Get_Temperature(void);
+MPU6050_errorstatus MPU6050_Get_Gyro_Data_Raw(MPU6050_Device* dev, int16_t* X, int16_t* Y, int16_t* Z);
+MPU6050_errorstatus MPU6050_Get_Accel_Data_Raw(MPU6050_Device* dev, int16_t* X, int16_t* Y, int16_t* Z);
+MPU6050_errorstatus MPU6050_Get_All_Data_Raw(MPU6050_Device* dev, MPU6050_rawData* data);
+MPU6050_errorstatus MPU6050_Get_Gyro_Data(MPU6050_Device* dev, float* X, float* Y, float* Z);
+MPU6050_errorstatus MPU6050_Get_Accel_Data(MPU6050_Device* dev, float* X, float* Y, float* Z);
+int16_t MPU6050_Get_Temperature(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_Get_Gyro_Data_Fixed(MPU6050_Device* dev, int32_t* X, int32_t* Y, int32_t* Z);
+MPU6050_errorstatus MPU6050_Get_Accel_Data_Fixed(MPU6050_Device* dev, int32_t* X, int32_t* Y, int32_t* Z);
+void MPU6050_Convert_Fixed(MPU6050_Device* dev, const MPU6050_rawData* raw, MPU6050_fixedData* out);
+
+/* Multiple device functions */
+MPU6050_errorstatus MPU6050_Read_Batch(MPU6050_Device** devs, uint8_t count, MPU6050_rawData* samples);
+void MPU6050_Average_Samples(const MPU6050_rawData* samples, uint8_t count, MPU6050_rawData* average);
+
+/* Auxiliary I2C master functions */
+MPU6050_errorstatus MPU6050_Aux_Enable(MPU6050_Device* dev, uint8_t clock);
+MPU6050_errorstatus MPU6050_Aux_Disable(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_Aux_Write_Reg(MPU6050_Device* dev, uint8_t address, uint8_t RegAddr, uint8_t value);
+MPU6050_errorstatus MPU6050_Aux_Read_Reg(MPU6050_Device* dev, uint8_t address, uint8_t RegAddr, uint8_t* value);
+MPU6050_errorstatus MPU6050_Aux_Config_Slaves(MPU6050_Device* dev, const MPU6050_AuxSlave* slaves, uint8_t count);
+MPU6050_errorstatus MPU6050_Get_All_Data_Aux(MPU6050_Device* dev, MPU6050_rawData* data, uint8_t* aux);
+
+/* FIFO functions prototypes */
+MPU6050_errorstatus MPU6050_FIFO_Config(MPU6050_Device* dev, uint8_t sensors);
+MPU6050_errorstatus MPU6050_FIFO_Reset(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_FIFO_Get_Count(MPU6050_Device* dev, uint16_t* count);
+MPU6050_errorstatus MPU6050_FIFO_Read_Samples(MPU6050_Device* dev, MPU6050_rawData* samples, uint16_t maxSamples, uint16_t* numSamples);
+MPU6050_errorstatus MPU6050_FIFO_Read_Samples_Aux(MPU6050_Device* dev, MPU6050_rawData* samples, uint8_t* aux, uint16_t maxSamples, uint16_t* numSamples);
+MPU6050_errorstatus MPU6050_FIFO_Read_Block(MPU6050_Device* dev, MPU6050_Block* block, uint16_t* numSamples);
+
+/* Data ready interrupt acquisition, only for a device on MPU6050_I2C or SPI */
+MPU6050_errorstatus MPU6050_DRDY_Config(MPU6050_Device* dev);
+uint8_t MPU6050_DRDY_Get_Sample(MPU6050_rawData* data);
+uint8_t MPU6050_DRDY_Get_Sample_Aux(MPU6050_rawData* data, uint8_t* aux);
+uint32_t MPU6050_DRDY_Missed(void);
+uint8_t MPU6050_DRDY_Get_Block(MPU6050_Block* block);
+
+/* Sample block functions */
+void MPU6050_Block_Reset(MPU6050_Block* block);
+uint8_t MPU6050_Block_Append(MPU6050_Block* block, const MPU6050_rawData* data, uint32_t timestamp);
+void MPU6050_Block_Get(const MPU6050_Block* block, uint16_t index, MPU6050_rawData* data);
+
+MPU6050_errorstatus MPU6050_Motion_Enter(MPU6050_Device* dev, uint16_t thresholdMg, MPU6050_Wake_Rate rate);
+MPU6050_errorstatus MPU6050_Motion_Exit(MPU6050_Device* dev);
+MPU6050_errorstatus MPU6050_Motion_Park(MPU6050_Device* dev, uint16_t thresholdMg, MPU6050_Wake_Rate rate);
+uint16_t MPU6050_Motion_Duty(MPU6050_Device* dev);
+
+#ifdef __cplusplus
+}
+#endif
 
+#endif /* __MPU6050_H */
@@ -0,0 +1,171 @@
+/**
+ * @file mpu6050.hpp
+ * @brief C++ front end for mpu6050.c with the configuration fixed at compile time
+ *
+ * Range, rate and bandwidth are template parameters, so scale factors and
+ * register values are constants and illegal configurations do not compile.
+ * Bus access goes through the C driver, the device handle stays usable with
+ * every C function. Include this file instead of mpu6050.h, C++11 or newer.
+ *
+ *	Mpu6050<MPU6050_Bus1, MPU6050_ADDRESS, MPU6050_GYRO_500, MPU6050_ACCEL_4g, 500, 98> imu;
+ *	imu.init();
+ *	imu.readFixed(sample);
+ */
+
+#ifndef __MPU6050_HPP
+#define __MPU6050_HPP
+
+#include "mpu6050.h"
+
+/* LSB sensitivity of a gyroscope range */
+constexpr float MPU6050_Gyro_Lsb(MPU6050_Gyro_Range range){
+
+	return range == MPU6050_GYRO_250 ? MPU6050_GYRO_RANGE_250 :
+		   range == MPU6050_GYRO_500 ? MPU6050_GYRO_RANGE_500 :
+		   range == MPU6050_GYRO_1000 ? MPU6050_GYRO_RANGE_1000 : MPU6050_GYRO_RANGE_2000;
+}
+
+/* LSB sensitivity of an accelerometer range */
+constexpr float MPU6050_Accel_Lsb(MPU6050_Accel_Range range){
+
+	return range == MPU6050_ACCEL_2g ? MPU6050_ACCEL_RANGE_2g :
+		   range == MPU6050_ACCEL_4g ? MPU6050_ACCEL_RANGE_4g :
+		   range == MPU6050_ACCEL_8g ? MPU6050_ACCEL_RANGE_8g : MPU6050_ACCEL_RANGE_16g;
+}
+
+/* One sample converted to float, g and deg/s */
+struct MPU6050_floatData{
+
+	float accelX;
+	float accelY;
+	float accelZ;
+	float gyroX;
+	float gyroY;
+	float gyroZ;
+};
+
+/* @brief MPU6050 with compile-time configuration
+ *
+ * @param Bus - bus the sensor is connected to, e.g. MPU6050_Bus1
+ * @param Address - 7-bit I2C address, ignored on SPI
+ * @param GyroRange - check @MPU6050_Gyro_Range
+ * @param AccelRange - check @MPU6050_Accel_Range
+ * @param RateHz - output data rate in Hz
+ * @param BandwidthHz - lowest acceptable gyroscope bandwidth in Hz
+ */
+template<const MPU6050_Bus& Bus, uint8_t Address, MPU6050_Gyro_Range GyroRange, MPU6050_Accel_Range AccelRange,
+		 uint16_t RateHz = MPU6050_DEFAULT_RATE_HZ, uint16_t BandwidthHz = MPU6050_DEFAULT_BANDWIDTH_HZ>
+class Mpu6050{
+
+public:
+
+	static_assert(Address == MPU6050_ADDRESS || Address == MPU6050_ADDRESS_AD0_HIGH, "MPU6050 address is 0x68 or 0x69");
+	static_assert(MPU6050_RATE_VALID(RateHz, BandwidthHz), "rate must divide the gyroscope output rate and be at least twice the bandwidth");
+
+	/* Register values */
+	static constexpr uint8_t dlpfCfg = MPU6050_DLPF_SELECT(BandwidthHz);
+	static constexpr uint8_t smplrtDiv = MPU6050_DLPF_BASE_RATE(dlpfCfg) / RateHz - 1;
+	static constexpr uint8_t gyroConfig = (uint8_t)GyroRange;
+	static constexpr uint8_t accelConfig = (uint8_t)AccelRange;
+
+	/* Scale factors */
+	static constexpr float gyroMul = 1 / MPU6050_Gyro_Lsb(GyroRange);
+	static constexpr float accelMul = 1 / MPU6050_Accel_Lsb(AccelRange);
+	static constexpr int32_t gyroMulQ32 = MPU6050_GYRO_Q32(MPU6050_Gyro_Lsb(GyroRange));
+	static constexpr int32_t accelMulQ16 = MPU6050_ACCEL_Q16(MPU6050_Accel_Lsb(AccelRange));
+
+	/* Timing and transfer sizes */
+	static constexpr uint32_t samplePeriodUs = 1000000 / RateHz;
+	static constexpr uint8_t burstLength = MPU6050_SAMPLE_LENGTH;
+
+	/* @brief Sensor on I2C */
+	Mpu6050(){
+
+		MPU6050_Device_Init(&dev, &Bus, Address);
+	}
+
+	/* @brief MPU-6000 on SPI, check MPU6050_Device_Init_SPI */
+	Mpu6050(GPIO_TypeDef* csPort, uint16_t csPin){
+
+		MPU6050_Device_Init_SPI(&dev, &Bus, csPort, csPin);
+	}
+
+	/* @brief Writes the configuration, replaces MPU6050_Initialization
+	 * @retval @MPU6050_errorstatus
+	 */
+	MPU6050_errorstatus init(){
+
+		static const MPU6050_Config config = {GyroRange, AccelRange, RateHz, BandwidthHz};
+
+		return MPU6050_Initialization_Config(&dev, &config);
+	}
+
+	/* @brief Read one raw sample in one burst, check MPU6050_Get_All_Data_Raw */
+	MPU6050_errorstatus readRaw(MPU6050_rawData& data){
+
+		return MPU6050_Get_All_Data_Raw(&dev, &data);
+	}
+
+	/* @brief Read one sample in Q16.16 mg, degrees celsius and deg/s */
+	MPU6050_errorstatus readFixed(MPU6050_fixedData& data){
+
+		MPU6050_rawData raw;
+		MPU6050_errorstatus errorstatus;
+
+		errorstatus = readRaw(raw);
+		if(errorstatus != 0) return errorstatus;
+
+		convert(raw, data);
+
+		return MPU6050_NO_ERROR;
+	}
+
+	/* @brief Read one sample in g and deg/s */
+	MPU6050_errorstatus read(MPU6050_floatData& data){
+
+		MPU6050_rawData raw;
+		MPU6050_errorstatus errorstatus;
+
+		errorstatus = readRaw(raw);
+		if(errorstatus != 0) return errorstatus;
+
+		convert(raw, data);
+
+		return MPU6050_NO_ERROR;
+	}
+
+	/* @brief Convert a raw sample of this device, e.g. from MPU6050_DRDY_Get_Sample */
+	static void convert(const MPU6050_rawData& raw, MPU6050_fixedData& data){
+
+		data.accelX = raw.accelX * accelMulQ16;
+		data.accelY = raw.accelY * accelMulQ16;
+		data.accelZ = raw.accelZ * accelMulQ16;
+		data.temp = MPU6050_Q32_TO_Q16(raw.temp, MPU6050_TEMP_Q32_MUL) + MPU6050_TEMP_Q16_OFFSET;
+		data.gyroX = MPU6050_Q32_TO_Q16(raw.gyroX, gyroMulQ32);
+		data.gyroY = MPU6050_Q32_TO_Q16(raw.gyroY, gyroMulQ32);
+		data.gyroZ = MPU6050_Q32_TO_Q16(raw.gyroZ, gyroMulQ32);
+	}
+
+	/* @brief Convert a raw sample of this device to g and deg/s */
+	static void convert(const MPU6050_rawData& raw, MPU6050_floatData& data){
+
+		data.accelX = raw.accelX * accelMul;
+		data.accelY = raw.accelY * accelMul;
+		data.accelZ = raw.accelZ * accelMul;
+		data.gyroX = raw.gyroX * gyroMul;
+		data.gyroY = raw.gyroY * gyroMul;
+		data.gyroZ = raw.gyroZ * gyroMul;
+	}
+
+	/* @brief Device handle for the C functions, e.g. FIFO or data ready */
+	MPU6050_Device* device(){
+
+		return &dev;
+	}
+
+private:
+
+	MPU6050_Device dev;
+};
+
+#endif /* __MPU6050_HPP */
@@ -0,0 +1,47 @@
+/**
+ * @file mpu6050_ahrs.h
+ * @brief header file for mpu6050_ahrs.c
+ *
+ * Include this file instead of mpu6050.h.
+ */
+
+#ifndef __MPU6050_AHRS_H
+#define __MPU6050_AHRS_H
+
+#include "mpu6050.h"
+
+/* Filter defaults */
+#define MPU6050_AHRS_BETA_MILLI		100		//Gradient step beta in thousandths, rad/s
+
+/* Fractional bits of the fixed-point quaternion, 1.0 = 2^30 */
+#define MPU6050_AHRS_Q30			30
+
+/* Madgwick filter state, float build */
+typedef struct{
+
+	float q[4];					//Attitude quaternion w, x, y, z, sensor to earth
+	float gyroHalfDt;			//Half rotation angle per raw gyro LSB and sample, rad
+	float betaDt;				//beta * dt
+	uint32_t cycles;			//Core cycles of the last update
+	uint32_t maxCycles;			//Most core cycles of one update
+
+}MPU6050_AHRS;
+
+/* Madgwick filter state, fixed-point build */
+typedef struct{
+
+	int32_t q[4];				//Attitude quaternion w, x, y, z, Q30
+	int32_t gyroHalfDt;			//Half rotation angle per raw gyro LSB and sample, Q46 rad
+	int32_t betaDt;				//beta * dt, Q30
+	uint32_t cycles;			//Core cycles of the last update
+	uint32_t maxCycles;			//Most core cycles of one update
+
+}MPU6050_AHRS_Fixed;
+
+void MPU6050_AHRS_Init(MPU6050_AHRS* ahrs, const MPU6050_Device* dev, uint16_t betaMilli, uint32_t periodUs);
+void MPU6050_AHRS_Update(MPU6050_AHRS* ahrs, const MPU6050_rawData* data);
+void MPU6050_AHRS_Get_Euler(const MPU6050_AHRS* ahrs, float* roll, float* pitch, float* yaw);
+void MPU6050_AHRS_Fixed_Init(MPU6050_AHRS_Fixed* ahrs, const MPU6050_Device* dev, uint16_t betaMilli, uint32_t periodUs);
+void MPU6050_AHRS_Fixed_Update(MPU6050_AHRS_Fixed* ahrs, const MPU6050_rawData* data);
+
+#endif /* __MPU6050_AHRS_H */
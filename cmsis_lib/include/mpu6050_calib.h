@@ -0,0 +1,125 @@
+/**
+ * @file mpu6050_calib.h
+ * @brief header file for mpu6050_calib.c
+ *
+ * Include this file instead of mpu6050.h.
+ */
+
+#ifndef __MPU6050_CALIB_H
+#define __MPU6050_CALIB_H
+
+#include "mpu6050.h"
+#include "mpu6050_calib_params.h"
+
+/* Stillness detector defaults */
+#define MPU6050_STILL_GYRO_DPS		2		//Largest gyro deviation from the bias at rest, deg/s
+#define MPU6050_STILL_ACCEL_MG		30		//Largest accelerometer change between samples at rest, mg
+#define MPU6050_STILL_SAMPLES		200		//Consecutive samples at rest before the bias is tracked
+
+/* Online gyro bias tracking, the bias moves by 1/2^MPU6050_BIAS_TRACK_SHIFT of the error per sample */
+#define MPU6050_BIAS_TRACK_SHIFT	10
+
+/* Fractional bits of the stored bias */
+#define MPU6050_BIAS_FRAC			8
+
+/* Thermal bias model, cubic polynomial of the temperature change */
+#define MPU6050_THERMAL_ORDER		3
+#define MPU6050_THERMAL_STEP_MC		100		//Default temperature change in millidegrees that triggers a new evaluation
+
+/* Bias estimator state		@bias_state */
+typedef enum{
+
+	MPU6050_BIAS_STARTUP = 0,	//Collecting stationary samples, no correction yet
+	MPU6050_BIAS_MOVING = 1,	//Estimate valid, device is moving
+	MPU6050_BIAS_STILL = 2		//Estimate valid, gyro bias is being tracked
+}MPU6050_Bias_State;
+
+/* Sensor axis that points up while the startup samples are taken		@gravity_axis
+ * Accelerometer reads +1 g on an axis pointing up, -1 g on one pointing down */
+typedef enum{
+
+	MPU6050_GRAVITY_AUTO = 0,	//Axis with the largest mean reading, with its sign
+	MPU6050_GRAVITY_X_UP = 1,
+	MPU6050_GRAVITY_X_DOWN = 2,
+	MPU6050_GRAVITY_Y_UP = 3,
+	MPU6050_GRAVITY_Y_DOWN = 4,
+	MPU6050_GRAVITY_Z_UP = 5,
+	MPU6050_GRAVITY_Z_DOWN = 6
+}MPU6050_Gravity_Axis;
+
+/* Gyro and accelerometer offsets in raw LSB with MPU6050_BIAS_FRAC fractional bits */
+typedef struct{
+
+	int32_t gyro[3];			//Gyro bias
+	int32_t accel[3];			//Accelerometer offset, gravity removed
+	int16_t gravity[3];			//Expected accelerometer reading at rest, raw LSB
+	int16_t oneG;				//1 g in raw LSB at the accelerometer range
+	MPU6050_Gravity_Axis gravityAxis;
+	int16_t gyroStill;			//Stillness threshold, raw gyro LSB
+	int16_t accelStill;			//Stillness threshold, raw accelerometer LSB
+	int32_t sum[6];				//Startup sums, accelerometer X, Y, Z then gyro X, Y, Z
+	uint16_t samples;			//Number of stationary samples for the startup estimate
+	uint16_t count;				//Samples summed or consecutive samples at rest
+	MPU6050_rawData last;		//Previous sample, for the stillness detector
+	uint8_t hasLast;
+	MPU6050_Bias_State state;
+
+}MPU6050_Bias;
+
+void MPU6050_Bias_Init(MPU6050_Bias* bias, MPU6050_Device* dev, uint16_t samples, MPU6050_Gravity_Axis gravity);
+MPU6050_Bias_State MPU6050_Bias_Update(MPU6050_Bias* bias, const MPU6050_rawData* data);
+MPU6050_Bias_State MPU6050_Bias_Update_Block(MPU6050_Bias* bias, const MPU6050_Block* block);
+void MPU6050_Bias_Apply(const MPU6050_Bias* bias, MPU6050_rawData* data);
+void MPU6050_Bias_Apply_Block(const MPU6050_Bias* bias, MPU6050_Block* block);
+
+/* Calibration of one sensor triplet prepared for the multiply-accumulate kernel */
+typedef struct{
+
+	uint32_t offsetXY;			//X and Y offset packed into one word
+	int16_t offsetZ;
+	uint32_t rowXY[3];			//First two coefficients of each row packed into one word
+	int16_t rowZ[3];			//Last coefficient of each row
+
+}MPU6050_Calib_Triplet;
+
+/* Calibration of a device */
+typedef struct{
+
+	MPU6050_Calib_Triplet accel;
+	MPU6050_Calib_Triplet gyro;
+
+}MPU6050_Calib;
+
+uint8_t MPU6050_Calib_Init(MPU6050_Calib* calib, const MPU6050_Calib_Params* params);
+void MPU6050_Calib_Identity(MPU6050_Calib_Params* params);
+void MPU6050_Calib_Apply(const MPU6050_Calib* calib, MPU6050_rawData* data);
+void MPU6050_Calib_Apply_Block(const MPU6050_Calib* calib, MPU6050_Block* block);
+
+/* Temperature dependent bias, bias(dT) = c[0] + c[1] * dT + ... + c[ORDER] * dT^ORDER
+ * dT in degrees celsius from refTemp, bias in raw LSB, coefficients with 16 fractional bits.
+ * Axes in order accelerometer X, Y, Z then gyro X, Y, Z.
+ */
+typedef struct{
+
+	int16_t refTemp;										//Raw TEMP_OUT at the reference temperature
+	int32_t coeff[6][MPU6050_THERMAL_ORDER + 1];			//Lowest order first
+
+}MPU6050_Thermal_Params;
+
+/* Thermal compensation state */
+typedef struct{
+
+	const MPU6050_Thermal_Params* params;
+	int16_t offset[6];			//Bias at lastTemp, raw LSB
+	int16_t lastTemp;			//Raw temperature of the last evaluation
+	int16_t step;				//Raw temperature change that triggers a new evaluation
+	uint8_t valid;
+
+}MPU6050_Thermal;
+
+void MPU6050_Thermal_Init(MPU6050_Thermal* thermal, const MPU6050_Thermal_Params* params, uint16_t stepMilliC);
+uint8_t MPU6050_Thermal_Update(MPU6050_Thermal* thermal, int16_t temp);
+void MPU6050_Thermal_Apply(MPU6050_Thermal* thermal, MPU6050_rawData* data);
+void MPU6050_Thermal_Apply_Block(MPU6050_Thermal* thermal, MPU6050_Block* block);
+
+#endif /* __MPU6050_CALIB_H */
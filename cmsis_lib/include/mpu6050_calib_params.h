@@ -0,0 +1,39 @@
+/**
+ * @file mpu6050_calib_params.h
+ * @brief Calibration blob layout shared by mpu6050_calib.c and the host fitting tool
+ *
+ * Plain C, no STM32 headers, so tools/mpu6050_calfit.cpp builds against it on the host.
+ */
+
+#ifndef __MPU6050_CALIB_PARAMS_H
+#define __MPU6050_CALIB_PARAMS_H
+
+#include <stdint.h>
+
+/* Fractional bits of the calibration matrix, 1.0 = 16384 */
+#define MPU6050_MATRIX_FRAC			14
+#define MPU6050_MATRIX_ONE			(1 << MPU6050_MATRIX_FRAC)
+
+/* First field of a valid MPU6050_Calib_Params blob */
+#define MPU6050_CALIB_MAGIC			0x4D43
+
+/* Size of a MPU6050_Calib_Params blob, magic + 2 * (3 offsets + 9 coefficients), int16 each */
+#define MPU6050_CALIB_PARAMS_SIZE	50
+
+/* Misalignment and scale calibration as stored in flash or produced by the host
+ * fitting tool, out = M * (raw - offset). Little endian, no padding.
+ */
+typedef struct{
+
+	uint16_t magic;				//MPU6050_CALIB_MAGIC
+	int16_t accelOffset[3];		//Raw LSB
+	int16_t accelMatrix[9];		//Row major, MPU6050_MATRIX_FRAC fractional bits
+	int16_t gyroOffset[3];		//Raw LSB
+	int16_t gyroMatrix[9];		//Row major, MPU6050_MATRIX_FRAC fractional bits
+
+}MPU6050_Calib_Params;
+
+/* Fails to compile if the layout and MPU6050_CALIB_PARAMS_SIZE disagree */
+typedef char MPU6050_Calib_Params_Size[sizeof(MPU6050_Calib_Params) == MPU6050_CALIB_PARAMS_SIZE ? 1 : -1];
+
+#endif /* __MPU6050_CALIB_PARAMS_H */
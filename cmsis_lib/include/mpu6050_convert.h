@@ -0,0 +1,25 @@
+/**
+ * @file mpu6050_convert.h
+ * @brief header file for mpu6050_convert.c
+ */
+
+#ifndef __MPU6050_CONVERT_H
+#define __MPU6050_CONVERT_H
+
+#include <stdint.h>
+
+/* Offset and scale of one sensor triplet, out = sat16(((raw - offset) * scale + round) >> shift) */
+typedef struct{
+
+	int16_t offset[3];		//X, Y, Z offset in raw LSB
+	int16_t scale[3];		//X, Y, Z multiplier, fixed point with shift fractional bits
+	uint8_t shift;			//Fractional bits of scale, 1..16
+
+}MPU6050_Convert_Params;
+
+void MPU6050_Convert_Batch(const MPU6050_Convert_Params* params, const int16_t* raw, int16_t* out, uint16_t count);
+void MPU6050_Convert_Batch_Ref(const MPU6050_Convert_Params* params, const int16_t* raw, int16_t* out, uint16_t count);
+void MPU6050_Convert_Channel(int16_t offset, int16_t scale, uint8_t shift, const int16_t* raw, int16_t* out, uint16_t count);
+void MPU6050_Convert_Batch_Float(const int16_t* offset, const float* scale, const int16_t* raw, float* out, uint16_t count);
+
+#endif /* __MPU6050_CONVERT_H */
@@ -0,0 +1,184 @@
+/**
+  ******************************************************************************
+  * @file    stm32f30x_exti.h
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    23-October-2012
+  * @brief   This file contains all the functions prototypes for the EXTI
+  *          firmware library.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2012 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F30x_EXTI_H
+#define __STM32F30x_EXTI_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f30x.h"
+
+/** @addtogroup STM32F30x_StdPeriph_Driver
+  * @{
+  */
+
+/** @addtogroup EXTI
+  * @{
+  */
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+  * @brief  EXTI mode enumeration
+  */
+
+typedef enum
+{
+  EXTI_Mode_Interrupt = 0x00,
+  EXTI_Mode_Event = 0x04
+}EXTIMode_TypeDef;
+
+#define IS_EXTI_MODE(MODE) (((MODE) == EXTI_Mode_Interrupt) || ((MODE) == EXTI_Mode_Event))
+
+/**
+  * @brief  EXTI Trigger enumeration
+  */
+
+typedef enum
+{
+  EXTI_Trigger_Rising = 0x08,
+  EXTI_Trigger_Falling = 0x0C,
+  EXTI_Trigger_Rising_Falling = 0x10
+}EXTITrigger_TypeDef;
+
+#define IS_EXTI_TRIGGER(TRIGGER) (((TRIGGER) == EXTI_Trigger_Rising) || \
+                                  ((TRIGGER) == EXTI_Trigger_Falling) || \
+                                  ((TRIGGER) == EXTI_Trigger_Rising_Falling))
+/**
+  * @brief  EXTI Init Structure definition
+  */
+
+typedef struct
+{
+  uint32_t EXTI_Line;               /*!< Specifies the EXTI lines to be enabled or disabled.
+                                         This parameter can be of a value of @ref EXTI_Lines */
+
+  EXTIMode_TypeDef EXTI_Mode;       /*!< Specifies the mode for the EXTI lines.
+                                         This parameter can be a value of @ref EXTIMode_TypeDef */
+
+  EXTITrigger_TypeDef EXTI_Trigger; /*!< Specifies the trigger signal active edge for the EXTI lines.
+                                         This parameter can be a value of @ref EXTITrigger_TypeDef */
+
+  FunctionalState EXTI_LineCmd;     /*!< Specifies the new state of the selected EXTI lines.
+                                         This parameter can be set either to ENABLE or DISABLE */
+}EXTI_InitTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+
+/** @defgroup EXTI_Exported_Constants
+  * @{
+  */
+
+/** @defgroup EXTI_Lines
+  * @{
+  */
+
+#define EXTI_Line0                       ((uint32_t)0x00)  /*!< External interrupt line 0 */
+#define EXTI_Line1                       ((uint32_t)0x01)  /*!< External interrupt line 1 */
+#define EXTI_Line2                       ((uint32_t)0x02)  /*!< External interrupt line 2 */
+#define EXTI_Line3                       ((uint32_t)0x03)  /*!< External interrupt line 3 */
+#define EXTI_Line4                       ((uint32_t)0x04)  /*!< External interrupt line 4 */
+#define EXTI_Line5                       ((uint32_t)0x05)  /*!< External interrupt line 5 */
+#define EXTI_Line6                       ((uint32_t)0x06)  /*!< External interrupt line 6 */
+#define EXTI_Line7                       ((uint32_t)0x07)  /*!< External interrupt line 7 */
+#define EXTI_Line8                       ((uint32_t)0x08)  /*!< External interrupt line 8 */
+#define EXTI_Line9                       ((uint32_t)0x09)  /*!< External interrupt line 9 */
+#define EXTI_Line10                      ((uint32_t)0x0A)  /*!< External interrupt line 10 */
+#define EXTI_Line11                      ((uint32_t)0x0B)  /*!< External interrupt line 11 */
+#define EXTI_Line12                      ((uint32_t)0x0C)  /*!< External interrupt line 12 */
+#define EXTI_Line13                      ((uint32_t)0x0D)  /*!< External interrupt line 13 */
+#define EXTI_Line14                      ((uint32_t)0x0E)  /*!< External interrupt line 14 */
+#define EXTI_Line15                      ((uint32_t)0x0F)  /*!< External interrupt line 15 */
+#define EXTI_Line16                      ((uint32_t)0x10)  /*!< External interrupt line 16 */
+#define EXTI_Line17                      ((uint32_t)0x11)  /*!< External interrupt line 17 */
+#define EXTI_Line18                      ((uint32_t)0x12)  /*!< External interrupt line 18 */
+#define EXTI_Line19                      ((uint32_t)0x13)  /*!< External interrupt line 19 */
+#define EXTI_Line20                      ((uint32_t)0x14)  /*!< External interrupt line 20 */
+#define EXTI_Line21                      ((uint32_t)0x15)  /*!< External interrupt line 21 */
+#define EXTI_Line22                      ((uint32_t)0x16)  /*!< External interrupt line 22 */
+#define EXTI_Line23                      ((uint32_t)0x17)  /*!< External interrupt line 23 */
+#define EXTI_Line24                      ((uint32_t)0x18)  /*!< External interrupt line 24 */
+#define EXTI_Line25                      ((uint32_t)0x19)  /*!< External interrupt line 25 */
+#define EXTI_Line26                      ((uint32_t)0x1A)  /*!< External interrupt line 26 */
+#define EXTI_Line27                      ((uint32_t)0x1B)  /*!< External interrupt line 27 */
+#define EXTI_Line28                      ((uint32_t)0x1C)  /*!< External interrupt line 28 */
+#define EXTI_Line29                      ((uint32_t)0x1D)  /*!< External interrupt line 29 */
+#define EXTI_Line30                      ((uint32_t)0x1E)  /*!< External interrupt line 30 */
+#define EXTI_Line31                      ((uint32_t)0x1F)  /*!< External interrupt line 31 */
+#define EXTI_Line32                      ((uint32_t)0x20)  /*!< External interrupt line 32 */
+#define EXTI_Line33                      ((uint32_t)0x21)  /*!< External interrupt line 33 */
+#define EXTI_Line34                      ((uint32_t)0x22)  /*!< External interrupt line 34 */
+#define EXTI_Line35                      ((uint32_t)0x23)  /*!< External interrupt line 35 */
+
+#define IS_EXTI_LINE_ALL(LINE) ((LINE) <= 0x23)
+
+#define IS_GET_EXTI_LINE(LINE) ((LINE) <= 0x23)
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+/* Function used to set the EXTI configuration to the default reset state *****/
+void EXTI_DeInit(void);
+
+/* Initialization and Configuration functions *********************************/
+void EXTI_Init(EXTI_InitTypeDef* EXTI_InitStruct);
+void EXTI_StructInit(EXTI_InitTypeDef* EXTI_InitStruct);
+void EXTI_GenerateSWInterrupt(uint32_t EXTI_Line);
+
+/* Interrupts and flags management functions **********************************/
+FlagStatus EXTI_GetFlagStatus(uint32_t EXTI_Line);
+void EXTI_ClearFlag(uint32_t EXTI_Line);
+ITStatus EXTI_GetITStatus(uint32_t EXTI_Line);
+void EXTI_ClearITPendingBit(uint32_t EXTI_Line);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F30x_EXTI_H */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -0,0 +1,148 @@
+/**
+  ******************************************************************************
+  * @file    stm32f30x_syscfg.h
+  * @author  MCD Application Team
+  * @version V1.0.1
+  * @date    23-October-2012
+  * @brief   This file contains all the functions prototypes for the SYSCFG firmware
+  *          library.
+  ******************************************************************************
+  * @attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2012 STMicroelectronics</center></h2>
+  *
+  * Licensed under MCD-ST Liberty SW License Agreement V2, (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        http://www.st.com/software_license_agreement_liberty_v2
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __STM32F30x_SYSCFG_H
+#define __STM32F30x_SYSCFG_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f30x.h"
+
+/** @addtogroup STM32F30x_StdPeriph_Driver
+  * @{
+  */
+
+/** @addtogroup SYSCFG
+  * @{
+  */
+
+/* Exported types ------------------------------------------------------------*/
+/* Exported constants --------------------------------------------------------*/
+
+/** @defgroup SYSCFG_Exported_Constants
+  * @{
+  */
+
+/** @defgroup SYSCFG_EXTI_Port_Sources
+  * @{
+  */
+#define EXTI_PortSourceGPIOA       ((uint8_t)0x00) /*!< GPIOA */
+#define EXTI_PortSourceGPIOB       ((uint8_t)0x01) /*!< GPIOB */
+#define EXTI_PortSourceGPIOC       ((uint8_t)0x02) /*!< GPIOC */
+#define EXTI_PortSourceGPIOD       ((uint8_t)0x03) /*!< GPIOD */
+#define EXTI_PortSourceGPIOE       ((uint8_t)0x04) /*!< GPIOE */
+#define EXTI_PortSourceGPIOF       ((uint8_t)0x05) /*!< GPIOF */
+
+#define IS_EXTI_PORT_SOURCE(PORTSOURCE) (((PORTSOURCE) == EXTI_PortSourceGPIOA) || \
+                                         ((PORTSOURCE) == EXTI_PortSourceGPIOB) || \
+                                         ((PORTSOURCE) == EXTI_PortSourceGPIOC) || \
+                                         ((PORTSOURCE) == EXTI_PortSourceGPIOD) || \
+                                         ((PORTSOURCE) == EXTI_PortSourceGPIOE) || \
+                                         ((PORTSOURCE) == EXTI_PortSourceGPIOF))
+/**
+  * @}
+  */
+
+/** @defgroup SYSCFG_EXTI_Pin_sources
+  * @{
+  */
+#define EXTI_PinSource0             ((uint8_t)0x00) /*!< Pin 0 */
+#define EXTI_PinSource1             ((uint8_t)0x01) /*!< Pin 1 */
+#define EXTI_PinSource2             ((uint8_t)0x02) /*!< Pin 2 */
+#define EXTI_PinSource3             ((uint8_t)0x03) /*!< Pin 3 */
+#define EXTI_PinSource4             ((uint8_t)0x04) /*!< Pin 4 */
+#define EXTI_PinSource5             ((uint8_t)0x05) /*!< Pin 5 */
+#define EXTI_PinSource6             ((uint8_t)0x06) /*!< Pin 6 */
+#define EXTI_PinSource7             ((uint8_t)0x07) /*!< Pin 7 */
+#define EXTI_PinSource8             ((uint8_t)0x08) /*!< Pin 8 */
+#define EXTI_PinSource9             ((uint8_t)0x09) /*!< Pin 9 */
+#define EXTI_PinSource10            ((uint8_t)0x0A) /*!< Pin 10 */
+#define EXTI_PinSource11            ((uint8_t)0x0B) /*!< Pin 11 */
+#define EXTI_PinSource12            ((uint8_t)0x0C) /*!< Pin 12 */
+#define EXTI_PinSource13            ((uint8_t)0x0D) /*!< Pin 13 */
+#define EXTI_PinSource14            ((uint8_t)0x0E) /*!< Pin 14 */
+#define EXTI_PinSource15            ((uint8_t)0x0F) /*!< Pin 15 */
+
+#define IS_EXTI_PIN_SOURCE(PINSOURCE) ((PINSOURCE) <= EXTI_PinSource15)
+/**
+  * @}
+  */
+
+/** @defgroup SYSCFG_I2C_FastModePlus_Config
+  * @{
+  */
+#define SYSCFG_I2CFastModePlus_PB6       SYSCFG_CFGR1_I2C_PB6_FMP  /*!< Enable Fast Mode Plus on PB6 */
+#define SYSCFG_I2CFastModePlus_PB7       SYSCFG_CFGR1_I2C_PB7_FMP  /*!< Enable Fast Mode Plus on PB7 */
+#define SYSCFG_I2CFastModePlus_PB8       SYSCFG_CFGR1_I2C_PB8_FMP  /*!< Enable Fast Mode Plus on PB8 */
+#define SYSCFG_I2CFastModePlus_PB9       SYSCFG_CFGR1_I2C_PB9_FMP  /*!< Enable Fast Mode Plus on PB9 */
+#define SYSCFG_I2CFastModePlus_I2C1      SYSCFG_CFGR1_I2C1_FMP     /*!< Enable Fast Mode Plus on I2C1 pins */
+#define SYSCFG_I2CFastModePlus_I2C2      SYSCFG_CFGR1_I2C2_FMP     /*!< Enable Fast Mode Plus on I2C2 pins */
+
+#define IS_SYSCFG_I2C_FMP(PIN) (((PIN) == SYSCFG_I2CFastModePlus_PB6) || \
+                                ((PIN) == SYSCFG_I2CFastModePlus_PB7) || \
+                                ((PIN) == SYSCFG_I2CFastModePlus_PB8) || \
+                                ((PIN) == SYSCFG_I2CFastModePlus_PB9) || \
+                                ((PIN) == SYSCFG_I2CFastModePlus_I2C1) || \
+                                ((PIN) == SYSCFG_I2CFastModePlus_I2C2))
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/* Exported macro ------------------------------------------------------------*/
+/* Exported functions ------------------------------------------------------- */
+
+/* Function used to set the SYSCFG configuration to the default reset state **/
+void SYSCFG_DeInit(void);
+
+/* SYSCFG configuration functions *********************************************/
+void SYSCFG_EXTILineConfig(uint8_t EXTI_PortSourceGPIOx, uint8_t EXTI_PinSourcex);
+void SYSCFG_I2CFastModePlusConfig(uint32_t SYSCFG_I2CFastModePlus, FunctionalState NewState);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*__STM32F30x_SYSCFG_H */
+
+/**
+  * @}
+  */
+
+/**
+  * @}
+  */
+
+/************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -5,5 +5,149 @@
  * @author Urban Zrim
  * @date 13.4.2015
  *
+ * Roll and pitch from the gyroscope are pulled towards the accelerometer angles
+ * with a first order complementary filter. Everything runs on raw samples in
+ * integer arithmetic, no soft-float calls on a build without FPU.
  */
 
+#include "complementary_filter.h"
+
+#define MPU6050_CF_DEG_90		(90 << 16)
+#define MPU6050_CF_DEG_180		(180 << 16)
+#define MPU6050_CF_DEG_360		(360 << 16)
+
+/* atan(z) = 45 z + z (1 - z) (B + C z) degrees on 0..1, Q16 */
+#define MPU6050_CF_ATAN_B		918833
+#define MPU6050_CF_ATAN_C		248952
+
+/* @brief Wrap a Q16 angle to -180..180 degrees */
+static int32_t MPU6050_CF_Wrap(int32_t angle){
+
+	if(angle > MPU6050_CF_DEG_180) angle -= MPU6050_CF_DEG_360;
+	else if(angle < -MPU6050_CF_DEG_180) angle += MPU6050_CF_DEG_360;
+	return angle;
+}
+
+/* @brief Integer square root, rounded down */
+static uint32_t MPU6050_CF_Sqrt(uint32_t x){
+
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+
+	while(bit > x) bit >>= 2;
+
+	while(bit != 0){
+		if(x >= root + bit){
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}else{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+/* @brief Integer four quadrant arc tangent
+ * Octant reduction, one division and a third order polynomial,
+ * error below 0.1 degree.
+ *
+ * @param y, x - |y| and |x| below 65536, e.g. raw accelerometer values
+ *
+ * @retval angle in Q16.16 degrees, -180..180, 0 for y = x = 0
+ */
+int32_t MPU6050_CF_Atan2(int32_t y, int32_t x){
+
+	uint32_t ax = x < 0 ? -x : x;
+	uint32_t ay = y < 0 ? -y : y;
+	int32_t z, angle;
+
+	if(ax == 0 && ay == 0) return 0;
+
+	/* Ratio of the smaller to the larger side, Q15 */
+	if(ay <= ax) z = (int32_t)((ay << 15) / ax);
+	else z = (int32_t)((ax << 15) / ay);
+
+	angle = z * 90 + (int32_t)(((int64_t)(MPU6050_CF_ATAN_B + ((MPU6050_CF_ATAN_C * (int64_t)z) >> 15)) *
+								((z * (32768 - z)) >> 15)) >> 15);
+
+	if(ay > ax) angle = MPU6050_CF_DEG_90 - angle;
+	if(x < 0) angle = MPU6050_CF_DEG_180 - angle;
+	if(y < 0) angle = -angle;
+	return angle;
+}
+
+/* @brief Prepare the complementary filter
+ * Gyro scale is taken from dev, so set the range first.
+ *
+ * @param cf - filter state
+ * @param dev - device the samples come from
+ * @param tauMs - time constant in milliseconds, 0 for MPU6050_CF_TAU_MS
+ * @param periodUs - time between two updates in microseconds, 0 for dev->samplePeriodUs
+ */
+void MPU6050_CF_Init(MPU6050_CF* cf, const MPU6050_Device* dev, uint16_t tauMs, uint32_t periodUs){
+
+	uint32_t tauUs;
+
+	if(tauMs == 0) tauMs = MPU6050_CF_TAU_MS;
+	if(periodUs == 0) periodUs = dev->samplePeriodUs;
+	tauUs = (uint32_t)tauMs * 1000;
+
+	/* Q32 degrees per LSB and sample, rounded */
+	cf->gyroStep = (int32_t)(((int64_t)dev->gyroMulQ32 * periodUs + 500000) / 1000000);
+	/* alpha = tau / (tau + dt) */
+	cf->alpha = (int32_t)(((uint64_t)tauUs << 16) / (tauUs + periodUs));
+
+	cf->angle.roll = 0;
+	cf->angle.pitch = 0;
+	cf->angle.yaw = 0;
+	cf->started = 0;
+	cf->cycles = 0;
+	cf->maxCycles = 0;
+}
+
+/* @brief Update the attitude with one raw sample
+ * Apply bias and calibration to the sample first. Cost is measured with the
+ * DWT cycle counter (started by MPU6050_Timebase_Init) into cf->cycles and
+ * cf->maxCycles, estimated at about 300 cycles or 4 us on the 72 MHz F303,
+ * so 1 kHz takes well under 1% of the core. Define MPU6050_CF_NO_PROFILE to
+ * drop the two counter reads.
+ *
+ * @param cf - filter state
+ * @param data - raw sample
+ */
+void MPU6050_CF_Update(MPU6050_CF* cf, const MPU6050_rawData* data){
+
+#ifndef MPU6050_CF_NO_PROFILE
+	uint32_t start = DWT->CYCCNT;
+#endif
+	int32_t accRoll, accPitch;
+	int32_t ay = data->accelY, az = data->accelZ;
+	int32_t roll, pitch;
+
+	accRoll = MPU6050_CF_Atan2(ay, az);
+	accPitch = MPU6050_CF_Atan2(-data->accelX, (int32_t)MPU6050_CF_Sqrt((uint32_t)(ay * ay) + (uint32_t)(az * az)));
+
+	/* Angle change from the gyro, rounded */
+	roll = cf->angle.roll + (int32_t)(((int64_t)data->gyroX * cf->gyroStep + 32768) >> 16);
+	pitch = cf->angle.pitch + (int32_t)(((int64_t)data->gyroY * cf->gyroStep + 32768) >> 16);
+	cf->angle.yaw = MPU6050_CF_Wrap(cf->angle.yaw + (int32_t)(((int64_t)data->gyroZ * cf->gyroStep + 32768) >> 16));
+
+	if(!cf->started){
+		roll = accRoll;
+		pitch = accPitch;
+		cf->started = 1;
+	}else if(data->accelX != 0 || ay != 0 || az != 0){
+		/* angle = alpha * gyro + (1 - alpha) * accel, difference taken the short way round */
+		roll = accRoll + (int32_t)(((int64_t)MPU6050_CF_Wrap(roll - accRoll) * cf->alpha) >> 16);
+		pitch = accPitch + (int32_t)(((int64_t)MPU6050_CF_Wrap(pitch - accPitch) * cf->alpha) >> 16);
+	}
+
+	cf->angle.roll = MPU6050_CF_Wrap(roll);
+	cf->angle.pitch = MPU6050_CF_Wrap(pitch);
+
+#ifndef MPU6050_CF_NO_PROFILE
+	cf->cycles = DWT->CYCCNT - start;
+	if(cf->cycles > cf->maxCycles) cf->maxCycles = cf->cycles;
+#endif
+}
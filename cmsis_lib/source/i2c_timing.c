@@ -0,0 +1,177 @@
+/**
+ * @file i2c_timing.c
+ * @brief Computes I2C_TIMINGR settings for the STM32F30x I2C peripheral
+ *
+ * Formulas are from the I2C timings section of the STM32F30x reference manual,
+ * bus limits are from the I2C-bus specification. Analog filter is assumed to be
+ * enabled and the digital filter disabled, as set up by i2c_init.
+ */
+
+#include "i2c_timing.h"
+
+/* Analog filter delay in ns */
+#define I2C_AF_DELAY_MIN		50
+#define I2C_AF_DELAY_MAX		260
+
+/* Number of values of each TIMINGR field */
+#define I2C_PRESC_MAX			16
+#define I2C_SCLDEL_MAX			16
+#define I2C_SDADEL_MAX			16
+#define I2C_SCLL_MAX			256
+#define I2C_SCLH_MAX			256
+
+/* Bus limits of one speed mode, times in ns */
+typedef struct{
+
+	uint32_t freqMin;		//Lowest accepted SCL frequency
+	uint32_t hdDatMin;		//Minimum data hold time
+	uint32_t vdDatMax;		//Maximum data valid time
+	uint32_t suDatMin;		//Minimum data setup time
+	uint32_t lowMin;		//Minimum SCL low period
+	uint32_t highMin;		//Minimum SCL high period
+
+}I2C_Timing_Limits;
+
+static const I2C_Timing_Limits I2C_Limits_Standard = {80000, 0, 3450, 250, 4700, 4000};
+static const I2C_Timing_Limits I2C_Limits_Fast = {320000, 0, 900, 100, 1300, 600};
+static const I2C_Timing_Limits I2C_Limits_Fast_Plus = {800000, 0, 450, 50, 500, 260};
+
+/* @brief Duration of a number of I2CCLK cycles
+ * Times are not rounded to whole clock periods first, so a minimum period
+ * is not met on paper only, e.g. 15.625 ns at 64 MHz.
+ *
+ * @retval ns, rounded down
+ */
+static int32_t I2C_Cycles_Ns(uint32_t cycles, uint32_t clockHz){
+
+	return (int32_t)(((uint64_t)cycles * 1000000000) / clockHz);
+}
+
+/* @brief Compute I2C_TIMINGR value for a bus speed
+ * For every prescaler the smallest legal SCLDEL and SDADEL are taken, then for
+ * every SCLL meeting the minimum low period the shortest SCLH is found that
+ * meets the minimum high period and keeps SCL at or below the requested
+ * frequency. The setting with the SCL period closest to the requested one wins.
+ * Rise and fall times depend on pull-ups and bus capacitance of the board.
+ *
+ * Values differ from the examples in the reference manual, e.g. 0x10420F13 and
+ * 0x00310309 for 100 and 400 kHz at 8 MHz. Those use the largest rise times
+ * the bus specification allows and extra SDADEL and SCL period margin, while
+ * this function uses the given rise and fall times and the smallest delays.
+ *
+ * Data must be valid within tVD;DAT(max) after the falling SCL edge, so the
+ * rise time plus the analog filter delay must stay below it. Fast-mode Plus has
+ * no legal setting with rise times of about 200 ns and more, the bus
+ * specification allows 120 ns.
+ *
+ * @param clockHz - I2C kernel clock frequency (I2CxCLK) in Hz
+ * @param speed - bus speed, check @i2c_speed
+ * @param riseNs - SCL and SDA rise time in ns
+ * @param fallNs - SCL and SDA fall time in ns
+ * @param timing - computed value for I2C_InitTypeDef.I2C_Timing
+ *
+ * @retval 0 on success, 1 if no legal setting exists for the clock, rise and fall time
+ */
+uint8_t I2C_Timing_Calc(uint32_t clockHz, I2C_Speed speed, uint32_t riseNs, uint32_t fallNs, uint32_t* timing){
+
+	const I2C_Timing_Limits* lim;
+	int32_t tlow, thigh, tscl, needed;
+	int32_t period, periodMax;
+	int32_t sdadelLimit;
+	int32_t scldel, sdadel, scll, sclh;
+	int32_t presc, cycles;
+	int32_t error;
+	int32_t bestError = -1;
+
+	switch(speed){
+	case I2C_SPEED_STANDARD:	lim = &I2C_Limits_Standard; break;
+	case I2C_SPEED_FAST:		lim = &I2C_Limits_Fast; break;
+	case I2C_SPEED_FAST_PLUS:	lim = &I2C_Limits_Fast_Plus; break;
+	default:					return 1;
+	}
+
+	if(clockHz == 0) return 1;
+
+	period = (int32_t)((1000000000 + (uint32_t)speed / 2) / (uint32_t)speed);
+	periodMax = (int32_t)(1000000000 / lim->freqMin);
+
+	/* SDADEL x tPRESC <= tVD;DAT(max) - tr - tAF(max) - 4 x tI2CCLK, not limited below 0 */
+	sdadelLimit = (int32_t)lim->vdDatMax - (int32_t)riseNs - I2C_AF_DELAY_MAX;
+
+	for(presc = 0; presc < I2C_PRESC_MAX; presc++){
+
+		/* (SCLDEL + 1) x tPRESC >= tr + tSU;DAT(min) */
+		for(scldel = 0; scldel < I2C_SCLDEL_MAX; scldel++){
+			if(I2C_Cycles_Ns((scldel + 1) * (presc + 1), clockHz) >= (int32_t)(riseNs + lim->suDatMin)) break;
+		}
+		if(scldel >= I2C_SCLDEL_MAX) continue;
+
+		/* SDADEL x tPRESC >= tf + tHD;DAT(min) - tAF(min) - 3 x tI2CCLK */
+		for(sdadel = 0; sdadel < I2C_SDADEL_MAX; sdadel++){
+			if(I2C_Cycles_Ns(sdadel * (presc + 1) + 3, clockHz) + I2C_AF_DELAY_MIN >= (int32_t)(fallNs + lim->hdDatMin)) break;
+		}
+		if(sdadel >= I2C_SDADEL_MAX) continue;
+		if(sdadel != 0 && I2C_Cycles_Ns(sdadel * (presc + 1) + 4, clockHz) + 1 > sdadelLimit) continue;
+
+		for(scll = 0; scll < I2C_SCLL_MAX; scll++){
+
+			/* SCL low and high periods are extended by the analog filter and two I2CCLK synchronization cycles */
+			tlow = I2C_AF_DELAY_MIN + I2C_Cycles_Ns((scll + 1) * (presc + 1) + 2, clockHz);
+			if(tlow < (int32_t)lim->lowMin) continue;
+
+			/* I2CCLK must be faster than a quarter of the filtered low period */
+			if(I2C_Cycles_Ns(4, clockHz) >= tlow - I2C_AF_DELAY_MIN) continue;
+
+			/* tSCL = tf + tLOW + tr + tHIGH must not be shorter than the requested period */
+			needed = period - (int32_t)fallNs - (int32_t)riseNs - tlow;
+			if(needed < (int32_t)lim->highMin) needed = (int32_t)lim->highMin;
+
+			cycles = (int32_t)(((uint64_t)(needed - I2C_AF_DELAY_MIN) * clockHz + 999999999) / 1000000000) - 2;
+			sclh = (cycles + presc) / (presc + 1) - 1;
+			if(sclh < 0) sclh = 0;
+			while(sclh < I2C_SCLH_MAX && I2C_AF_DELAY_MIN + I2C_Cycles_Ns((sclh + 1) * (presc + 1) + 2, clockHz) < needed) sclh++;
+			if(sclh >= I2C_SCLH_MAX) continue;
+
+			thigh = I2C_AF_DELAY_MIN + I2C_Cycles_Ns((sclh + 1) * (presc + 1) + 2, clockHz);
+
+			tscl = (int32_t)fallNs + tlow + (int32_t)riseNs + thigh;
+			if(tscl > periodMax) continue;
+
+			error = tscl - period;
+
+			if(bestError < 0 || error < bestError){
+				bestError = error;
+				*timing = ((uint32_t)presc << 28) | ((uint32_t)scldel << 20) | ((uint32_t)sdadel << 16) |
+						  ((uint32_t)sclh << 8) | (uint32_t)scll;
+			}
+		}
+	}
+
+	if(bestError < 0) return 1;
+	return 0;
+}
+
+/* @brief Compute I2C_TIMINGR value for the fastest possible speed up to a requested one
+ * Falls back to the next slower speed while I2C_Timing_Calc finds no legal
+ * setting. If not even Standard-mode has one, the slowest TIMINGR value is used.
+ *
+ * @param clockHz - I2C kernel clock frequency (I2CxCLK) in Hz
+ * @param speed - requested bus speed, check @i2c_speed
+ * @param riseNs - SCL and SDA rise time in ns
+ * @param fallNs - SCL and SDA fall time in ns
+ * @param timing - computed value for I2C_InitTypeDef.I2C_Timing
+ *
+ * @retval bus speed the timing is for, lower than speed after a fallback
+ */
+I2C_Speed I2C_Timing_Select(uint32_t clockHz, I2C_Speed speed, uint32_t riseNs, uint32_t fallNs, uint32_t* timing){
+
+	while(I2C_Timing_Calc(clockHz, speed, riseNs, fallNs, timing) != 0){
+		if(speed == I2C_SPEED_FAST_PLUS) speed = I2C_SPEED_FAST;
+		else if(speed == I2C_SPEED_FAST) speed = I2C_SPEED_STANDARD;
+		else{
+			*timing = I2C_TIMING_SLOWEST;
+			break;
+		}
+	}
+	return speed;
+}
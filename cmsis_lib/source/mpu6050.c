@@ -29,38 +29,257 @@
  */
 
 
+#include <string.h>
 #include "mpu6050.h"
 
-uint32_t MPU6050_Timeout = MPU6050_FLAG_TIMEOUT;
-MPU6050_dataStruct dataStruct;
+MPU6050_RATE_ASSERT(MPU6050_DEFAULT_RATE_HZ, MPU6050_DEFAULT_BANDWIDTH_HZ);
+
+const MPU6050_Bus MPU6050_Bus1 = {MPU6050_INTERFACE_I2C, MPU6050_I2C, 0, MPU6050_I2C_GPIO_PORT, MPU6050_I2C_SCL_PIN, MPU6050_I2C_SDA_PIN};
+const MPU6050_Bus MPU6050_SPI_Bus2 = {MPU6050_INTERFACE_SPI, 0, MPU6050_SPI, 0, 0, 0};
+
+/* Bus recovery state */
+static uint8_t MPU6050_Recovering = 0;
+
+static MPU6050_errorstatus MPU6050_Read_Transfer(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead);
+static MPU6050_errorstatus MPU6050_Write_Transfer(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToWrite);
+static uint8_t MPU6050_Wait_Flag(I2C_TypeDef* I2Cx, uint32_t flag, FlagStatus state);
+static MPU6050_errorstatus MPU6050_SPI_Transfer(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumBytes);
+static uint32_t MPU6050_Elapsed_Us(uint32_t start);
+static void MPU6050_Boot_Sample(MPU6050_Device* dev);
+static MPU6050_errorstatus MPU6050_FIFO_Drain(MPU6050_Device* dev, MPU6050_rawData* samples, uint8_t* aux, MPU6050_Block* block, uint16_t maxSamples, uint16_t* numSamples);
+
+/* Configuration registers mirrored in RAM, sorted by address so runs can be read in bursts */
+static const uint8_t MPU6050_Shadow_Regs[MPU6050_SHADOW_SIZE] = {
+	SMPLRT_DIV, CONFIG, GYRO_CONFIG, ACCEL_CONFIG,
+	FIFO_EN, I2C_MST_CTRL,
+	INT_PIN_CFG, INT_ENABLE,
+	USER_CTRL, PWR_MGMT_1, PWR_MGMT_2
+};
+
+/* Configuration set by MPU6050_Initialization */
+static const MPU6050_Config MPU6050_Default_Config = {
+	MPU6050_GYRO_250, MPU6050_ACCEL_2g, MPU6050_DEFAULT_RATE_HZ, MPU6050_DEFAULT_BANDWIDTH_HZ
+};
+
+/* DMA transfer state, written from DMA1_Channel7_IRQHandler */
+static volatile uint8_t MPU6050_DMA_Running = 0;
+static volatile MPU6050_errorstatus MPU6050_DMA_Result = MPU6050_NO_ERROR;
+static MPU6050_Callback MPU6050_DMA_Callback = 0;
+
+/* Data ready acquisition state, written from EXTI and I2C interrupts */
+static MPU6050_Device* MPU6050_DRDY_Device = 0;
+static uint8_t MPU6050_DRDY_Buffer[MPU6050_SAMPLE_LENGTH + MPU6050_AUX_MAX_BYTES];
+static MPU6050_rawData MPU6050_DRDY_Sample;
+static uint8_t MPU6050_DRDY_Aux[MPU6050_AUX_MAX_BYTES];
+static volatile uint8_t MPU6050_DRDY_Reading = 0;
+static volatile uint8_t MPU6050_DRDY_New = 0;
+static volatile uint32_t MPU6050_DRDY_Missed_Count = 0;
+static uint32_t MPU6050_DRDY_Edge;					//Time of the data ready edge being read
+static uint32_t MPU6050_DRDY_Time;					//Time of MPU6050_DRDY_Sample
+
+/* Microsecond clock extended from the DWT cycle counter */
+static uint32_t MPU6050_Time_Cycles = 0;
+static uint32_t MPU6050_Time_Rest = 0;
+static uint32_t MPU6050_Time_Now = 0;
+
+/* Wake-on-motion state */
+#define MPU6050_MOTION_IDLE		0	//INT edges are data ready
+#define MPU6050_MOTION_CHANGING	1	//Registers are being switched, INT edges are ignored
+#define MPU6050_MOTION_ARMED	2	//Waiting for a motion interrupt
+#define MPU6050_MOTION_WOKEN	3	//Motion interrupt seen
+
+static volatile uint8_t MPU6050_Motion_State = MPU6050_MOTION_IDLE;
+static volatile uint8_t MPU6050_Motion_Waking = 0;
+static volatile uint32_t MPU6050_Motion_Edge;
+static uint8_t MPU6050_Motion_Saved[4];		//ACCEL_CONFIG, INT_ENABLE, PWR_MGMT_1, PWR_MGMT_2
+
+/* Asynchronous transaction engine state, head request is the one on the bus */
+#define MPU6050_PHASE_REG		0	//Register address is being sent
+#define MPU6050_PHASE_DATA		1	//Data bytes are being transferred
+
+static MPU6050_Request MPU6050_Queue[MPU6050_QUEUE_SIZE];
+static volatile uint8_t MPU6050_Queue_Head = 0;
+static volatile uint8_t MPU6050_Queue_Count = 0;
+static volatile uint8_t MPU6050_Async_Busy = 0;		//Head request is on the bus
+static uint32_t MPU6050_Async_Started;				//DWT->CYCCNT when the head request started
+static uint8_t MPU6050_Async_Phase;
+static uint8_t MPU6050_Async_Index;
+static MPU6050_errorstatus MPU6050_Async_Result;
+
+static void MPU6050_Async_Start(void);
+static void MPU6050_Async_Finish(void);
+static void MPU6050_Async_Deadline(void);
+
+/* @brief Fills a device handle, must be called before any other function using it
+ * Communication with the sensor is not started. The DWT cycle counter is
+ * enabled here, so transfer timeouts work before MPU6050_Initialization.
+ *
+ * @param dev - device handle
+ * @param bus - bus the sensor is connected to, e.g. &MPU6050_Bus1
+ * @param address - 7-bit I2C address, MPU6050_ADDRESS or MPU6050_ADDRESS_AD0_HIGH
+ */
+void MPU6050_Device_Init(MPU6050_Device* dev, const MPU6050_Bus* bus, uint8_t address){
+
+	dev->bus = bus;
+	dev->address = address & 0x7f;
+	dev->csPort = 0;
+	dev->csPin = 0;
+	dev->spiSlow = SPI_BaudRatePrescaler_256;
+	dev->spiFast = SPI_BaudRatePrescaler_256;
+	dev->gyroMul = 1/MPU6050_GYRO_RANGE_250;
+	dev->accelMul = 1/MPU6050_ACCEL_RANGE_2g;
+	dev->gyroMulQ32 = MPU6050_GYRO_Q32(MPU6050_GYRO_RANGE_250);
+	dev->accelMulQ16 = MPU6050_ACCEL_Q16(MPU6050_ACCEL_RANGE_2g);
+	dev->fifoSensors = 0;
+	dev->fifoFrameLen = 0;
+	dev->auxLen = 0;
+	dev->auxFifoLen = 0;
+	dev->auxFifo = 0;
+	dev->shadowValid = 0;
+	dev->sampleRateHz = MPU6050_DLPF_BASE_RATE(0);		//Reset value of SMPLRT_DIV and CONFIG
+	dev->samplePeriodUs = 1000000 / MPU6050_DLPF_BASE_RATE(0);
+	dev->initStart = 0;
+	dev->stats.transfers = 0;
+	dev->stats.errors = 0;
+	dev->stats.recoveries = 0;
+	dev->stats.lastRecoveryUs = 0;
+	dev->stats.maxRecoveryUs = 0;
+	dev->stats.initUs = 0;
+	dev->stats.firstSampleUs = 0;
+	dev->stats.wakeLatencyUs = 0;
+	dev->stats.maxWakeLatencyUs = 0;
+	dev->stats.parkedUs = 0;
+	dev->stats.sleepUs = 0;
+
+	MPU6050_Timebase_Init();
+}
+
+/* @brief Get the smallest SPI baud rate prescaler that keeps SCK at or below a frequency
+ * @param pclk - SPI peripheral clock in Hz
+ * @param maxHz - highest allowed SCK frequency in Hz
+ * @retval SPI_BaudRatePrescaler_x value
+ */
+static uint16_t MPU6050_SPI_Prescaler(uint32_t pclk, uint32_t maxHz){
+
+	uint16_t br;
+
+	/* SCK = pclk / 2^(BR + 1) */
+	for(br = 0; br < 7; br++){
+		if((pclk >> (br + 1)) <= maxHz) break;
+	}
+	return br << 3;
+}
+
+/* @brief Fills a device handle of an MPU-6000 connected over SPI
+ * Bus pins, SPI peripheral (master, mode 3, 8-bit, software NSS) and the chip
+ * select pin must be set up by the application, chip select is driven high.
+ * SPI clock prescalers are derived from the current peripheral clock.
+ *
+ * @param dev - device handle
+ * @param bus - SPI bus the sensor is connected to, e.g. &MPU6050_SPI_Bus2
+ * @param csPort - chip select port
+ * @param csPin - chip select pin
+ */
+void MPU6050_Device_Init_SPI(MPU6050_Device* dev, const MPU6050_Bus* bus, GPIO_TypeDef* csPort, uint16_t csPin){
+
+	RCC_ClocksTypeDef RCC_Clocks;
+	uint32_t pclk;
+
+	MPU6050_Device_Init(dev, bus, 0);
+	dev->csPort = csPort;
+	dev->csPin = csPin;
+
+	/* SPI1 is on APB2, SPI2 and SPI3 are on APB1 */
+	RCC_GetClocksFreq(&RCC_Clocks);
+	pclk = (bus->SPIx == SPI1) ? RCC_Clocks.PCLK2_Frequency : RCC_Clocks.PCLK1_Frequency;
+
+	dev->spiSlow = MPU6050_SPI_Prescaler(pclk, MPU6050_SPI_SLOW_HZ);
+	dev->spiFast = MPU6050_SPI_Prescaler(pclk, MPU6050_SPI_FAST_HZ);
+}
 
 /* @brief Sets up MPU6050 internal clock and sensors sensitivity rate
 *  This function must be called before using the sensor!
+*  Gyroscope 250 deg/s, accelerometer 2g, MPU6050_DEFAULT_RATE_HZ and
+*  MPU6050_DEFAULT_BANDWIDTH_HZ, check MPU6050_Initialization_Config.
+*
+* @param dev - device handle
+* @retval @MPU6050_errorstatus
+*/
+MPU6050_errorstatus MPU6050_Initialization(MPU6050_Device* dev){
+
+	return MPU6050_Initialization_Config(dev, &MPU6050_Default_Config);
+}
+
+/* @brief Sets up MPU6050 with the given ranges, rate and bandwidth
+*  Configuration is written as one register table in two transfers, its
+*  duration and the time to the first sample are kept in dev->stats.
 *
+* @param dev - device handle
+* @param config - ranges, output data rate and bandwidth
 * @retval @MPU6050_errorstatus
 */
-MPU6050_errorstatus MPU6050_Initialization(void){
+MPU6050_errorstatus MPU6050_Initialization_Config(MPU6050_Device* dev, const MPU6050_Config* config){
 
 	MPU6050_errorstatus errorstatus;
+	MPU6050_RegValue table[5];
+	uint8_t cfg;
+
+	if(!MPU6050_RATE_VALID(config->rateHz, config->bandwidthHz)) return MPU6050_CONFIG_ERROR;
+
+	/* I2C timeouts are measured with the DWT cycle counter */
+	MPU6050_Timebase_Init();
+	dev->initStart = DWT->CYCCNT;
+	dev->stats.firstSampleUs = 0;
+
+	/* MPU-6000 on SPI must not react to traffic it sees as I2C */
+	if(dev->bus->interface == MPU6050_INTERFACE_SPI){
+		errorstatus = MPU6050_Modify_Reg(dev, USER_CTRL, MPU6050_USER_I2C_IF_DIS, MPU6050_USER_I2C_IF_DIS);
+		if(errorstatus != 0) return errorstatus;
+	}
+
+	/* Write order, clock source first */
+	cfg = MPU6050_DLPF_SELECT(config->bandwidthHz);
+	table[0].reg = PWR_MGMT_1;
+	table[0].value = MPU6050_PLL_X_GYRO;
+	table[1].reg = SMPLRT_DIV;
+	table[1].value = MPU6050_DLPF_BASE_RATE(cfg) / config->rateHz - 1;
+	table[2].reg = CONFIG;
+	table[2].value = cfg;
+	table[3].reg = GYRO_CONFIG;
+	table[3].value = (uint8_t)config->gyroRange;
+	table[4].reg = ACCEL_CONFIG;
+	table[4].value = (uint8_t)config->accelRange;
+
+	errorstatus = MPU6050_Write_Table(dev, table, sizeof(table) / sizeof(table[0]));
+	if(errorstatus != 0) return errorstatus;
+
+	/* Registers below already hold their values, the shadow skips the writes
+	 * and only the multipliers and the sample period are stored in dev */
 
 	/* Set Clock source for the chip
 	 * possible values @pwr_mngt_1
 	 */
-	errorstatus = MPU6050_Set_Clock(MPU6050_PLL_X_GYRO);
+	errorstatus = MPU6050_Set_Clock(dev, MPU6050_PLL_X_GYRO);
 	if(errorstatus != 0) return errorstatus;
 
 	/* Set Gyroscope's full scope range
 	 * possible values @gyro_scale_range
 	 */
-	errorstatus = MPU6050_Gyro_Set_Range(MPU6050_GYRO_250);
+	errorstatus = MPU6050_Gyro_Set_Range(dev, config->gyroRange);
 	if(errorstatus != 0) return errorstatus;
 
 	/* Set Accelerometer's full scope range
 	 * possible values @accel_scale_range
 	 */
-	errorstatus = MPU6050_Accel_Set_Range(MPU6050_ACCEL_2g);
+	errorstatus = MPU6050_Accel_Set_Range(dev, config->accelRange);
+	if(errorstatus != 0) return errorstatus;
+
+	/* Set output data rate and digital low-pass filter */
+	errorstatus = MPU6050_Set_Rate(dev, config->rateHz, config->bandwidthHz);
 	if(errorstatus != 0) return errorstatus;
 
+	dev->stats.initUs = MPU6050_Elapsed_Us(dev->initStart);
+
 	return MPU6050_NO_ERROR;
 }
 
@@ -68,14 +287,15 @@ MPU6050_errorstatus MPU6050_Initialization(void){
 /* @brief Test if chip is visible on I2C line
  * Reads the WHO_AM_I register
  *
+ * @param dev - device handle
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Test(void){
+MPU6050_errorstatus MPU6050_Test(MPU6050_Device* dev){
 
 	MPU6050_errorstatus errorstatus;
 	uint8_t tmp;
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, WHO_AM_I, &tmp, 1);
+	errorstatus = MPU6050_Read(dev, WHO_AM_I, &tmp, 1);
 	if(tmp != (uint8_t)0x68){
 		return errorstatus;
 	}
@@ -83,407 +303,2332 @@ MPU6050_errorstatus MPU6050_Test(void){
 }
 
 /* @brief Get Gyroscope's full scale range
- * Reads the GYRO_CONFIG register and returns the value of gyro's range
+ * Value is served from the register shadow, the bus is only used if the
+ * shadow of GYRO_CONFIG is not valid yet.
  *
- * @retval tmp - value of gyro's range
+ * @param dev - device handle
+ * @retval tmp - value of gyro's range, check @MPU6050_Gyro_Range
  */
-uint8_t MPU6050_Gyro_Get_Range(void){
+uint8_t MPU6050_Gyro_Get_Range(MPU6050_Device* dev){
 
 	MPU6050_errorstatus errorstatus;
 	uint8_t tmp;
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, GYRO_CONFIG, &tmp, 1);
+	errorstatus = MPU6050_Read_Reg(dev, GYRO_CONFIG, &tmp);
 	if(errorstatus != 0){
 		return 1;
 	}
-	else return tmp;
+	else return tmp & MPU6050_RANGE_MASK;
 
 }
 
 /* @brief Set Gyroscope's full scale range
+ * Stores the matching raw data multiplier for MPU6050_Get_Gyro_Data.
+ *
+ * @param dev - device handle
  * @param range - check @MPU6050_Gyro_Range
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Gyro_Set_Range(MPU6050_Gyro_Range range){
+MPU6050_errorstatus MPU6050_Gyro_Set_Range(MPU6050_Device* dev, MPU6050_Gyro_Range range){
 
 	MPU6050_errorstatus errorstatus;
-	dataStruct.gyroMul = range;
 
-	errorstatus = MPU6050_Write((MPU6050_ADDRESS & 0x7f) << 1, GYRO_CONFIG, &range);
+	errorstatus = MPU6050_Write_Reg(dev, GYRO_CONFIG, (uint8_t)range);
 	if(errorstatus != 0){
 		return errorstatus;
 	}
-	else return MPU6050_NO_ERROR;
+
+	switch(range){
+	case MPU6050_GYRO_250:
+		dev->gyroMul = 1/MPU6050_GYRO_RANGE_250;
+		dev->gyroMulQ32 = MPU6050_GYRO_Q32(MPU6050_GYRO_RANGE_250);
+		break;
+	case MPU6050_GYRO_500:
+		dev->gyroMul = 1/MPU6050_GYRO_RANGE_500;
+		dev->gyroMulQ32 = MPU6050_GYRO_Q32(MPU6050_GYRO_RANGE_500);
+		break;
+	case MPU6050_GYRO_1000:
+		dev->gyroMul = 1/MPU6050_GYRO_RANGE_1000;
+		dev->gyroMulQ32 = MPU6050_GYRO_Q32(MPU6050_GYRO_RANGE_1000);
+		break;
+	default:
+		dev->gyroMul = 1/MPU6050_GYRO_RANGE_2000;
+		dev->gyroMulQ32 = MPU6050_GYRO_Q32(MPU6050_GYRO_RANGE_2000);
+		break;
+	}
+
+	return MPU6050_NO_ERROR;
 
 }
 
 /* @brief Get Accelerometer full scale range
- * Reads the Accel_CONFIG register and returns the value of accelerometer's range
+ * Value is served from the register shadow, the bus is only used if the
+ * shadow of ACCEL_CONFIG is not valid yet.
  *
- * @retval tmp - value of accelerometer's range
+ * @param dev - device handle
+ * @retval tmp - value of accelerometer's range, check @MPU6050_Accel_Range
  */
-uint8_t MPU6050_Accel_Get_Range(void){
+uint8_t MPU6050_Accel_Get_Range(MPU6050_Device* dev){
 
 	MPU6050_errorstatus errorstatus;
 	uint8_t tmp;
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_CONFIG, &tmp, 1);
+	errorstatus = MPU6050_Read_Reg(dev, ACCEL_CONFIG, &tmp);
 	if(errorstatus != 0){
 		return 1;
 	}
-	else return tmp;
+	else return tmp & MPU6050_RANGE_MASK;
 
 }
 
 /* @brief Set Accelerometer full scale range
+ * Stores the matching raw data multiplier for MPU6050_Get_Accel_Data.
+ *
+ * @param dev - device handle
  * @param range - check @MPU6050_Accel_Range
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Accel_Set_Range(MPU6050_Accel_Range range){
+MPU6050_errorstatus MPU6050_Accel_Set_Range(MPU6050_Device* dev, MPU6050_Accel_Range range){
 
 	MPU6050_errorstatus errorstatus;
-	dataStruct.accelMul = range;
 
-	errorstatus = MPU6050_Write((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_CONFIG, &range);
+	errorstatus = MPU6050_Write_Reg(dev, ACCEL_CONFIG, (uint8_t)range);
 	if(errorstatus != 0){
 		return errorstatus;
 	}
-	else return MPU6050_NO_ERROR;
+
+	switch(range){
+	case MPU6050_ACCEL_2g:
+		dev->accelMul = 1/MPU6050_ACCEL_RANGE_2g;
+		dev->accelMulQ16 = MPU6050_ACCEL_Q16(MPU6050_ACCEL_RANGE_2g);
+		break;
+	case MPU6050_ACCEL_4g:
+		dev->accelMul = 1/MPU6050_ACCEL_RANGE_4g;
+		dev->accelMulQ16 = MPU6050_ACCEL_Q16(MPU6050_ACCEL_RANGE_4g);
+		break;
+	case MPU6050_ACCEL_8g:
+		dev->accelMul = 1/MPU6050_ACCEL_RANGE_8g;
+		dev->accelMulQ16 = MPU6050_ACCEL_Q16(MPU6050_ACCEL_RANGE_8g);
+		break;
+	default:
+		dev->accelMul = 1/MPU6050_ACCEL_RANGE_16g;
+		dev->accelMulQ16 = MPU6050_ACCEL_Q16(MPU6050_ACCEL_RANGE_16g);
+		break;
+	}
+
+	return MPU6050_NO_ERROR;
 
 }
 
 /* @brief Set MPU6050 clock source
+ * @param dev - device handle
  * @param clock - check @MPU6050_Clock_Select
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus  MPU6050_Set_Clock(MPU6050_Clock_Select clock){
-
-	MPU6050_errorstatus errorstatus;
+MPU6050_errorstatus  MPU6050_Set_Clock(MPU6050_Device* dev, MPU6050_Clock_Select clock){
 
-	errorstatus = MPU6050_Write((MPU6050_ADDRESS & 0x7f) << 1, PWR_MGMT_1, &clock);
-	if(errorstatus != 0){
-		return errorstatus;
-	}
-	else return MPU6050_NO_ERROR;
+	return MPU6050_Write_Reg(dev, PWR_MGMT_1, (uint8_t)clock);
 
 }
 
-/* @brief Read MPU6050 temperature
- * @retval temp_celsius - temperature in degrees celsius
+/* @brief Set output data rate and digital low-pass filter bandwidth
+ * DLPF_CFG with the narrowest bandwidth that still passes bandwidthHz is
+ * selected, SMPLRT_DIV divides its gyroscope output rate down to rateHz.
+ * Use MPU6050_RATE_ASSERT to check constant arguments at compile time.
+ * Accelerometer output rate is 1 kHz, faster rates repeat accelerometer samples.
+ *
+ * @param dev - device handle
+ * @param rateHz - output data rate in Hz, 4..8000
+ * @param bandwidthHz - lowest acceptable gyroscope bandwidth in Hz, 5..256
+ *
+ * @retval @MPU6050_errorstatus, MPU6050_CONFIG_ERROR if the pair is not legal
  */
-int16_t MPU6050_Get_Temperature(void){
+MPU6050_errorstatus MPU6050_Set_Rate(MPU6050_Device* dev, uint16_t rateHz, uint16_t bandwidthHz){
 
 	MPU6050_errorstatus errorstatus;
-	uint8_t temp_low;
-	uint8_t temp_high;
-	int16_t temp;
-	int16_t temp_celsius;
+	uint8_t cfg;
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, TEMP_OUT_L, &temp_low, 1);
-	if(errorstatus != 0){
-		return 1;
-	}
+	if(!MPU6050_RATE_VALID(rateHz, bandwidthHz)) return MPU6050_CONFIG_ERROR;
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, TEMP_OUT_H, &temp_high, 1);
-	if(errorstatus != 0){
-		return 1;
-	}
+	cfg = MPU6050_DLPF_SELECT(bandwidthHz);
 
-	temp = (uint16_t)(temp_high << 8 | temp_low);
+	errorstatus = MPU6050_Modify_Reg(dev, CONFIG, MPU6050_DLPF_CFG_MASK, cfg);
+	if(errorstatus != 0) return errorstatus;
 
-	temp_celsius = temp/340 + 36;
-	return temp_celsius;
+	errorstatus = MPU6050_Write_Reg(dev, SMPLRT_DIV, MPU6050_DLPF_BASE_RATE(cfg) / rateHz - 1);
+	if(errorstatus != 0) return errorstatus;
 
+	dev->sampleRateHz = rateHz;
+	dev->samplePeriodUs = 1000000 / rateHz;
+
+	return MPU6050_NO_ERROR;
 }
 
-/* @brief Get Gyroscope X,Y,Z raw data
+/* @brief Get shadow index of a configuration register
+ * @param RegAddr - register address
+ * @retval index into MPU6050_Shadow_Regs or -1 if register is not shadowed
+ */
+static int8_t MPU6050_Shadow_Index(uint8_t RegAddr){
+
+	int8_t i;
+
+	for(i = 0; i < MPU6050_SHADOW_SIZE; i++){
+		if(MPU6050_Shadow_Regs[i] == RegAddr) return i;
+	}
+	return -1;
+}
+
+/* @brief Write one register through the register shadow
+ * Write to a shadowed register is skipped if the register already holds the value.
  *
- * @param X - sensor roll on X axis
- * @param Y - sensor pitch on Y axis
- * @param Z - sensor jaw on Z axis
+ * @param dev - device handle
+ * @param RegAddr - register address
+ * @param value - value to write
  *
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Get_Gyro_Data_Raw(int16_t* X, int16_t* Y, int16_t* Z){
+MPU6050_errorstatus MPU6050_Write_Reg(MPU6050_Device* dev, uint8_t RegAddr, uint8_t value){
 
 	MPU6050_errorstatus errorstatus;
+	int8_t i = MPU6050_Shadow_Index(RegAddr);
 
-	uint8_t xlow, xhigh, ylow, yhigh, zlow, zhigh;
-
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, GYRO_XOUT_L, &xlow, 1);
-	if(errorstatus != 0){
-		return errorstatus;
+	if(i >= 0 && (dev->shadowValid & (1 << i)) && dev->shadow[i] == value){
+		return MPU6050_NO_ERROR;
 	}
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, GYRO_XOUT_H, &xhigh, 1);
+	errorstatus = MPU6050_Write(dev, RegAddr, &value, 1);
 	if(errorstatus != 0){
+		/* Register content is unknown after a failed write */
+		if(i >= 0) dev->shadowValid &= ~(1 << i);
 		return errorstatus;
 	}
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, GYRO_YOUT_L, &ylow, 1);
-	if(errorstatus != 0){
-		return errorstatus;
+	if(i >= 0){
+		dev->shadow[i] = value;
+		dev->shadowValid |= (1 << i);
 	}
+	return MPU6050_NO_ERROR;
+}
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, GYRO_YOUT_H, &yhigh, 1);
-	if(errorstatus != 0){
-		return errorstatus;
-	}
+/* @brief Read one register through the register shadow
+ * Shadowed registers are served from RAM once they are valid.
+ *
+ * @param dev - device handle
+ * @param RegAddr - register address
+ * @param value - register value
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Read_Reg(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* value){
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, GYRO_ZOUT_L, &zlow, 1);
-	if(errorstatus != 0){
-		return errorstatus;
-	}
+	MPU6050_errorstatus errorstatus;
+	int8_t i = MPU6050_Shadow_Index(RegAddr);
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, GYRO_ZOUT_H, &zhigh, 1);
-	if(errorstatus != 0){
-		return errorstatus;
+	if(i >= 0 && (dev->shadowValid & (1 << i))){
+		*value = dev->shadow[i];
+		return MPU6050_NO_ERROR;
 	}
 
-	*X = (int16_t)(xhigh << 8 | xlow);
-	*Y = (int16_t)(yhigh << 8 | ylow);
-	*Z = (int16_t)(zhigh << 8 | zlow);
+	errorstatus = MPU6050_Read(dev, RegAddr, value, 1);
+	if(errorstatus != 0) return errorstatus;
 
+	if(i >= 0){
+		dev->shadow[i] = *value;
+		dev->shadowValid |= (1 << i);
+	}
 	return MPU6050_NO_ERROR;
 }
 
-/* @brief Get Accelerometer X,Y,Z raw data
+/* @brief Change selected bits of a register through the register shadow
  *
- * @param X - sensor accel on X axis
- * @param Y - sensor accel on Y axis
- * @param Z - sensor accel on Z axis
+ * @param dev - device handle
+ * @param RegAddr - register address
+ * @param mask - bits to change
+ * @param value - new value of the bits in mask
  *
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Get_Accel_Data_Raw(int16_t* X, int16_t* Y, int16_t* Z){
+MPU6050_errorstatus MPU6050_Modify_Reg(MPU6050_Device* dev, uint8_t RegAddr, uint8_t mask, uint8_t value){
 
 	MPU6050_errorstatus errorstatus;
+	uint8_t tmp;
 
-	uint8_t xlow, xhigh, ylow, yhigh, zlow, zhigh;
+	errorstatus = MPU6050_Read_Reg(dev, RegAddr, &tmp);
+	if(errorstatus != 0) return errorstatus;
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_XOUT_L, &xlow, 1);
-	if(errorstatus != 0){
-		return errorstatus;
-	}
+	return MPU6050_Write_Reg(dev, RegAddr, (tmp & ~mask) | (value & mask));
+}
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_XOUT_H, &xhigh, 1);
-	if(errorstatus != 0){
-		return errorstatus;
-	}
+/* @brief Write consecutive registers in one burst through the register shadow
+ * Burst is always sent, shadows of the written registers are updated.
+ *
+ * @param dev - device handle
+ * @param RegAddr - address of the first register
+ * @param values - values to write
+ * @param count - number of registers
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Write_Regs(MPU6050_Device* dev, uint8_t RegAddr, const uint8_t* values, uint8_t count){
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_YOUT_L, &ylow, 1);
-	if(errorstatus != 0){
-		return errorstatus;
+	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[MPU6050_WRITE_BURST_MAX];
+	int8_t idx;
+	uint8_t i;
+
+	if(count == 0 || count > MPU6050_WRITE_BURST_MAX) return MPU6050_CONFIG_ERROR;
+
+	/* Transfer functions take a non-const buffer */
+	memcpy(buffer, values, count);
+
+	errorstatus = MPU6050_Write(dev, RegAddr, buffer, count);
+
+	for(i = 0; i < count; i++){
+		idx = MPU6050_Shadow_Index(RegAddr + i);
+		if(idx < 0) continue;
+
+		/* Register content is unknown after a failed write */
+		if(errorstatus != 0){
+			dev->shadowValid &= ~(1 << idx);
+		}
+		else{
+			dev->shadow[idx] = buffer[i];
+			dev->shadowValid |= (1 << idx);
+		}
 	}
+	return errorstatus;
+}
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_YOUT_H, &yhigh, 1);
-	if(errorstatus != 0){
-		return errorstatus;
+/* @brief Write a table of registers, merging consecutive addresses into bursts
+ * Entries are written in table order. Entries whose addresses follow each
+ * other are sent as one burst of up to MPU6050_WRITE_BURST_MAX registers,
+ * e.g. SMPLRT_DIV, CONFIG, GYRO_CONFIG and ACCEL_CONFIG take one transfer.
+ *
+ * @param dev - device handle
+ * @param table - registers and values
+ * @param count - number of table entries
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Write_Table(MPU6050_Device* dev, const MPU6050_RegValue* table, uint8_t count){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t values[MPU6050_WRITE_BURST_MAX];
+	uint8_t i = 0;
+	uint8_t len;
+
+	while(i < count){
+
+		/* Find run of consecutive register addresses */
+		values[0] = table[i].value;
+		len = 1;
+		while(i + len < count && len < MPU6050_WRITE_BURST_MAX && table[i + len].reg == table[i].reg + len){
+			values[len] = table[i + len].value;
+			len++;
+		}
+
+		errorstatus = MPU6050_Write_Regs(dev, table[i].reg, values, len);
+		if(errorstatus != 0) return errorstatus;
+
+		i += len;
 	}
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_ZOUT_L, &zlow, 1);
-	if(errorstatus != 0){
-		return errorstatus;
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Reload the register shadow from the sensor
+ * Must be called after the sensor was reset or its registers were changed
+ * without MPU6050_Write_Reg. Contiguous registers are read in bursts.
+ *
+ * @param dev - device handle
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Shadow_Resync(MPU6050_Device* dev){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t i = 0;
+	uint8_t len;
+
+	dev->shadowValid = 0;
+
+	while(i < MPU6050_SHADOW_SIZE){
+
+		/* Find run of consecutive register addresses */
+		len = 1;
+		while(i + len < MPU6050_SHADOW_SIZE && MPU6050_Shadow_Regs[i + len] == MPU6050_Shadow_Regs[i] + len){
+			len++;
+		}
+
+		errorstatus = MPU6050_Read(dev, MPU6050_Shadow_Regs[i], &dev->shadow[i], len);
+		if(errorstatus != 0) return errorstatus;
+
+		dev->shadowValid |= ((1 << len) - 1) << i;
+		i += len;
 	}
 
-	errorstatus = MPU6050_Read((MPU6050_ADDRESS & 0x7f) << 1, ACCEL_ZOUT_H, &zhigh, 1);
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Read MPU6050 temperature
+ * TEMP_OUT_H and TEMP_OUT_L are read in one burst so both halves belong to the same sample.
+ *
+ * @param dev - device handle
+ * @retval temp_celsius - temperature in degrees celsius
+ */
+int16_t MPU6050_Get_Temperature(MPU6050_Device* dev){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[2];
+	int16_t temp;
+	int16_t temp_celsius;
+
+	errorstatus = MPU6050_Read(dev, TEMP_OUT_H, buffer, 2);
 	if(errorstatus != 0){
-		return errorstatus;
+		return 1;
 	}
 
-	*X = (int16_t)(xhigh << 8 | xlow);
-	*Y = (int16_t)(yhigh << 8 | ylow);
-	*Z = (int16_t)(zhigh << 8 | zlow);
+	temp = (int16_t)(buffer[0] << 8 | buffer[1]);
+
+	temp_celsius = temp/340 + 36;
+	return temp_celsius;
 
-	return MPU6050_NO_ERROR;
 }
 
-/* @brief Get Gyroscope X,Y,Z calculated data
+/* @brief Get Gyroscope X,Y,Z raw data
+ * All six data registers are read in one burst starting at GYRO_XOUT_H.
  *
+ * @param dev - device handle
  * @param X - sensor roll on X axis
  * @param Y - sensor pitch on Y axis
  * @param Z - sensor jaw on Z axis
  *
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Get_Gyro_Data(float* X, float* Y, float* Z){
+MPU6050_errorstatus MPU6050_Get_Gyro_Data_Raw(MPU6050_Device* dev, int16_t* X, int16_t* Y, int16_t* Z){
 
 	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[6];
 
-	float mult;
-	int16_t gyro_x, gyro_y, gyro_z;
-
-	errorstatus = MPU6050_Get_Gyro_Data_Raw(&gyro_x, &gyro_y, &gyro_z);
-
-	if(dataStruct.gyroMul == MPU6050_GYRO_250){
-		mult = (float)(1/MPU6050_GYRO_RANGE_250);
-	}
-	else if(dataStruct.gyroMul == MPU6050_GYRO_500){
-		mult = (float)(1/MPU6050_GYRO_RANGE_500);
-	}
-	else if(dataStruct.gyroMul == MPU6050_GYRO_1000){
-		mult = (float)(1/MPU6050_GYRO_RANGE_1000);
+	errorstatus = MPU6050_Read(dev, GYRO_XOUT_H, buffer, 6);
+	if(errorstatus != 0){
+		return errorstatus;
 	}
-	else mult = (float)(1/MPU6050_GYRO_RANGE_2000);
 
-	*X = (float)(gyro_x*mult);
-	*Y = (float)(gyro_y*mult);
-	*Z = (float)(gyro_z*mult);
+	*X = (int16_t)(buffer[0] << 8 | buffer[1]);
+	*Y = (int16_t)(buffer[2] << 8 | buffer[3]);
+	*Z = (int16_t)(buffer[4] << 8 | buffer[5]);
 
 	return MPU6050_NO_ERROR;
 }
 
-/* @brief Get Accelerometer X,Y,Z calculated data
+/* @brief Get Accelerometer X,Y,Z raw data
+ * All six data registers are read in one burst starting at ACCEL_XOUT_H.
  *
+ * @param dev - device handle
  * @param X - sensor accel on X axis
  * @param Y - sensor accel on Y axis
  * @param Z - sensor accel on Z axis
  *
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Get_Accel_Data(float* X, float* Y, float* Z){
+MPU6050_errorstatus MPU6050_Get_Accel_Data_Raw(MPU6050_Device* dev, int16_t* X, int16_t* Y, int16_t* Z){
 
 	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[6];
 
-	float mult;
-	int16_t accel_x, accel_y, accel_z;
-
-	errorstatus = MPU6050_Get_Accel_Data_Raw(&accel_x, &accel_y, &accel_z);
-
-	if(dataStruct.accelMul == MPU6050_ACCEL_2g){
-		mult = (float)(1/MPU6050_ACCEL_RANGE_2g);
-	}
-	else if(dataStruct.accelMul == MPU6050_ACCEL_2g){
-		mult = (float)(1/MPU6050_ACCEL_RANGE_4g);
-	}
-	else if(dataStruct.accelMul == MPU6050_ACCEL_2g){
-		mult = (float)(1/MPU6050_ACCEL_RANGE_8g);
+	errorstatus = MPU6050_Read(dev, ACCEL_XOUT_H, buffer, 6);
+	if(errorstatus != 0){
+		return errorstatus;
 	}
-	else mult = (float)(1/MPU6050_ACCEL_RANGE_16g);
 
-	*X = (float)(accel_x*mult);
-	*Y = (float)(accel_y*mult);
-	*Z = (float)(accel_z*mult);
+	*X = (int16_t)(buffer[0] << 8 | buffer[1]);
+	*Y = (int16_t)(buffer[2] << 8 | buffer[3]);
+	*Z = (int16_t)(buffer[4] << 8 | buffer[5]);
 
 	return MPU6050_NO_ERROR;
 }
 
-/* @brief Reads bytes from MPU6050
+/* @brief Decodes ACCEL_XOUT_H..GYRO_ZOUT_L register contents
+ * @param p - MPU6050_SAMPLE_LENGTH bytes as read from the sensor
+ * @param data - structure to store the sample to
+ */
+static void MPU6050_Decode_Sample(const uint8_t* p, MPU6050_rawData* data){
+
+	data->accelX = (int16_t)(p[0] << 8 | p[1]);
+	data->accelY = (int16_t)(p[2] << 8 | p[3]);
+	data->accelZ = (int16_t)(p[4] << 8 | p[5]);
+	data->temp = (int16_t)(p[6] << 8 | p[7]);
+	data->gyroX = (int16_t)(p[8] << 8 | p[9]);
+	data->gyroY = (int16_t)(p[10] << 8 | p[11]);
+	data->gyroZ = (int16_t)(p[12] << 8 | p[13]);
+}
+
+/* @brief Get accelerometer, temperature and gyroscope raw data in one transaction
+ * Registers ACCEL_XOUT_H..GYRO_ZOUT_L are read in a single auto-incrementing burst.
+ * The sensor holds its output registers while a burst is in progress, so all
+ * values in @data belong to the same sample instant.
  *
- * @param SlaveAddr - Slave I2C address
- * @param RegAddr - register address
- * @param pBuffer - buffer to write to
- * @ param NumByteToRead - number of bytes to read
+ * @param dev - device handle
+ * @param data - structure to store the sample to
  *
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Read(uint8_t SlaveAddr, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead)
-{
-
-	/* Test if SDA line busy */
-	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_BUSY) != RESET)
-	{
-		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
-	}
+MPU6050_errorstatus MPU6050_Get_All_Data_Raw(MPU6050_Device* dev, MPU6050_rawData* data){
 
-	I2C_TransferHandling(I2C1, SlaveAddr, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[MPU6050_SAMPLE_LENGTH];
 
-	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_TXIS) == RESET)
-	{
-		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
+	errorstatus = MPU6050_Read(dev, ACCEL_XOUT_H, buffer, MPU6050_SAMPLE_LENGTH);
+	if(errorstatus != 0){
+		return errorstatus;
 	}
 
-	if(NumByteToRead>1)
-	RegAddr |= 0x80;
+	MPU6050_Decode_Sample(buffer, data);
+	MPU6050_Boot_Sample(dev);
 
-	I2C_SendData(I2C1, (uint8_t)RegAddr);
+	return MPU6050_NO_ERROR;
+}
 
-	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_TC) == RESET)
-	{
-		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_TX_ERROR;
-	}
+/* @brief Configure which sensors are written to the FIFO and enable it
+ * FIFO is reset before the new configuration is applied. Samples are pushed
+ * to the FIFO at the sample rate set in SMPLRT_DIV. Auxiliary slaves set up
+ * with fifo = 1 in MPU6050_Aux_Config_Slaves are appended to every frame.
+ *
+ * @param dev - device handle
+ * @param sensors - combination of @fifo_sensors, 0 disables the FIFO
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_FIFO_Config(MPU6050_Device* dev, uint8_t sensors){
 
-    I2C_TransferHandling(I2C1, SlaveAddr, NumByteToRead, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+	MPU6050_errorstatus errorstatus;
+	uint8_t frameLen = 0;
 
-    while (NumByteToRead)
-    {
-    	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-    	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_RXNE) == RESET)
-    	{
-    		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_RX_ERROR;
-    	}
+	/* Stop writing to the FIFO while it is reconfigured */
+	errorstatus = MPU6050_Write_Reg(dev, FIFO_EN, 0);
+	if(errorstatus != 0) return errorstatus;
 
-    	*pBuffer = I2C_ReceiveData(I2C1);
-    	pBuffer++;
+	if(sensors & MPU6050_FIFO_ACCEL) frameLen += 6;
+	if(sensors & MPU6050_FIFO_TEMP) frameLen += 2;
+	if(sensors & MPU6050_FIFO_XG) frameLen += 2;
+	if(sensors & MPU6050_FIFO_YG) frameLen += 2;
+	if(sensors & MPU6050_FIFO_ZG) frameLen += 2;
+	frameLen += dev->auxFifoLen;
 
-    	NumByteToRead--;
-    }
+	dev->fifoSensors = sensors;
+	dev->fifoFrameLen = frameLen;
 
-    MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-    while(I2C_GetFlagStatus(I2C1, I2C_FLAG_STOPF) == RESET)
-    {
-      if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
-    }
+	if(sensors == 0){
+		return MPU6050_Modify_Reg(dev, USER_CTRL, MPU6050_USER_FIFO_EN, 0);
+	}
 
-    I2C_ClearFlag(I2C1, I2C_FLAG_STOPF);
+	errorstatus = MPU6050_FIFO_Reset(dev);
+	if(errorstatus != 0) return errorstatus;
 
-    return MPU6050_NO_ERROR;
+	return MPU6050_Write_Reg(dev, FIFO_EN, sensors | dev->auxFifo);
 }
 
-/* @brief Writes bytes to MPU6050
- *
- * @param SlaveAddr - Slave I2C address
- * @param RegAddr - register address
- * @param pBuffer - buffer to write from
- *
+/* @brief Discard FIFO contents and enable the FIFO again
+ * @param dev - device handle
  * @retval @MPU6050_errorstatus
  */
-MPU6050_errorstatus MPU6050_Write(uint8_t SlaveAddr, uint8_t RegAddr, uint8_t* pBuffer)
-{
-
-	/* Test if SDA line busy */
-	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_BUSY) != RESET)
-	{
-		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
-	}
-
-	I2C_TransferHandling(I2C1, SlaveAddr, 1, I2C_Reload_Mode, I2C_Generate_Start_Write);
+MPU6050_errorstatus MPU6050_FIFO_Reset(MPU6050_Device* dev){
 
-	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_TXIS) == RESET)
-	{
-		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
-	}
+	MPU6050_errorstatus errorstatus;
+	uint8_t tmp;
 
-	I2C_SendData(I2C1, (uint8_t) RegAddr);
+	errorstatus = MPU6050_Modify_Reg(dev, USER_CTRL, MPU6050_USER_FIFO_EN, 0);
+	if(errorstatus != 0) return errorstatus;
 
-	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_TCR) == RESET)
-	{
-		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
-	}
+	/* FIFO_RESET only takes effect while FIFO_EN is cleared and clears itself,
+	 * so it is written past the shadow */
+	errorstatus = MPU6050_Read_Reg(dev, USER_CTRL, &tmp);
+	if(errorstatus != 0) return errorstatus;
 
-	I2C_TransferHandling(I2C1, SlaveAddr, 1, I2C_AutoEnd_Mode, I2C_No_StartStop);
+	tmp |= MPU6050_USER_FIFO_RESET;
+	errorstatus = MPU6050_Write(dev, USER_CTRL, &tmp, 1);
+	if(errorstatus != 0) return errorstatus;
 
-	MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-	while(I2C_GetFlagStatus(I2C1, I2C_FLAG_TXIS) == RESET)
-	{
-		if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
-	}
+	return MPU6050_Modify_Reg(dev, USER_CTRL, MPU6050_USER_FIFO_EN, MPU6050_USER_FIFO_EN);
+}
 
-	I2C_SendData(I2C1, *pBuffer);
+/* @brief Get number of bytes stored in the FIFO
+ * @param dev - device handle
+ * @param count - number of bytes in FIFO
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_FIFO_Get_Count(MPU6050_Device* dev, uint16_t* count){
 
-    MPU6050_Timeout = MPU6050_LONG_TIMEOUT;
-    while(I2C_GetFlagStatus(I2C1, I2C_FLAG_STOPF) == RESET)
-    {
-      if((MPU6050_Timeout--) == 0) return MPU6050_I2C_ERROR;
-    }
+	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[2];
 
-    I2C_ClearFlag(I2C1, I2C_FLAG_STOPF);
+	errorstatus = MPU6050_Read(dev, FIFO_COUNTH, buffer, 2);
+	if(errorstatus != 0) return errorstatus;
 
+	*count = (uint16_t)(buffer[0] << 8 | buffer[1]);
 	return MPU6050_NO_ERROR;
 }
+
+/* @brief Drain whole frames from the FIFO and decode them
+ * Auxiliary slave bytes in the frames are skipped, check MPU6050_FIFO_Read_Samples_Aux.
+ *
+ * @param dev - device handle
+ * @param samples - array to store decoded samples to
+ * @param maxSamples - size of the samples array
+ * @param numSamples - number of samples stored to the array
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_FIFO_Read_Samples(MPU6050_Device* dev, MPU6050_rawData* samples, uint16_t maxSamples, uint16_t* numSamples){
+
+	return MPU6050_FIFO_Read_Samples_Aux(dev, samples, 0, maxSamples, numSamples);
+}
+
+/* @brief Drain whole frames from the FIFO and decode them with auxiliary slave data
+ * Frames are read from FIFO_R_W in bursts of as many whole frames as fit into
+ * MPU6050_FIFO_BURST bytes. Sensors that are not written to the FIFO are
+ * returned as 0. Bytes of a frame that is not complete yet are left in the
+ * FIFO. On overflow, or with the FIFO full, frame boundaries are lost: the
+ * FIFO is reset and MPU6050_FIFO_OVERFLOW is returned with no samples.
+ *
+ * @param dev - device handle
+ * @param samples - array to store decoded samples to
+ * @param aux - array of maxSamples x dev->auxFifoLen bytes for auxiliary slave data, can be 0
+ * @param maxSamples - size of the samples array
+ * @param numSamples - number of samples stored to the array
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_FIFO_Read_Samples_Aux(MPU6050_Device* dev, MPU6050_rawData* samples, uint8_t* aux, uint16_t maxSamples, uint16_t* numSamples){
+
+	return MPU6050_FIFO_Drain(dev, samples, aux, 0, maxSamples, numSamples);
+}
+
+/* @brief Drain whole frames from the FIFO into a sample block
+ * Frames are appended behind the samples already in the block until it is
+ * full. Timestamps are derived from the drain time and dev->samplePeriodUs,
+ * the newest frame in the FIFO is taken as sampled at the drain time.
+ *
+ * @param dev - device handle
+ * @param block - block to append to
+ * @param numSamples - number of samples appended
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_FIFO_Read_Block(MPU6050_Device* dev, MPU6050_Block* block, uint16_t* numSamples){
+
+	return MPU6050_FIFO_Drain(dev, 0, 0, block, MPU6050_BLOCK_SIZE - block->count, numSamples);
+}
+
+/* @brief Drain whole frames from the FIFO to a sample array or a sample block */
+static MPU6050_errorstatus MPU6050_FIFO_Drain(MPU6050_Device* dev, MPU6050_rawData* samples, uint8_t* aux, MPU6050_Block* block, uint16_t maxSamples, uint16_t* numSamples){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[MPU6050_FIFO_BURST];
+	uint8_t intStatus;
+	uint8_t frameLen = dev->fifoFrameLen;
+	uint8_t* p;
+	uint16_t count;
+	uint16_t frames;
+	uint16_t chunk;
+	uint16_t available;
+	uint16_t i;
+	uint32_t now;
+	MPU6050_rawData sample;
+
+	*numSamples = 0;
+	if(frameLen == 0) return MPU6050_NO_ERROR;
+
+	/* Reading INT_STATUS also clears the overflow flag */
+	errorstatus = MPU6050_Read(dev, INT_STATUS, &intStatus, 1);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_FIFO_Get_Count(dev, &count);
+	if(errorstatus != 0) return errorstatus;
+
+	/* A frame the sensor is still writing stays in the FIFO for the next drain */
+	if((intStatus & MPU6050_INT_FIFO_OFLOW) || count >= MPU6050_FIFO_SIZE){
+		errorstatus = MPU6050_FIFO_Reset(dev);
+		if(errorstatus != 0) return errorstatus;
+		return MPU6050_FIFO_OVERFLOW;
+	}
+
+	now = MPU6050_Time_Us();
+	available = count / frameLen;
+	frames = available;
+	if(frames > maxSamples) frames = maxSamples;
+
+	while(frames){
+
+		chunk = MPU6050_FIFO_BURST / frameLen;
+		if(chunk > frames) chunk = frames;
+
+		errorstatus = MPU6050_Read(dev, FIFO_R_W, buffer, chunk * frameLen);
+		if(errorstatus != 0) return errorstatus;
+
+		/* Frame layout: accel, temperature, gyro X, Y, Z */
+		p = buffer;
+		for(i = 0; i < chunk; i++){
+
+			sample.accelX = sample.accelY = sample.accelZ = 0;
+			sample.temp = 0;
+			sample.gyroX = sample.gyroY = sample.gyroZ = 0;
+
+			if(dev->fifoSensors & MPU6050_FIFO_ACCEL){
+				sample.accelX = (int16_t)(p[0] << 8 | p[1]);
+				sample.accelY = (int16_t)(p[2] << 8 | p[3]);
+				sample.accelZ = (int16_t)(p[4] << 8 | p[5]);
+				p += 6;
+			}
+			if(dev->fifoSensors & MPU6050_FIFO_TEMP){
+				sample.temp = (int16_t)(p[0] << 8 | p[1]);
+				p += 2;
+			}
+			if(dev->fifoSensors & MPU6050_FIFO_XG){
+				sample.gyroX = (int16_t)(p[0] << 8 | p[1]);
+				p += 2;
+			}
+			if(dev->fifoSensors & MPU6050_FIFO_YG){
+				sample.gyroY = (int16_t)(p[0] << 8 | p[1]);
+				p += 2;
+			}
+			if(dev->fifoSensors & MPU6050_FIFO_ZG){
+				sample.gyroZ = (int16_t)(p[0] << 8 | p[1]);
+				p += 2;
+			}
+			if(dev->auxFifoLen){
+				if(aux != 0){
+					memcpy(aux, p, dev->auxFifoLen);
+					aux += dev->auxFifoLen;
+				}
+				p += dev->auxFifoLen;
+			}
+
+			if(block != 0){
+				/* Frame j of the available ones was sampled (available - 1 - j) periods ago */
+				MPU6050_Block_Append(block, &sample, now - (uint32_t)(available - 1 - (*numSamples + i)) * dev->samplePeriodUs);
+			}
+			else *samples++ = sample;
+		}
+
+		*numSamples += chunk;
+		frames -= chunk;
+	}
+
+	if(*numSamples) MPU6050_Boot_Sample(dev);
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Get Gyroscope X,Y,Z calculated data
+ *
+ * @param dev - device handle
+ * @param X - sensor roll on X axis
+ * @param Y - sensor pitch on Y axis
+ * @param Z - sensor jaw on Z axis
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Get_Gyro_Data(MPU6050_Device* dev, float* X, float* Y, float* Z){
+
+	MPU6050_errorstatus errorstatus;
+
+	int16_t gyro_x, gyro_y, gyro_z;
+
+	errorstatus = MPU6050_Get_Gyro_Data_Raw(dev, &gyro_x, &gyro_y, &gyro_z);
+	if(errorstatus != 0) return errorstatus;
+
+	*X = (float)(gyro_x*dev->gyroMul);
+	*Y = (float)(gyro_y*dev->gyroMul);
+	*Z = (float)(gyro_z*dev->gyroMul);
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Get Accelerometer X,Y,Z calculated data
+ *
+ * @param dev - device handle
+ * @param X - sensor accel on X axis
+ * @param Y - sensor accel on Y axis
+ * @param Z - sensor accel on Z axis
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Get_Accel_Data(MPU6050_Device* dev, float* X, float* Y, float* Z){
+
+	MPU6050_errorstatus errorstatus;
+
+	int16_t accel_x, accel_y, accel_z;
+
+	errorstatus = MPU6050_Get_Accel_Data_Raw(dev, &accel_x, &accel_y, &accel_z);
+	if(errorstatus != 0) return errorstatus;
+
+	*X = (float)(accel_x*dev->accelMul);
+	*Y = (float)(accel_y*dev->accelMul);
+	*Z = (float)(accel_z*dev->accelMul);
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Get Gyroscope X,Y,Z data in Q16.16 fixed point
+ * Uses the integer multiplier chosen by MPU6050_Gyro_Set_Range, no float operations.
+ *
+ * @param dev - device handle
+ * @param X - rate on X axis, Q16.16 deg/s
+ * @param Y - rate on Y axis, Q16.16 deg/s
+ * @param Z - rate on Z axis, Q16.16 deg/s
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Get_Gyro_Data_Fixed(MPU6050_Device* dev, int32_t* X, int32_t* Y, int32_t* Z){
+
+	MPU6050_errorstatus errorstatus;
+
+	int16_t gyro_x, gyro_y, gyro_z;
+
+	errorstatus = MPU6050_Get_Gyro_Data_Raw(dev, &gyro_x, &gyro_y, &gyro_z);
+	if(errorstatus != 0) return errorstatus;
+
+	*X = MPU6050_Q32_TO_Q16(gyro_x, dev->gyroMulQ32);
+	*Y = MPU6050_Q32_TO_Q16(gyro_y, dev->gyroMulQ32);
+	*Z = MPU6050_Q32_TO_Q16(gyro_z, dev->gyroMulQ32);
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Get Accelerometer X,Y,Z data in Q16.16 fixed point
+ * Uses the integer multiplier chosen by MPU6050_Accel_Set_Range, no float operations.
+ *
+ * @param dev - device handle
+ * @param X - acceleration on X axis, Q16.16 mg
+ * @param Y - acceleration on Y axis, Q16.16 mg
+ * @param Z - acceleration on Z axis, Q16.16 mg
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Get_Accel_Data_Fixed(MPU6050_Device* dev, int32_t* X, int32_t* Y, int32_t* Z){
+
+	MPU6050_errorstatus errorstatus;
+
+	int16_t accel_x, accel_y, accel_z;
+
+	errorstatus = MPU6050_Get_Accel_Data_Raw(dev, &accel_x, &accel_y, &accel_z);
+	if(errorstatus != 0) return errorstatus;
+
+	*X = accel_x * dev->accelMulQ16;
+	*Y = accel_y * dev->accelMulQ16;
+	*Z = accel_z * dev->accelMulQ16;
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Convert a raw sample to Q16.16 fixed point
+ * Accelerometer products fit in 32 bits for every range, 32768 x 32000 at
+ * 16 g is the largest one. Gyroscope and temperature take a 64-bit product
+ * of the Q0.32 multiplier and are within one Q16.16 LSB of the exact value.
+ *
+ * @param dev - device the sample was read from
+ * @param raw - raw sample, e.g. from MPU6050_DRDY_Get_Sample
+ * @param out - converted sample
+ */
+void MPU6050_Convert_Fixed(MPU6050_Device* dev, const MPU6050_rawData* raw, MPU6050_fixedData* out){
+
+	out->accelX = raw->accelX * dev->accelMulQ16;
+	out->accelY = raw->accelY * dev->accelMulQ16;
+	out->accelZ = raw->accelZ * dev->accelMulQ16;
+	out->temp = MPU6050_Q32_TO_Q16(raw->temp, MPU6050_TEMP_Q32_MUL) + MPU6050_TEMP_Q16_OFFSET;
+	out->gyroX = MPU6050_Q32_TO_Q16(raw->gyroX, dev->gyroMulQ32);
+	out->gyroY = MPU6050_Q32_TO_Q16(raw->gyroY, dev->gyroMulQ32);
+	out->gyroZ = MPU6050_Q32_TO_Q16(raw->gyroZ, dev->gyroMulQ32);
+}
+
+/* @brief Read one sample from each of several devices back to back
+ * All bursts are issued first and decoded afterwards, so the samples are taken
+ * as close together as the buses allow. Devices can share a bus or sit on
+ * different ones. A failed device does not stop the batch, its sample is left
+ * unchanged and the first error is returned.
+ *
+ * @param devs - array of device handles
+ * @param count - number of devices, 1..MPU6050_BATCH_MAX
+ * @param samples - array of count samples, samples[i] belongs to devs[i]
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Read_Batch(MPU6050_Device** devs, uint8_t count, MPU6050_rawData* samples){
+
+	MPU6050_errorstatus errorstatus = MPU6050_NO_ERROR;
+	MPU6050_errorstatus result[MPU6050_BATCH_MAX];
+	uint8_t buffer[MPU6050_BATCH_MAX][MPU6050_SAMPLE_LENGTH];
+	uint8_t i;
+
+	if(count == 0 || count > MPU6050_BATCH_MAX) return MPU6050_CONFIG_ERROR;
+
+	for(i = 0; i < count; i++){
+		result[i] = MPU6050_Read(devs[i], ACCEL_XOUT_H, buffer[i], MPU6050_SAMPLE_LENGTH);
+	}
+
+	for(i = 0; i < count; i++){
+		if(result[i] != 0){
+			if(errorstatus == 0) errorstatus = result[i];
+			continue;
+		}
+
+		MPU6050_Decode_Sample(buffer[i], &samples[i]);
+		MPU6050_Boot_Sample(devs[i]);
+	}
+
+	return errorstatus;
+}
+
+/* @brief Average samples of redundant sensors
+ * Sensors must be mounted with the same orientation and set to the same
+ * full scale ranges. Averaging N sensors lowers uncorrelated noise by sqrt(N).
+ *
+ * @param samples - array of samples, e.g. filled by MPU6050_Read_Batch
+ * @param count - number of samples, at least 1
+ * @param average - rounded mean of every field
+ */
+void MPU6050_Average_Samples(const MPU6050_rawData* samples, uint8_t count, MPU6050_rawData* average){
+
+	int32_t sum[7] = {0, 0, 0, 0, 0, 0, 0};
+	int32_t half = count / 2;
+	uint8_t i;
+
+	for(i = 0; i < count; i++){
+		sum[0] += samples[i].accelX;
+		sum[1] += samples[i].accelY;
+		sum[2] += samples[i].accelZ;
+		sum[3] += samples[i].temp;
+		sum[4] += samples[i].gyroX;
+		sum[5] += samples[i].gyroY;
+		sum[6] += samples[i].gyroZ;
+	}
+
+	/* Round half away from zero */
+	for(i = 0; i < 7; i++){
+		sum[i] = (sum[i] >= 0) ? (sum[i] + half) / count : (sum[i] - half) / count;
+	}
+
+	average->accelX = (int16_t)sum[0];
+	average->accelY = (int16_t)sum[1];
+	average->accelZ = (int16_t)sum[2];
+	average->temp = (int16_t)sum[3];
+	average->gyroX = (int16_t)sum[4];
+	average->gyroY = (int16_t)sum[5];
+	average->gyroZ = (int16_t)sum[6];
+}
+
+/* @brief Empty a sample block
+ * @param block - sample block
+ */
+void MPU6050_Block_Reset(MPU6050_Block* block){
+
+	block->count = 0;
+}
+
+/* @brief Append one sample to a sample block
+ * @param block - sample block
+ * @param data - sample to append
+ * @param timestamp - sample time in microseconds
+ * @retval 1 if the sample was appended, 0 if the block is full
+ */
+uint8_t MPU6050_Block_Append(MPU6050_Block* block, const MPU6050_rawData* data, uint32_t timestamp){
+
+	uint16_t i = block->count;
+
+	if(i >= MPU6050_BLOCK_SIZE) return 0;
+
+	block->accelX[i] = data->accelX;
+	block->accelY[i] = data->accelY;
+	block->accelZ[i] = data->accelZ;
+	block->temp[i] = data->temp;
+	block->gyroX[i] = data->gyroX;
+	block->gyroY[i] = data->gyroY;
+	block->gyroZ[i] = data->gyroZ;
+	block->timestamp[i] = timestamp;
+	block->count = i + 1;
+
+	return 1;
+}
+
+/* @brief Get one sample of a sample block
+ * @param block - sample block
+ * @param index - sample index, 0..count - 1
+ * @param data - structure to store the sample to
+ */
+void MPU6050_Block_Get(const MPU6050_Block* block, uint16_t index, MPU6050_rawData* data){
+
+	data->accelX = block->accelX[index];
+	data->accelY = block->accelY[index];
+	data->accelZ = block->accelZ[index];
+	data->temp = block->temp[index];
+	data->gyroX = block->gyroX[index];
+	data->gyroY = block->gyroY[index];
+	data->gyroZ = block->gyroZ[index];
+}
+
+/* @brief Enables the auxiliary I2C master
+ * The MPU6050 becomes master of its auxiliary bus and delays data ready until
+ * the external sensor data of a sample is loaded.
+ *
+ * @param dev - device handle
+ * @param clock - auxiliary bus clock, check @aux_clock
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Aux_Enable(MPU6050_Device* dev, uint8_t clock){
+
+	MPU6050_errorstatus errorstatus;
+
+	errorstatus = MPU6050_Modify_Reg(dev, INT_PIN_CFG, MPU6050_INTCFG_I2C_BYPASS_EN, 0);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Modify_Reg(dev, I2C_MST_CTRL, MPU6050_MST_WAIT_FOR_ES | MPU6050_MST_CLK_MASK,
+									 MPU6050_MST_WAIT_FOR_ES | (clock & MPU6050_MST_CLK_MASK));
+	if(errorstatus != 0) return errorstatus;
+
+	return MPU6050_Modify_Reg(dev, USER_CTRL, MPU6050_USER_I2C_MST_EN, MPU6050_USER_I2C_MST_EN);
+}
+
+/* @brief Stops polling auxiliary slaves and disables the auxiliary I2C master
+ * @param dev - device handle
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Aux_Disable(MPU6050_Device* dev){
+
+	MPU6050_errorstatus errorstatus;
+
+	errorstatus = MPU6050_Aux_Config_Slaves(dev, 0, 0);
+	if(errorstatus != 0) return errorstatus;
+
+	return MPU6050_Modify_Reg(dev, USER_CTRL, MPU6050_USER_I2C_MST_EN, 0);
+}
+
+/* @brief Single register transfer on the auxiliary bus through slave 4
+ * Slave 4 transfer runs once at the next sample, so the sample rate must be
+ * high enough to finish within MPU6050_TIMEOUT_US.
+ */
+static MPU6050_errorstatus MPU6050_Aux_Transfer(MPU6050_Device* dev, uint8_t address, uint8_t RegAddr, uint8_t* value, uint8_t read){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t tmp;
+	uint32_t start;
+
+	tmp = (address & 0x7f) | (read ? MPU6050_SLV_READ : 0);
+	errorstatus = MPU6050_Write(dev, I2C_SLV4_ADDR, &tmp, 1);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Write(dev, I2C_SLV4_REG, &RegAddr, 1);
+	if(errorstatus != 0) return errorstatus;
+
+	if(!read){
+		errorstatus = MPU6050_Write(dev, I2C_SLV4_DO, value, 1);
+		if(errorstatus != 0) return errorstatus;
+	}
+
+	/* Reading I2C_MST_STATUS clears it, stale done flag is dropped first */
+	errorstatus = MPU6050_Read(dev, I2C_MST_STATUS, &tmp, 1);
+	if(errorstatus != 0) return errorstatus;
+
+	tmp = MPU6050_SLV_EN;
+	errorstatus = MPU6050_Write(dev, I2C_SLV4_CTRL, &tmp, 1);
+	if(errorstatus != 0) return errorstatus;
+
+	start = DWT->CYCCNT;
+	do{
+		errorstatus = MPU6050_Read(dev, I2C_MST_STATUS, &tmp, 1);
+		if(errorstatus != 0) return errorstatus;
+		if(tmp & MPU6050_MST_SLV4_NACK) return MPU6050_I2C_NACK;
+		if(MPU6050_Elapsed_Us(start) > MPU6050_TIMEOUT_US) return MPU6050_I2C_ERROR;
+	}while(!(tmp & MPU6050_MST_SLV4_DONE));
+
+	if(read) return MPU6050_Read(dev, I2C_SLV4_DI, value, 1);
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Write a register of a sensor on the auxiliary bus
+ * Used to set up the auxiliary sensor, e.g. magnetometer measurement mode.
+ * MPU6050_Aux_Enable must be called first.
+ *
+ * @param dev - device handle
+ * @param address - 7-bit I2C address of the auxiliary sensor
+ * @param RegAddr - register address
+ * @param value - value to write
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Aux_Write_Reg(MPU6050_Device* dev, uint8_t address, uint8_t RegAddr, uint8_t value){
+
+	return MPU6050_Aux_Transfer(dev, address, RegAddr, &value, 0);
+}
+
+/* @brief Read a register of a sensor on the auxiliary bus
+ * MPU6050_Aux_Enable must be called first.
+ *
+ * @param dev - device handle
+ * @param address - 7-bit I2C address of the auxiliary sensor
+ * @param RegAddr - register address
+ * @param value - register value
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Aux_Read_Reg(MPU6050_Device* dev, uint8_t address, uint8_t RegAddr, uint8_t* value){
+
+	return MPU6050_Aux_Transfer(dev, address, RegAddr, value, 1);
+}
+
+/* @brief Set up auxiliary slaves polled on every sample
+ * Slave i is read into EXT_SENS_DATA right after slave i-1, so the bytes follow
+ * GYRO_ZOUT_L and are returned by the same burst as accelerometer and gyroscope.
+ * Slaves not in the list are disabled. If the FIFO is enabled it is reconfigured
+ * so its frames match the new layout.
+ *
+ * @param dev - device handle
+ * @param slaves - slaves to poll, can be 0 if count is 0
+ * @param count - number of slaves, 0..MPU6050_AUX_MAX_SLAVES
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Aux_Config_Slaves(MPU6050_Device* dev, const MPU6050_AuxSlave* slaves, uint8_t count){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t regs[3 * MPU6050_AUX_MAX_SLAVES];
+	uint8_t len = 0;
+	uint8_t fifoLen = 0;
+	uint8_t fifo = 0;
+	uint8_t i;
+
+	if(count > MPU6050_AUX_MAX_SLAVES) return MPU6050_CONFIG_ERROR;
+
+	for(i = 0; i < count; i++){
+		if(slaves[i].length == 0 || slaves[i].length > MPU6050_SLV_LEN_MASK) return MPU6050_CONFIG_ERROR;
+		len += slaves[i].length;
+	}
+	if(len > MPU6050_AUX_MAX_BYTES) return MPU6050_CONFIG_ERROR;
+
+	/* I2C_SLVx_ADDR, I2C_SLVx_REG and I2C_SLVx_CTRL of SLV0..SLV3 are consecutive,
+	 * all of them are written in one burst, unused slaves are disabled */
+	memset(regs, 0, sizeof(regs));
+	for(i = 0; i < count; i++){
+		regs[3 * i] = (slaves[i].address & 0x7f) | MPU6050_SLV_READ;
+		regs[3 * i + 1] = slaves[i].reg;
+		regs[3 * i + 2] = MPU6050_SLV_EN | slaves[i].length;
+
+		if(slaves[i].fifo){
+			fifoLen += slaves[i].length;
+			if(i < 3) fifo |= MPU6050_FIFO_SLV0 << i;
+		}
+	}
+
+	errorstatus = MPU6050_Write(dev, I2C_SLV0_ADDR, regs, sizeof(regs));
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Modify_Reg(dev, I2C_MST_CTRL, MPU6050_MST_SLV3_FIFO_EN,
+									 (count > 3 && slaves[3].fifo) ? MPU6050_MST_SLV3_FIFO_EN : 0);
+	if(errorstatus != 0) return errorstatus;
+
+	dev->auxLen = len;
+	dev->auxFifoLen = fifoLen;
+	dev->auxFifo = fifo;
+
+	if(dev->fifoSensors != 0) return MPU6050_FIFO_Config(dev, dev->fifoSensors);
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Get accelerometer, temperature, gyroscope and auxiliary slave data in one transaction
+ * ACCEL_XOUT_H..GYRO_ZOUT_L and the EXT_SENS_DATA bytes of all configured
+ * slaves are read in a single burst, so they belong to the same sample.
+ *
+ * @param dev - device handle
+ * @param data - structure to store the sample to
+ * @param aux - buffer of dev->auxLen bytes for EXT_SENS_DATA
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Get_All_Data_Aux(MPU6050_Device* dev, MPU6050_rawData* data, uint8_t* aux){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t buffer[MPU6050_SAMPLE_LENGTH + MPU6050_AUX_MAX_BYTES];
+
+	errorstatus = MPU6050_Read(dev, ACCEL_XOUT_H, buffer, MPU6050_SAMPLE_LENGTH + dev->auxLen);
+	if(errorstatus != 0){
+		return errorstatus;
+	}
+
+	MPU6050_Decode_Sample(buffer, data);
+	memcpy(aux, &buffer[MPU6050_SAMPLE_LENGTH], dev->auxLen);
+	MPU6050_Boot_Sample(dev);
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Reads bytes from MPU6050
+ * If an I2C transfer fails the bus is recovered before the error is returned,
+ * so the next call starts on an idle bus.
+ *
+ * @param dev - device handle
+ * @param RegAddr - register address
+ * @param pBuffer - buffer to write to
+ * @ param NumByteToRead - number of bytes to read
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Read(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead)
+{
+
+	MPU6050_errorstatus errorstatus;
+
+	dev->stats.transfers++;
+
+	if(dev->bus->interface == MPU6050_INTERFACE_SPI){
+		errorstatus = MPU6050_SPI_Transfer(dev, RegAddr | MPU6050_SPI_READ, pBuffer, NumByteToRead);
+		if(errorstatus != 0) dev->stats.errors++;
+		return errorstatus;
+	}
+
+	errorstatus = MPU6050_Read_Transfer(dev, RegAddr, pBuffer, NumByteToRead);
+	if(errorstatus != 0){
+		dev->stats.errors++;
+		MPU6050_Bus_Recover(dev);
+	}
+	return errorstatus;
+}
+
+/* @brief Writes bytes to MPU6050
+ * Several bytes are written to consecutive registers in one burst, the sensor
+ * auto-increments the register address. FIFO_R_W is not incremented.
+ * If an I2C transfer fails the bus is recovered before the error is returned.
+ *
+ * @param dev - device handle
+ * @param RegAddr - register address
+ * @param pBuffer - buffer to write from
+ * @param NumByteToWrite - number of bytes to write, 1..255
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Write(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToWrite)
+{
+
+	MPU6050_errorstatus errorstatus;
+
+	dev->stats.transfers++;
+
+	if(dev->bus->interface == MPU6050_INTERFACE_SPI){
+		errorstatus = MPU6050_SPI_Transfer(dev, RegAddr & ~MPU6050_SPI_READ, pBuffer, NumByteToWrite);
+		if(errorstatus != 0) dev->stats.errors++;
+		return errorstatus;
+	}
+
+	errorstatus = MPU6050_Write_Transfer(dev, RegAddr, pBuffer, NumByteToWrite);
+	if(errorstatus != 0){
+		dev->stats.errors++;
+		MPU6050_Bus_Recover(dev);
+	}
+	return errorstatus;
+}
+
+/* @brief Blocking read transfer without bus recovery */
+static MPU6050_errorstatus MPU6050_Read_Transfer(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead)
+{
+
+	I2C_TypeDef* I2Cx = dev->bus->I2Cx;
+	uint8_t SlaveAddr = dev->address << 1;
+
+	/* Test if SDA line busy */
+	if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_BUSY, RESET) != 0) return MPU6050_I2C_ERROR;
+
+	I2C_TransferHandling(I2Cx, SlaveAddr, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+
+	if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_TXIS, SET) != 0) return MPU6050_I2C_ERROR;
+
+	/* MPU6050 auto-increments the register pointer on its own,
+	 * the register address is sent unmodified also for burst reads */
+	I2C_SendData(I2Cx, (uint8_t)RegAddr);
+
+	if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_TC, SET) != 0) return MPU6050_I2C_TX_ERROR;
+
+    I2C_TransferHandling(I2Cx, SlaveAddr, NumByteToRead, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+
+    while (NumByteToRead)
+    {
+    	if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_RXNE, SET) != 0) return MPU6050_I2C_RX_ERROR;
+
+    	*pBuffer = I2C_ReceiveData(I2Cx);
+    	pBuffer++;
+
+    	NumByteToRead--;
+    }
+
+    if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_STOPF, SET) != 0) return MPU6050_I2C_ERROR;
+
+    I2C_ClearFlag(I2Cx, I2C_FLAG_STOPF);
+
+    return MPU6050_NO_ERROR;
+}
+
+/* @brief Blocking write transfer without bus recovery */
+static MPU6050_errorstatus MPU6050_Write_Transfer(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToWrite)
+{
+
+	I2C_TypeDef* I2Cx = dev->bus->I2Cx;
+	uint8_t SlaveAddr = dev->address << 1;
+
+	/* Test if SDA line busy */
+	if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_BUSY, RESET) != 0) return MPU6050_I2C_ERROR;
+
+	I2C_TransferHandling(I2Cx, SlaveAddr, 1, I2C_Reload_Mode, I2C_Generate_Start_Write);
+
+	if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_TXIS, SET) != 0) return MPU6050_I2C_ERROR;
+
+	I2C_SendData(I2Cx, (uint8_t) RegAddr);
+
+	if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_TCR, SET) != 0) return MPU6050_I2C_ERROR;
+
+	I2C_TransferHandling(I2Cx, SlaveAddr, NumByteToWrite, I2C_AutoEnd_Mode, I2C_No_StartStop);
+
+	while(NumByteToWrite)
+	{
+		if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_TXIS, SET) != 0) return MPU6050_I2C_ERROR;
+
+		I2C_SendData(I2Cx, *pBuffer);
+		pBuffer++;
+
+		NumByteToWrite--;
+	}
+
+    if(MPU6050_Wait_Flag(I2Cx, I2C_FLAG_STOPF, SET) != 0) return MPU6050_I2C_ERROR;
+
+    I2C_ClearFlag(I2Cx, I2C_FLAG_STOPF);
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Enables the DWT cycle counter used for I2C timeouts
+ * Called from MPU6050_Device_Init and MPU6050_Initialization, can be called
+ * again at any time.
+ */
+void MPU6050_Timebase_Init(void){
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* @brief Get microseconds elapsed since a DWT cycle counter value
+ * @param start - DWT->CYCCNT value at the start of the interval
+ * @retval elapsed time in microseconds
+ */
+static uint32_t MPU6050_Elapsed_Us(uint32_t start){
+
+	return (DWT->CYCCNT - start) / (SystemCoreClock / 1000000);
+}
+
+/* @brief Get a microsecond time base for sample timestamps
+ * Extends the DWT cycle counter, which wraps after about a minute at 72 MHz,
+ * to a 32-bit microsecond count. Must be called at least once per wrap of
+ * the cycle counter, sample reads do that while streaming.
+ *
+ * @retval microseconds since the cycle counter was enabled
+ */
+uint32_t MPU6050_Time_Us(void){
+
+	uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+	uint32_t primask;
+	uint32_t now;
+	uint32_t cycles;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	now = DWT->CYCCNT;
+	cycles = now - MPU6050_Time_Cycles + MPU6050_Time_Rest;
+	MPU6050_Time_Cycles = now;
+	MPU6050_Time_Now += cycles / cyclesPerUs;
+	MPU6050_Time_Rest = cycles % cyclesPerUs;
+	now = MPU6050_Time_Now;
+
+	__set_PRIMASK(primask);
+
+	return now;
+}
+
+/* @brief Stores time from the start of MPU6050_Initialization to the first sample of dev */
+static void MPU6050_Boot_Sample(MPU6050_Device* dev){
+
+	if(dev->stats.firstSampleUs != 0 || dev->initStart == 0) return;
+
+	dev->stats.firstSampleUs = MPU6050_Elapsed_Us(dev->initStart);
+}
+
+/* @brief Waits until I2C flag reaches the given state or MPU6050_TIMEOUT_US expires
+ * @param I2Cx - I2C peripheral
+ * @param flag - I2C flag to test
+ * @param state - SET or RESET
+ * @retval 0 when the flag reached the state, 1 on timeout
+ */
+static uint8_t MPU6050_Wait_Flag(I2C_TypeDef* I2Cx, uint32_t flag, FlagStatus state){
+
+	uint32_t start = DWT->CYCCNT;
+
+	while(I2C_GetFlagStatus(I2Cx, flag) != state)
+	{
+		if(MPU6050_Elapsed_Us(start) > MPU6050_TIMEOUT_US) return 1;
+	}
+	return 0;
+}
+
+/* @brief Busy waits for a number of microseconds */
+static void MPU6050_Delay_Us(uint32_t us){
+
+	uint32_t start = DWT->CYCCNT;
+
+	while(MPU6050_Elapsed_Us(start) < us);
+}
+
+/* @brief Waits until SPI flag reaches the given state or MPU6050_TIMEOUT_US expires
+ * @param SPIx - SPI peripheral
+ * @param flag - SPI flag to test
+ * @param state - SET or RESET
+ * @retval 0 when the flag reached the state, 1 on timeout
+ */
+static uint8_t MPU6050_SPI_Wait_Flag(SPI_TypeDef* SPIx, uint16_t flag, FlagStatus state){
+
+	uint32_t start = DWT->CYCCNT;
+
+	while(SPI_I2S_GetFlagStatus(SPIx, flag) != state)
+	{
+		if(MPU6050_Elapsed_Us(start) > MPU6050_TIMEOUT_US) return 1;
+	}
+	return 0;
+}
+
+/* @brief Blocking SPI transfer framed by chip select
+ * First byte is the register address, bit 7 set selects a read. Reads of the
+ * sensor and interrupt registers run at MPU6050_SPI_FAST_HZ, all other
+ * transfers at MPU6050_SPI_SLOW_HZ as required by the MPU-6000.
+ *
+ * @param dev - device handle
+ * @param RegAddr - register address with MPU6050_SPI_READ for reads
+ * @param pBuffer - buffer to read to or write from
+ * @param NumBytes - number of data bytes
+ *
+ * @retval @MPU6050_errorstatus
+ */
+static MPU6050_errorstatus MPU6050_SPI_Transfer(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumBytes){
+
+	SPI_TypeDef* SPIx = dev->bus->SPIx;
+	MPU6050_errorstatus errorstatus = MPU6050_NO_ERROR;
+	uint8_t reg = RegAddr & ~MPU6050_SPI_READ;
+	uint16_t prescaler = dev->spiSlow;
+	uint16_t i;
+
+	if((RegAddr & MPU6050_SPI_READ) && reg >= INT_STATUS && reg + NumBytes - 1 <= EXT_SENS_DATA_23){
+		prescaler = dev->spiFast;
+	}
+
+	/* Baud rate can only be changed while SPI is disabled */
+	if((SPIx->CR1 & SPI_CR1_BR) != prescaler){
+		SPI_Cmd(SPIx, DISABLE);
+		SPIx->CR1 = (SPIx->CR1 & ~SPI_CR1_BR) | prescaler;
+	}
+	SPI_RxFIFOThresholdConfig(SPIx, SPI_RxFIFOThreshold_QF);
+	SPI_Cmd(SPIx, ENABLE);
+
+	GPIO_ResetBits(dev->csPort, dev->csPin);
+
+	/* Address byte followed by data bytes, a dummy byte is clocked out for every byte read */
+	for(i = 0; i <= NumBytes; i++){
+
+		if(MPU6050_SPI_Wait_Flag(SPIx, SPI_I2S_FLAG_TXE, SET) != 0){
+			errorstatus = MPU6050_SPI_ERROR;
+			break;
+		}
+
+		if(i == 0) SPI_SendData8(SPIx, RegAddr);
+		else if(RegAddr & MPU6050_SPI_READ) SPI_SendData8(SPIx, 0xFF);
+		else SPI_SendData8(SPIx, pBuffer[i - 1]);
+
+		if(MPU6050_SPI_Wait_Flag(SPIx, SPI_I2S_FLAG_RXNE, SET) != 0){
+			errorstatus = MPU6050_SPI_ERROR;
+			break;
+		}
+
+		if(i != 0 && (RegAddr & MPU6050_SPI_READ)) pBuffer[i - 1] = SPI_ReceiveData8(SPIx);
+		else SPI_ReceiveData8(SPIx);
+	}
+
+	if(MPU6050_SPI_Wait_Flag(SPIx, SPI_I2S_FLAG_BSY, RESET) != 0) errorstatus = MPU6050_SPI_ERROR;
+
+	GPIO_SetBits(dev->csPort, dev->csPin);
+
+	return errorstatus;
+}
+
+/* @brief Frees a hung bus and restores sensor configuration
+ * A slave holding SDA low is released by clocking out up to nine SCL pulses
+ * and generating a STOP condition with the pins driven as GPIO. I2C peripheral
+ * is then software reset and all valid shadow registers of dev are written back.
+ * Duration is stored in the statistics of dev.
+ *
+ * @param dev - device whose transfer failed
+ */
+void MPU6050_Bus_Recover(MPU6050_Device* dev){
+
+	const MPU6050_Bus* bus = dev->bus;
+	GPIO_InitTypeDef GPIO_InitStructure;
+	uint32_t start = DWT->CYCCNT;
+	uint32_t moder, otyper, ospeedr, pupdr;
+	uint32_t duration;
+	uint8_t i;
+
+	/* Recovery can fail itself while configuration is being restored */
+	if(MPU6050_Recovering) return;
+	MPU6050_Recovering = 1;
+
+	I2C_Cmd(bus->I2Cx, DISABLE);
+
+	moder = bus->GPIOx->MODER;
+	otyper = bus->GPIOx->OTYPER;
+	ospeedr = bus->GPIOx->OSPEEDR;
+	pupdr = bus->GPIOx->PUPDR;
+
+	GPIO_SetBits(bus->GPIOx, bus->sclPin | bus->sdaPin);
+	GPIO_InitStructure.GPIO_Pin = bus->sclPin | bus->sdaPin;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_InitStructure.GPIO_OType = GPIO_OType_OD;
+	GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_UP;
+	GPIO_Init(bus->GPIOx, &GPIO_InitStructure);
+
+	/* Clock out the byte the slave is stuck in, at roughly 100 kHz */
+	for(i = 0; i < 9; i++){
+		if(GPIO_ReadInputDataBit(bus->GPIOx, bus->sdaPin) != Bit_RESET) break;
+		GPIO_ResetBits(bus->GPIOx, bus->sclPin);
+		MPU6050_Delay_Us(5);
+		GPIO_SetBits(bus->GPIOx, bus->sclPin);
+		MPU6050_Delay_Us(5);
+	}
+
+	/* STOP condition: SDA rises while SCL is high */
+	GPIO_ResetBits(bus->GPIOx, bus->sclPin);
+	MPU6050_Delay_Us(5);
+	GPIO_ResetBits(bus->GPIOx, bus->sdaPin);
+	MPU6050_Delay_Us(5);
+	GPIO_SetBits(bus->GPIOx, bus->sclPin);
+	MPU6050_Delay_Us(5);
+	GPIO_SetBits(bus->GPIOx, bus->sdaPin);
+	MPU6050_Delay_Us(5);
+
+	/* Give the pins back to I2C with their original configuration */
+	bus->GPIOx->PUPDR = pupdr;
+	bus->GPIOx->OSPEEDR = ospeedr;
+	bus->GPIOx->OTYPER = otyper;
+	bus->GPIOx->MODER = moder;
+
+	I2C_Cmd(bus->I2Cx, ENABLE);
+	I2C_SoftwareResetCmd(bus->I2Cx);
+
+	/* A failed restore leaves its transfer open, release the bus for the next one */
+	if(MPU6050_Shadow_Restore(dev) != 0) I2C_SoftwareResetCmd(bus->I2Cx);
+
+	duration = MPU6050_Elapsed_Us(start);
+	dev->stats.recoveries++;
+	dev->stats.lastRecoveryUs = duration;
+	if(duration > dev->stats.maxRecoveryUs) dev->stats.maxRecoveryUs = duration;
+
+	MPU6050_Recovering = 0;
+}
+
+/* @brief Writes all valid shadow registers back to the sensor
+ * Valid registers with consecutive addresses are written in one burst.
+ *
+ * @param dev - device handle
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Shadow_Restore(MPU6050_Device* dev){
+
+	MPU6050_errorstatus errorstatus;
+	uint8_t i = 0;
+	uint8_t len;
+
+	while(i < MPU6050_SHADOW_SIZE){
+		if(!(dev->shadowValid & (1 << i))){
+			i++;
+			continue;
+		}
+
+		len = 1;
+		while(i + len < MPU6050_SHADOW_SIZE && (dev->shadowValid & (1 << (i + len))) &&
+			  MPU6050_Shadow_Regs[i + len] == MPU6050_Shadow_Regs[i] + len){
+			len++;
+		}
+
+		errorstatus = MPU6050_Write_Transfer(dev, MPU6050_Shadow_Regs[i], &dev->shadow[i], len);
+		if(errorstatus != 0){
+			dev->shadowValid &= ~(((1 << len) - 1) << i);
+			return errorstatus;
+		}
+		i += len;
+	}
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Sets up DMA channel and interrupt used by MPU6050_Read_DMA
+ * Must be called once after I2C is initialized.
+ */
+void MPU6050_DMA_Config(void){
+
+	DMA_InitTypeDef DMA_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+	/* Peripheral to memory, byte wide, memory address and length are set per transfer */
+	DMA_DeInit(MPU6050_DMA_CHANNEL);
+	DMA_StructInit(&DMA_InitStructure);
+	DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&MPU6050_I2C->RXDR;
+	DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+	DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+	DMA_Init(MPU6050_DMA_CHANNEL, &DMA_InitStructure);
+
+	DMA_ITConfig(MPU6050_DMA_CHANNEL, DMA_IT_TC | DMA_IT_TE, ENABLE);
+
+	NVIC_InitStructure.NVIC_IRQChannel = MPU6050_DMA_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+}
+
+/* @brief Reads bytes from MPU6050 using DMA
+ * Register address is written in blocking mode, then the function returns and
+ * DMA moves the received bytes to pBuffer. Completion is reported through
+ * callback (called from interrupt context) and MPU6050_DMA_Busy()/MPU6050_DMA_Status().
+ *
+ * @param dev - device handle, must be on MPU6050_I2C
+ * @param RegAddr - register address
+ * @param pBuffer - buffer to write to, must stay valid until transfer completes
+ * @param NumByteToRead - number of bytes to read, 1..255
+ * @param callback - function called on completion, can be 0
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Read_DMA(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint16_t NumByteToRead, MPU6050_Callback callback)
+{
+
+	uint8_t SlaveAddr = dev->address << 1;
+
+	if(dev->bus->I2Cx != MPU6050_I2C) return MPU6050_CONFIG_ERROR;
+	if(MPU6050_DMA_Running) return MPU6050_I2C_ERROR;
+
+	/* Test if SDA line busy */
+	if(MPU6050_Wait_Flag(MPU6050_I2C, I2C_FLAG_BUSY, RESET) != 0){
+		MPU6050_Bus_Recover(dev);
+		return MPU6050_I2C_ERROR;
+	}
+
+	/* STOP of the previous DMA transfer is not waited for in interrupt */
+	I2C_ClearFlag(MPU6050_I2C, I2C_FLAG_STOPF);
+
+	I2C_TransferHandling(MPU6050_I2C, SlaveAddr, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+
+	if(MPU6050_Wait_Flag(MPU6050_I2C, I2C_FLAG_TXIS, SET) != 0){
+		MPU6050_Bus_Recover(dev);
+		return MPU6050_I2C_ERROR;
+	}
+
+	I2C_SendData(MPU6050_I2C, (uint8_t)RegAddr);
+
+	if(MPU6050_Wait_Flag(MPU6050_I2C, I2C_FLAG_TC, SET) != 0){
+		MPU6050_Bus_Recover(dev);
+		return MPU6050_I2C_TX_ERROR;
+	}
+
+	MPU6050_DMA_Callback = callback;
+	MPU6050_DMA_Result = MPU6050_NO_ERROR;
+	MPU6050_DMA_Running = 1;
+
+	/* Channel must be disabled while memory address and length are changed */
+	DMA_Cmd(MPU6050_DMA_CHANNEL, DISABLE);
+	DMA_ClearFlag(MPU6050_DMA_FLAG_GL);
+	MPU6050_DMA_CHANNEL->CMAR = (uint32_t)pBuffer;
+	DMA_SetCurrDataCounter(MPU6050_DMA_CHANNEL, NumByteToRead);
+	DMA_Cmd(MPU6050_DMA_CHANNEL, ENABLE);
+
+	I2C_DMACmd(MPU6050_I2C, I2C_DMAReq_Rx, ENABLE);
+	I2C_TransferHandling(MPU6050_I2C, SlaveAddr, NumByteToRead, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Check if DMA read is still in progress
+ * @retval 1 if transfer is in progress, 0 otherwise
+ */
+uint8_t MPU6050_DMA_Busy(void){
+
+	return MPU6050_DMA_Running;
+}
+
+/* @brief Get result of the last DMA read
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_DMA_Status(void){
+
+	return MPU6050_DMA_Result;
+}
+
+/* @brief DMA1 channel 7 (I2C1_RX) interrupt handler
+ * Ends the DMA read on transfer complete or transfer error.
+ */
+void DMA1_Channel7_IRQHandler(void){
+
+	if(DMA_GetITStatus(DMA1_IT_TE7) != RESET){
+		MPU6050_DMA_Result = MPU6050_I2C_RX_ERROR;
+	}
+	else if(DMA_GetITStatus(DMA1_IT_TC7) != RESET){
+		MPU6050_DMA_Result = MPU6050_NO_ERROR;
+	}
+	else return;
+
+	DMA_ClearITPendingBit(DMA1_IT_GL7);
+	DMA_Cmd(MPU6050_DMA_CHANNEL, DISABLE);
+	I2C_DMACmd(MPU6050_I2C, I2C_DMAReq_Rx, DISABLE);
+
+	MPU6050_DMA_Running = 0;
+
+	if(MPU6050_DMA_Callback != 0){
+		MPU6050_DMA_Callback(MPU6050_DMA_Result);
+	}
+}
+
+/* @brief Enables I2C event and error interrupts used by the asynchronous engine
+ * Must be called once after I2C is initialized. Blocking MPU6050_Read/MPU6050_Write
+ * must not be used while MPU6050_Async_Pending() is not 0.
+ */
+void MPU6050_Async_Config(void){
+
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	NVIC_InitStructure.NVIC_IRQChannel = I2C1_EV_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	NVIC_InitStructure.NVIC_IRQChannel = I2C1_ER_IRQn;
+	NVIC_Init(&NVIC_InitStructure);
+}
+
+/* @brief Adds a request to the queue and starts it if the bus is idle */
+static MPU6050_errorstatus MPU6050_Async_Queue(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint8_t NumBytes, MPU6050_Direction direction, MPU6050_Callback callback){
+
+	MPU6050_Request* req;
+	uint32_t primask;
+
+	if(dev->bus->I2Cx != MPU6050_I2C) return MPU6050_CONFIG_ERROR;
+	if(NumBytes == 0 || NumBytes > MPU6050_ASYNC_MAX_BYTES) return MPU6050_I2C_ERROR;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(MPU6050_Queue_Count == MPU6050_QUEUE_SIZE){
+		__set_PRIMASK(primask);
+		return MPU6050_QUEUE_FULL;
+	}
+
+	req = &MPU6050_Queue[(MPU6050_Queue_Head + MPU6050_Queue_Count) % MPU6050_QUEUE_SIZE];
+	req->dev = dev;
+	req->SlaveAddr = dev->address << 1;
+	req->RegAddr = RegAddr;
+	req->pBuffer = pBuffer;
+	req->NumBytes = NumBytes;
+	req->direction = direction;
+	req->callback = callback;
+
+	/* A request queued from a callback finds the bus idle and starts here */
+	MPU6050_Queue_Count++;
+	if(!MPU6050_Async_Busy) MPU6050_Async_Start();
+
+	__set_PRIMASK(primask);
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Queues a read from MPU6050 and returns immediately
+ *
+ * @param dev - device handle, must be on MPU6050_I2C
+ * @param RegAddr - register address
+ * @param pBuffer - buffer to write to, must stay valid until callback is called
+ * @param NumByteToRead - number of bytes to read
+ * @param callback - function called from interrupt when read is done, can be 0
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Read_Async(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint8_t NumByteToRead, MPU6050_Callback callback){
+
+	return MPU6050_Async_Queue(dev, RegAddr, pBuffer, NumByteToRead, MPU6050_ASYNC_READ, callback);
+}
+
+/* @brief Queues a write to MPU6050 and returns immediately
+ * Bytes are written to consecutive registers starting at RegAddr.
+ *
+ * @param dev - device handle, must be on MPU6050_I2C
+ * @param RegAddr - register address
+ * @param pBuffer - buffer to write from, must stay valid until callback is called
+ * @param NumByteToWrite - number of bytes to write
+ * @param callback - function called from interrupt when write is done, can be 0
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Write_Async(MPU6050_Device* dev, uint8_t RegAddr, uint8_t* pBuffer, uint8_t NumByteToWrite, MPU6050_Callback callback){
+
+	return MPU6050_Async_Queue(dev, RegAddr, pBuffer, NumByteToWrite, MPU6050_ASYNC_WRITE, callback);
+}
+
+/* @brief Get number of queued requests, including the one in progress
+ * Also checks the deadline of the request in progress, so polling this
+ * function until it returns 0 cannot hang on a stuck bus.
+ *
+ * @retval number of requests
+ */
+uint8_t MPU6050_Async_Pending(void){
+
+	MPU6050_Async_Deadline();
+	return MPU6050_Queue_Count;
+}
+
+/* @brief Aborts the head request if it did not complete within MPU6050_TIMEOUT_US
+ * A transfer that lost its interrupts, e.g. with the slave holding SCL or SDA,
+ * would otherwise stay at the head of the queue forever. The bus is recovered
+ * and the request completes with MPU6050_I2C_ERROR.
+ */
+static void MPU6050_Async_Deadline(void){
+
+	uint32_t primask;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(!MPU6050_Async_Busy || MPU6050_Elapsed_Us(MPU6050_Async_Started) <= MPU6050_TIMEOUT_US){
+		__set_PRIMASK(primask);
+		return;
+	}
+
+	/* Busy stays set so no request starts during recovery */
+	I2C_ITConfig(MPU6050_I2C, I2C_IT_TXI | I2C_IT_RXI | I2C_IT_TCI | I2C_IT_STOPI | I2C_IT_NACKI | I2C_IT_ERRI, DISABLE);
+	MPU6050_Bus_Recover(MPU6050_Queue[MPU6050_Queue_Head].dev);
+
+	MPU6050_Async_Result = MPU6050_I2C_ERROR;
+	MPU6050_Async_Finish();
+
+	__set_PRIMASK(primask);
+}
+
+/* @brief Starts the request at the head of the queue
+ * Read sends the register address in software end mode and restarts as read
+ * on TC. Write sends register address and data in one auto end transfer.
+ */
+static void MPU6050_Async_Start(void){
+
+	MPU6050_Request* req = &MPU6050_Queue[MPU6050_Queue_Head];
+
+	MPU6050_Async_Busy = 1;
+	MPU6050_Async_Started = DWT->CYCCNT;
+	MPU6050_Async_Phase = MPU6050_PHASE_REG;
+	MPU6050_Async_Index = 0;
+	MPU6050_Async_Result = MPU6050_NO_ERROR;
+
+	I2C_ClearFlag(MPU6050_I2C, I2C_FLAG_STOPF | I2C_FLAG_NACKF);
+	I2C_ITConfig(MPU6050_I2C, I2C_IT_TXI | I2C_IT_RXI | I2C_IT_TCI | I2C_IT_STOPI | I2C_IT_NACKI | I2C_IT_ERRI, ENABLE);
+
+	if(req->direction == MPU6050_ASYNC_READ){
+		I2C_TransferHandling(MPU6050_I2C, req->SlaveAddr, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+	}
+	else{
+		I2C_TransferHandling(MPU6050_I2C, req->SlaveAddr, req->NumBytes + 1, I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
+	}
+}
+
+/* @brief Completes the head request and starts the next one
+ * Bus is marked idle before the callback, a request the callback queues is
+ * started by MPU6050_Async_Queue and must not be started a second time here.
+ */
+static void MPU6050_Async_Finish(void){
+
+	MPU6050_Request* req = &MPU6050_Queue[MPU6050_Queue_Head];
+	MPU6050_Callback callback = req->callback;
+
+	I2C_ITConfig(MPU6050_I2C, I2C_IT_TXI | I2C_IT_RXI | I2C_IT_TCI | I2C_IT_STOPI | I2C_IT_NACKI | I2C_IT_ERRI, DISABLE);
+
+	MPU6050_Queue_Head = (MPU6050_Queue_Head + 1) % MPU6050_QUEUE_SIZE;
+	MPU6050_Queue_Count--;
+	MPU6050_Async_Busy = 0;
+
+	if(callback != 0){
+		callback(MPU6050_Async_Result);
+	}
+
+	if(!MPU6050_Async_Busy && MPU6050_Queue_Count != 0) MPU6050_Async_Start();
+}
+
+/* @brief I2C1 event interrupt handler, drives the asynchronous engine */
+void I2C1_EV_IRQHandler(void){
+
+	MPU6050_Request* req = &MPU6050_Queue[MPU6050_Queue_Head];
+
+	if(!MPU6050_Async_Busy) return;
+
+	if(I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_NACKF) != RESET){
+		I2C_ClearFlag(MPU6050_I2C, I2C_FLAG_NACKF);
+		MPU6050_Async_Result = MPU6050_I2C_NACK;
+
+		/* STOP is generated by hardware only in auto end mode */
+		if(req->direction == MPU6050_ASYNC_READ && MPU6050_Async_Phase == MPU6050_PHASE_REG){
+			I2C_GenerateSTOP(MPU6050_I2C, ENABLE);
+		}
+	}
+	else if(I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_TXIS) != RESET){
+		if(MPU6050_Async_Phase == MPU6050_PHASE_REG){
+			I2C_SendData(MPU6050_I2C, req->RegAddr);
+			if(req->direction == MPU6050_ASYNC_WRITE) MPU6050_Async_Phase = MPU6050_PHASE_DATA;
+		}
+		else{
+			I2C_SendData(MPU6050_I2C, req->pBuffer[MPU6050_Async_Index++]);
+		}
+	}
+	else if(I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_TC) != RESET){
+		/* Register address of a read was sent, restart as read */
+		MPU6050_Async_Phase = MPU6050_PHASE_DATA;
+		I2C_TransferHandling(MPU6050_I2C, req->SlaveAddr, req->NumBytes, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+	}
+	else if(I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_RXNE) != RESET){
+		req->pBuffer[MPU6050_Async_Index++] = I2C_ReceiveData(MPU6050_I2C);
+	}
+
+	if(I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_STOPF) != RESET){
+		I2C_ClearFlag(MPU6050_I2C, I2C_FLAG_STOPF);
+		MPU6050_Async_Finish();
+	}
+}
+
+/* @brief I2C1 error interrupt handler
+ * Bus error, arbitration loss and overrun abort the head request. The peripheral
+ * is reset because a STOP condition is not guaranteed after these errors.
+ */
+void I2C1_ER_IRQHandler(void){
+
+	if(I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_BERR) == RESET &&
+	   I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_ARLO) == RESET &&
+	   I2C_GetFlagStatus(MPU6050_I2C, I2C_FLAG_OVR) == RESET) return;
+
+	I2C_ClearFlag(MPU6050_I2C, I2C_FLAG_BERR | I2C_FLAG_ARLO | I2C_FLAG_OVR);
+	I2C_SoftwareResetCmd(MPU6050_I2C);
+
+	if(!MPU6050_Async_Busy) return;
+
+	MPU6050_Async_Result = MPU6050_I2C_ERROR;
+	MPU6050_Async_Finish();
+}
+
+/* @brief Sets up data ready interrupt acquisition
+ * MPU6050 INT pin pulses high on every new sample, the rising edge on
+ * MPU6050_INT_PIN starts exactly one asynchronous burst read of the sample,
+ * including the EXT_SENS_DATA bytes of auxiliary slaves.
+ * MPU6050_Async_Config must be called before this function. Only one device
+ * can use data ready acquisition. A device on SPI is read directly in the
+ * EXTI interrupt, other transfers on that SPI bus must not run meanwhile.
+ *
+ * @param dev - device handle, must be on MPU6050_I2C or on SPI
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_DRDY_Config(MPU6050_Device* dev){
+
+	MPU6050_errorstatus errorstatus;
+	GPIO_InitTypeDef GPIO_InitStructure;
+	EXTI_InitTypeDef EXTI_InitStructure;
+	NVIC_InitTypeDef NVIC_InitStructure;
+
+	if(dev->bus->interface == MPU6050_INTERFACE_I2C && dev->bus->I2Cx != MPU6050_I2C) return MPU6050_I2C_ERROR;
+
+	/* Active high push-pull pulse, status cleared by the sample read */
+	errorstatus = MPU6050_Write_Reg(dev, INT_PIN_CFG, MPU6050_INTCFG_INT_RD_CLEAR);
+	if(errorstatus != 0) return errorstatus;
+
+	RCC_AHBPeriphClockCmd(MPU6050_INT_CLK, ENABLE);
+	RCC_APB2PeriphClockCmd(RCC_APB2Periph_SYSCFG, ENABLE);
+
+	GPIO_InitStructure.GPIO_Pin = MPU6050_INT_PIN;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+	GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+	GPIO_InitStructure.GPIO_PuPd  = GPIO_PuPd_DOWN;
+	GPIO_Init(MPU6050_INT_PORT, &GPIO_InitStructure);
+
+	SYSCFG_EXTILineConfig(MPU6050_INT_PORT_SOURCE, MPU6050_INT_PIN_SOURCE);
+
+	EXTI_InitStructure.EXTI_Line = MPU6050_INT_EXTI_LINE;
+	EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+	EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+	EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+	EXTI_Init(&EXTI_InitStructure);
+
+	NVIC_InitStructure.NVIC_IRQChannel = MPU6050_INT_IRQn;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	MPU6050_DRDY_Device = dev;
+	MPU6050_DRDY_Reading = 0;
+	MPU6050_DRDY_New = 0;
+	MPU6050_DRDY_Missed_Count = 0;
+
+	return MPU6050_Modify_Reg(dev, INT_ENABLE, MPU6050_INT_DATA_RDY, MPU6050_INT_DATA_RDY);
+}
+
+/* @brief Get the newest sample read on data ready
+ * Every sample is returned only once.
+ *
+ * @param data - structure to store the sample to
+ *
+ * @retval 1 if a new sample was stored to data, 0 otherwise
+ */
+uint8_t MPU6050_DRDY_Get_Sample(MPU6050_rawData* data){
+
+	return MPU6050_DRDY_Get_Sample_Aux(data, 0);
+}
+
+/* @brief Get the newest sample read on data ready with its auxiliary slave data
+ * Every sample is returned only once.
+ *
+ * @param data - structure to store the sample to
+ * @param aux - buffer of device auxLen bytes for EXT_SENS_DATA, can be 0
+ *
+ * @retval 1 if a new sample was stored to data, 0 otherwise
+ */
+uint8_t MPU6050_DRDY_Get_Sample_Aux(MPU6050_rawData* data, uint8_t* aux){
+
+	uint32_t primask;
+
+	if(!MPU6050_DRDY_New) return 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	*data = MPU6050_DRDY_Sample;
+	if(aux != 0) memcpy(aux, MPU6050_DRDY_Aux, MPU6050_DRDY_Device->auxLen);
+	MPU6050_DRDY_New = 0;
+	__set_PRIMASK(primask);
+
+	return 1;
+}
+
+/* @brief Get number of data ready edges that did not produce a sample
+ * An edge is missed if the previous read was still on the bus or could not be queued.
+ *
+ * @retval number of missed samples
+ */
+uint32_t MPU6050_DRDY_Missed(void){
+
+	return MPU6050_DRDY_Missed_Count;
+}
+
+/* @brief Append the newest sample read on data ready to a sample block
+ * Timestamp is the time of the data ready edge. Every sample is returned only once.
+ *
+ * @param block - block to append to
+ *
+ * @retval 1 if a new sample was appended, 0 if there was none or the block is full
+ */
+uint8_t MPU6050_DRDY_Get_Block(MPU6050_Block* block){
+
+	MPU6050_rawData data;
+	uint32_t timestamp;
+	uint32_t primask;
+
+	if(!MPU6050_DRDY_New || block->count >= MPU6050_BLOCK_SIZE) return 0;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+	data = MPU6050_DRDY_Sample;
+	timestamp = MPU6050_DRDY_Time;
+	MPU6050_DRDY_New = 0;
+	__set_PRIMASK(primask);
+
+	return MPU6050_Block_Append(block, &data, timestamp);
+}
+
+/* @brief Decodes the sample read on data ready, called from I2C interrupt */
+static void MPU6050_DRDY_Read_Done(MPU6050_errorstatus status){
+
+	MPU6050_DRDY_Reading = 0;
+
+	if(status != MPU6050_NO_ERROR){
+		MPU6050_DRDY_Missed_Count++;
+		return;
+	}
+
+	MPU6050_Decode_Sample(MPU6050_DRDY_Buffer, &MPU6050_DRDY_Sample);
+	MPU6050_DRDY_Time = MPU6050_DRDY_Edge;
+	memcpy(MPU6050_DRDY_Aux, &MPU6050_DRDY_Buffer[MPU6050_SAMPLE_LENGTH], MPU6050_DRDY_Device->auxLen);
+	MPU6050_Boot_Sample(MPU6050_DRDY_Device);
+	if(MPU6050_Motion_Waking){
+		MPU6050_DRDY_Device->stats.wakeLatencyUs = MPU6050_Elapsed_Us(MPU6050_Motion_Edge);
+		MPU6050_Motion_Waking = 0;
+	}
+	MPU6050_DRDY_New = 1;
+}
+
+/* @brief EXTI line 1 interrupt handler, MPU6050 data ready */
+void EXTI1_IRQHandler(void){
+
+	if(EXTI_GetITStatus(MPU6050_INT_EXTI_LINE) == RESET) return;
+	EXTI_ClearITPendingBit(MPU6050_INT_EXTI_LINE);
+
+	if(MPU6050_DRDY_Device == 0) return;
+
+	/* INT carries the motion interrupt while the sensor is in cycle mode */
+	if(MPU6050_Motion_State != MPU6050_MOTION_IDLE){
+		if(MPU6050_Motion_State == MPU6050_MOTION_ARMED){
+			MPU6050_Motion_Edge = DWT->CYCCNT;
+			MPU6050_Motion_State = MPU6050_MOTION_WOKEN;
+		}
+		return;
+	}
+
+	/* Previous sample is still being read, the new one is dropped, unless
+	 * the read is past its deadline and gets aborted now */
+	MPU6050_Async_Deadline();
+	if(MPU6050_DRDY_Reading){
+		MPU6050_DRDY_Missed_Count++;
+		return;
+	}
+
+	MPU6050_DRDY_Reading = 1;
+	MPU6050_DRDY_Edge = MPU6050_Time_Us();
+
+	/* SPI burst takes a few microseconds and is done right here */
+	if(MPU6050_DRDY_Device->bus->interface == MPU6050_INTERFACE_SPI){
+		MPU6050_DRDY_Read_Done(MPU6050_Read(MPU6050_DRDY_Device, ACCEL_XOUT_H, MPU6050_DRDY_Buffer, MPU6050_SAMPLE_LENGTH + MPU6050_DRDY_Device->auxLen));
+		return;
+	}
+
+	if(MPU6050_Read_Async(MPU6050_DRDY_Device, ACCEL_XOUT_H, MPU6050_DRDY_Buffer, MPU6050_SAMPLE_LENGTH + MPU6050_DRDY_Device->auxLen, MPU6050_DRDY_Read_Done) != MPU6050_NO_ERROR){
+		MPU6050_DRDY_Reading = 0;
+		MPU6050_DRDY_Missed_Count++;
+	}
+}
+
+/* @brief Puts the sensor into accelerometer-only cycle mode with a motion interrupt
+ * Gyroscopes are put to standby and the accelerometer wakes at the given rate
+ * to compare its high-pass filtered output to the threshold. Data ready
+ * interrupt is disabled, the INT pin pulses on motion instead.
+ * MPU6050_DRDY_Config must have been called for dev. If the sample read in
+ * progress does not complete within MPU6050_TIMEOUT_US, nothing is changed
+ * and streaming goes on. If a write fails, MPU6050_Motion_Exit restores
+ * streaming.
+ *
+ * @param dev - device handle, the data ready device
+ * @param thresholdMg - motion threshold in mg, 2..510
+ * @param rate - accelerometer wake-up rate, check @wake_rate
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Motion_Enter(MPU6050_Device* dev, uint16_t thresholdMg, MPU6050_Wake_Rate rate){
+
+	MPU6050_errorstatus errorstatus;
+	uint32_t start;
+	uint16_t thr;
+
+	if(dev != MPU6050_DRDY_Device || MPU6050_Motion_State != MPU6050_MOTION_IDLE) return MPU6050_CONFIG_ERROR;
+
+	thr = thresholdMg / MPU6050_MOT_THR_MG;
+	if(thr == 0) thr = 1;
+	if(thr > 0xFF) thr = 0xFF;
+
+	/* Stop sample reads and let the one on the bus finish, a stuck one is
+	 * aborted by the deadline of the asynchronous engine */
+	MPU6050_Motion_State = MPU6050_MOTION_CHANGING;
+	start = DWT->CYCCNT;
+	while(MPU6050_DRDY_Reading){
+		if(MPU6050_Elapsed_Us(start) > MPU6050_TIMEOUT_US){
+			MPU6050_Motion_State = MPU6050_MOTION_IDLE;
+			return MPU6050_I2C_ERROR;
+		}
+		MPU6050_Async_Pending();
+	}
+
+	/* Configuration restored by MPU6050_Motion_Exit */
+	errorstatus = MPU6050_Read_Reg(dev, ACCEL_CONFIG, &MPU6050_Motion_Saved[0]);
+	if(errorstatus == 0) errorstatus = MPU6050_Read_Reg(dev, INT_ENABLE, &MPU6050_Motion_Saved[1]);
+	if(errorstatus == 0) errorstatus = MPU6050_Read_Reg(dev, PWR_MGMT_1, &MPU6050_Motion_Saved[2]);
+	if(errorstatus == 0) errorstatus = MPU6050_Read_Reg(dev, PWR_MGMT_2, &MPU6050_Motion_Saved[3]);
+	if(errorstatus != 0){
+		MPU6050_Motion_State = MPU6050_MOTION_IDLE;
+		return errorstatus;
+	}
+
+	errorstatus = MPU6050_Write_Reg(dev, INT_ENABLE, 0);
+	if(errorstatus != 0) return errorstatus;
+
+	/* High-pass filter is reset, then held at the current acceleration so
+	 * that only changes against this reference count as motion */
+	errorstatus = MPU6050_Modify_Reg(dev, ACCEL_CONFIG, MPU6050_ACCEL_HPF_MASK, MPU6050_ACCEL_HPF_RESET);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Write_Reg(dev, MOT_THR, (uint8_t)thr);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Write_Reg(dev, MOT_DUR, 1);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Write_Reg(dev, MOT_DETECT_CTRL, MPU6050_MOT_DETECT_DEFAULT);
+	if(errorstatus != 0) return errorstatus;
+
+	/* Let the filter settle on at least one 1 kHz accelerometer sample */
+	MPU6050_Delay_Us(1000);
+
+	errorstatus = MPU6050_Modify_Reg(dev, ACCEL_CONFIG, MPU6050_ACCEL_HPF_MASK, MPU6050_ACCEL_HPF_HOLD);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Write_Reg(dev, INT_ENABLE, MPU6050_INT_MOT);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Modify_Reg(dev, PWR_MGMT_2, MPU6050_PWR2_LP_WAKE_MASK | MPU6050_PWR2_STBY_GYRO,
+									 (uint8_t)rate | MPU6050_PWR2_STBY_GYRO);
+	if(errorstatus != 0) return errorstatus;
+
+	/* Gyroscope PLL is off in standby, cycle mode runs from the internal oscillator */
+	errorstatus = MPU6050_Modify_Reg(dev, PWR_MGMT_1,
+									 MPU6050_PWR1_SLEEP | MPU6050_PWR1_CYCLE | MPU6050_PWR1_TEMP_DIS | MPU6050_PWR1_CLKSEL_MASK,
+									 MPU6050_PWR1_CYCLE | MPU6050_PWR1_TEMP_DIS | MPU6050_INTERNAL_OSC);
+	if(errorstatus != 0) return errorstatus;
+
+	MPU6050_Motion_State = MPU6050_MOTION_ARMED;
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Returns the sensor from cycle mode to full-rate 6-axis streaming
+ * Power, filter and interrupt settings saved by MPU6050_Motion_Enter are
+ * written back, data ready interrupt last. First sample after this call
+ * stores the wake latency in dev->stats.
+ *
+ * @param dev - device handle
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Motion_Exit(MPU6050_Device* dev){
+
+	MPU6050_errorstatus errorstatus;
+
+	if(dev != MPU6050_DRDY_Device || MPU6050_Motion_State == MPU6050_MOTION_IDLE) return MPU6050_CONFIG_ERROR;
+
+	/* Wake latency is measured from now if no motion was seen */
+	if(MPU6050_Motion_State != MPU6050_MOTION_WOKEN) MPU6050_Motion_Edge = DWT->CYCCNT;
+	MPU6050_Motion_State = MPU6050_MOTION_CHANGING;
+
+	errorstatus = MPU6050_Write_Reg(dev, PWR_MGMT_1, MPU6050_Motion_Saved[2]);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Write_Reg(dev, PWR_MGMT_2, MPU6050_Motion_Saved[3]);
+	if(errorstatus != 0) return errorstatus;
+
+	errorstatus = MPU6050_Write_Reg(dev, ACCEL_CONFIG, MPU6050_Motion_Saved[0]);
+	if(errorstatus != 0) return errorstatus;
+
+	/* INT edges stay ignored until the motion interrupt is off again, an edge
+	 * seen as data ready now would start a read during this blocking write */
+	errorstatus = MPU6050_Write_Reg(dev, INT_ENABLE, MPU6050_Motion_Saved[1]);
+	if(errorstatus != 0) return errorstatus;
+
+	MPU6050_DRDY_New = 0;
+	MPU6050_Motion_Waking = 1;
+	MPU6050_Motion_State = MPU6050_MOTION_IDLE;
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Parks the device until motion and resumes full-rate streaming
+ * Sensor is put to cycle mode and the MCU sleeps with WFI until the motion
+ * interrupt. Other interrupts wake the MCU briefly and it sleeps again.
+ * Returns after the first full-rate sample arrived, or with
+ * MPU6050_WAKE_TIMEOUT if it did not arrive within MPU6050_WAKE_TIMEOUT_US.
+ * Time parked, time slept and the wake latency are kept in dev->stats.
+ * MPU6050_WOM_TIM is used as microsecond time base while parked.
+ *
+ * @param dev - device handle, the data ready device
+ * @param thresholdMg - motion threshold in mg, 2..510
+ * @param rate - accelerometer wake-up rate, check @wake_rate
+ *
+ * @retval @MPU6050_errorstatus
+ */
+MPU6050_errorstatus MPU6050_Motion_Park(MPU6050_Device* dev, uint16_t thresholdMg, MPU6050_Wake_Rate rate){
+
+	MPU6050_errorstatus errorstatus;
+	TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+	RCC_ClocksTypeDef RCC_Clocks;
+	uint32_t timclk;
+	uint32_t sleepStart;
+	uint32_t start;
+
+	/* Timer clock is PCLK1, doubled if APB1 is divided */
+	RCC_GetClocksFreq(&RCC_Clocks);
+	timclk = RCC_Clocks.PCLK1_Frequency;
+	if(RCC_Clocks.HCLK_Frequency != RCC_Clocks.PCLK1_Frequency) timclk *= 2;
+
+	RCC_APB1PeriphClockCmd(MPU6050_WOM_TIM_CLK, ENABLE);
+	TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+	TIM_TimeBaseStructure.TIM_Prescaler = timclk / 1000000 - 1;
+	TIM_TimeBaseStructure.TIM_Period = 0xFFFFFFFF;
+	TIM_TimeBaseInit(MPU6050_WOM_TIM, &TIM_TimeBaseStructure);
+
+	errorstatus = MPU6050_Motion_Enter(dev, thresholdMg, rate);
+	if(errorstatus != 0) return errorstatus;
+
+	TIM_SetCounter(MPU6050_WOM_TIM, 0);
+	TIM_Cmd(MPU6050_WOM_TIM, ENABLE);
+
+	/* Interrupts are masked around WFI so the motion flag cannot be missed,
+	 * a pending interrupt still ends WFI and is taken after unmasking */
+	while(1){
+		__disable_irq();
+		if(MPU6050_Motion_State == MPU6050_MOTION_WOKEN){
+			__enable_irq();
+			break;
+		}
+		sleepStart = TIM_GetCounter(MPU6050_WOM_TIM);
+		__WFI();
+		dev->stats.sleepUs += TIM_GetCounter(MPU6050_WOM_TIM) - sleepStart;
+		__enable_irq();
+	}
+
+	dev->stats.parkedUs += TIM_GetCounter(MPU6050_WOM_TIM);
+	TIM_Cmd(MPU6050_WOM_TIM, DISABLE);
+
+	errorstatus = MPU6050_Motion_Exit(dev);
+	if(errorstatus != 0) return errorstatus;
+
+	/* Gyroscopes need their start-up time before samples flow again */
+	start = DWT->CYCCNT;
+	while(MPU6050_Motion_Waking){
+		if(MPU6050_Elapsed_Us(start) > MPU6050_WAKE_TIMEOUT_US){
+			MPU6050_Motion_Waking = 0;
+			return MPU6050_WAKE_TIMEOUT;
+		}
+	}
+
+	if(dev->stats.wakeLatencyUs > dev->stats.maxWakeLatencyUs) dev->stats.maxWakeLatencyUs = dev->stats.wakeLatencyUs;
+
+	return MPU6050_NO_ERROR;
+}
+
+/* @brief Get the MCU duty cycle while parked
+ * Share of MPU6050_Motion_Park time the MCU was awake, from dev->stats.
+ *
+ * @param dev - device handle
+ * @retval awake time in 0.1 % units, 0..1000
+ */
+uint16_t MPU6050_Motion_Duty(MPU6050_Device* dev){
+
+	if(dev->stats.parkedUs == 0) return 0;
+
+	return (uint16_t)((uint64_t)(dev->stats.parkedUs - dev->stats.sleepUs) * 1000 / dev->stats.parkedUs);
+}
@@ -0,0 +1,490 @@
+/**
+ * @file mpu6050_calib.c
+ * @brief Sensor calibration applied to raw samples in the integer domain
+ *
+ * Corrections work on raw LSB before scaling, so they cost a few integer
+ * operations per axis and fit both the float and the fixed-point paths.
+ */
+
+#include "mpu6050_calib.h"
+
+#if defined(__ARM_FEATURE_DSP) && !defined(MPU6050_CALIB_NO_SIMD)
+#define MPU6050_CALIB_SIMD
+#endif
+
+/* @brief Saturate to int16 range */
+static int16_t MPU6050_Calib_Sat16(int32_t x){
+
+	if(x > 32767) return 32767;
+	if(x < -32768) return -32768;
+	return (int16_t)x;
+}
+
+/* @brief Absolute value */
+static int32_t MPU6050_Calib_Abs(int32_t x){
+
+	return x < 0 ? -x : x;
+}
+
+/* @brief Prepare gyro bias and accelerometer offset estimation
+ * Sensor has to lie still with one axis vertical while the first samples are
+ * fed to MPU6050_Bias_Update. 1 g is removed from that axis, the others are
+ * expected to read 0. Thresholds follow the current ranges of dev.
+ *
+ * @param bias - estimator state
+ * @param dev - device the samples come from, configured ranges are used
+ * @param samples - number of consecutive stationary samples for the startup estimate
+ * @param gravity - axis pointing up during startup, check @gravity_axis;
+ *                  MPU6050_GRAVITY_AUTO takes it from the startup samples
+ */
+void MPU6050_Bias_Init(MPU6050_Bias* bias, MPU6050_Device* dev, uint16_t samples, MPU6050_Gravity_Axis gravity){
+
+	uint8_t k;
+
+	for(k = 0; k < 3; k++){
+		bias->gyro[k] = 0;
+		bias->accel[k] = 0;
+		bias->gravity[k] = 0;
+	}
+	for(k = 0; k < 6; k++) bias->sum[k] = 0;
+
+	/* 1 g, e.g. 16384 LSB at 2 g range, X_UP..Z_DOWN give axis and sign */
+	bias->oneG = (int16_t)(65536000 / dev->accelMulQ16);
+	bias->gravityAxis = gravity;
+	if(gravity != MPU6050_GRAVITY_AUTO){
+		k = (gravity - 1) / 2;
+		bias->gravity[k] = (gravity & 1) ? bias->oneG : -bias->oneG;
+	}
+	bias->gyroStill = (int16_t)(((int64_t)MPU6050_STILL_GYRO_DPS << 32) / dev->gyroMulQ32);
+	bias->accelStill = (int16_t)(MPU6050_STILL_ACCEL_MG * 65536 / dev->accelMulQ16);
+
+	bias->samples = samples ? samples : 1;
+	bias->count = 0;
+	bias->hasLast = 0;
+	bias->state = MPU6050_BIAS_STARTUP;
+}
+
+/* @brief Put 1 g on the axis with the largest mean reading, with its sign */
+static void MPU6050_Bias_Find_Gravity(MPU6050_Bias* bias){
+
+	uint8_t up = 0;
+	uint8_t k;
+
+	for(k = 1; k < 3; k++){
+		if(MPU6050_Calib_Abs(bias->sum[k]) > MPU6050_Calib_Abs(bias->sum[up])) up = k;
+	}
+	for(k = 0; k < 3; k++) bias->gravity[k] = 0;
+	bias->gravity[up] = (bias->sum[up] < 0) ? -bias->oneG : bias->oneG;
+}
+
+/* @brief Check if a sample is at rest
+ * Accelerometer must not change more than accelStill from the previous sample,
+ * gyro must be within gyroStill of the reference in raw LSB.
+ */
+static uint8_t MPU6050_Bias_Is_Still(const MPU6050_Bias* bias, const MPU6050_rawData* data, const int16_t* gyroRef){
+
+	if(MPU6050_Calib_Abs(data->accelX - bias->last.accelX) > bias->accelStill) return 0;
+	if(MPU6050_Calib_Abs(data->accelY - bias->last.accelY) > bias->accelStill) return 0;
+	if(MPU6050_Calib_Abs(data->accelZ - bias->last.accelZ) > bias->accelStill) return 0;
+	if(MPU6050_Calib_Abs(data->gyroX - gyroRef[0]) > bias->gyroStill) return 0;
+	if(MPU6050_Calib_Abs(data->gyroY - gyroRef[1]) > bias->gyroStill) return 0;
+	if(MPU6050_Calib_Abs(data->gyroZ - gyroRef[2]) > bias->gyroStill) return 0;
+	return 1;
+}
+
+/* @brief Feed one raw sample to the bias estimator
+ * During startup stationary samples are averaged, movement restarts the
+ * average. Afterwards the gyro bias follows slowly whenever the device has
+ * been at rest for MPU6050_STILL_SAMPLES samples.
+ *
+ * @param bias - estimator state
+ * @param data - raw sample, not corrected
+ *
+ * @retval estimator state, check @bias_state
+ */
+MPU6050_Bias_State MPU6050_Bias_Update(MPU6050_Bias* bias, const MPU6050_rawData* data){
+
+	const int32_t round = 1 << (MPU6050_BIAS_TRACK_SHIFT - 1);
+	int16_t ref[3];
+	uint8_t still;
+	uint8_t k;
+
+	if(!bias->hasLast){
+		bias->last = *data;
+		bias->hasLast = 1;
+	}
+
+	if(bias->state == MPU6050_BIAS_STARTUP){
+
+		/* Bias is unknown yet, gyro has to stay close to the previous sample */
+		ref[0] = bias->last.gyroX;
+		ref[1] = bias->last.gyroY;
+		ref[2] = bias->last.gyroZ;
+
+		if(!MPU6050_Bias_Is_Still(bias, data, ref)){
+			for(k = 0; k < 6; k++) bias->sum[k] = 0;
+			bias->count = 0;
+		}
+
+		bias->sum[0] += data->accelX;
+		bias->sum[1] += data->accelY;
+		bias->sum[2] += data->accelZ;
+		bias->sum[3] += data->gyroX;
+		bias->sum[4] += data->gyroY;
+		bias->sum[5] += data->gyroZ;
+		bias->count++;
+		bias->last = *data;
+
+		if(bias->count < bias->samples) return MPU6050_BIAS_STARTUP;
+
+		if(bias->gravityAxis == MPU6050_GRAVITY_AUTO) MPU6050_Bias_Find_Gravity(bias);
+
+		/* Averages with fractional bits, done once */
+		for(k = 0; k < 3; k++){
+			bias->accel[k] = (int32_t)(((int64_t)bias->sum[k] << MPU6050_BIAS_FRAC) / bias->count) -
+							 ((int32_t)bias->gravity[k] << MPU6050_BIAS_FRAC);
+			bias->gyro[k] = (int32_t)(((int64_t)bias->sum[k + 3] << MPU6050_BIAS_FRAC) / bias->count);
+		}
+
+		bias->count = 0;
+		bias->state = MPU6050_BIAS_MOVING;
+		return bias->state;
+	}
+
+	for(k = 0; k < 3; k++) ref[k] = (int16_t)(bias->gyro[k] >> MPU6050_BIAS_FRAC);
+
+	still = MPU6050_Bias_Is_Still(bias, data, ref);
+	bias->last = *data;
+
+	if(!still){
+		bias->count = 0;
+		bias->state = MPU6050_BIAS_MOVING;
+		return bias->state;
+	}
+
+	if(bias->count < MPU6050_STILL_SAMPLES){
+		bias->count++;
+		return bias->state;
+	}
+
+	/* At rest, every gyro reading is bias plus noise. Step is rounded,
+	 * a truncating shift would pull the bias down by half a step */
+	bias->gyro[0] += (((int32_t)data->gyroX << MPU6050_BIAS_FRAC) - bias->gyro[0] + round) >> MPU6050_BIAS_TRACK_SHIFT;
+	bias->gyro[1] += (((int32_t)data->gyroY << MPU6050_BIAS_FRAC) - bias->gyro[1] + round) >> MPU6050_BIAS_TRACK_SHIFT;
+	bias->gyro[2] += (((int32_t)data->gyroZ << MPU6050_BIAS_FRAC) - bias->gyro[2] + round) >> MPU6050_BIAS_TRACK_SHIFT;
+
+	bias->state = MPU6050_BIAS_STILL;
+	return bias->state;
+}
+
+/* @brief Feed all samples of a sample block to the bias estimator
+ * @param bias - estimator state
+ * @param block - raw samples, not corrected
+ * @retval estimator state after the last sample, check @bias_state
+ */
+MPU6050_Bias_State MPU6050_Bias_Update_Block(MPU6050_Bias* bias, const MPU6050_Block* block){
+
+	MPU6050_rawData data;
+	uint16_t i;
+
+	for(i = 0; i < block->count; i++){
+		MPU6050_Block_Get(block, i, &data);
+		MPU6050_Bias_Update(bias, &data);
+	}
+	return bias->state;
+}
+
+/* @brief Subtract gyro bias and accelerometer offset from a raw sample
+ * Does nothing until the startup estimate is done.
+ *
+ * @param bias - estimator state
+ * @param data - raw sample, corrected in place
+ */
+void MPU6050_Bias_Apply(const MPU6050_Bias* bias, MPU6050_rawData* data){
+
+	const int32_t half = 1 << (MPU6050_BIAS_FRAC - 1);
+
+	if(bias->state == MPU6050_BIAS_STARTUP) return;
+
+	data->accelX = MPU6050_Calib_Sat16(data->accelX - ((bias->accel[0] + half) >> MPU6050_BIAS_FRAC));
+	data->accelY = MPU6050_Calib_Sat16(data->accelY - ((bias->accel[1] + half) >> MPU6050_BIAS_FRAC));
+	data->accelZ = MPU6050_Calib_Sat16(data->accelZ - ((bias->accel[2] + half) >> MPU6050_BIAS_FRAC));
+	data->gyroX = MPU6050_Calib_Sat16(data->gyroX - ((bias->gyro[0] + half) >> MPU6050_BIAS_FRAC));
+	data->gyroY = MPU6050_Calib_Sat16(data->gyroY - ((bias->gyro[1] + half) >> MPU6050_BIAS_FRAC));
+	data->gyroZ = MPU6050_Calib_Sat16(data->gyroZ - ((bias->gyro[2] + half) >> MPU6050_BIAS_FRAC));
+}
+
+/* @brief Subtract gyro bias and accelerometer offset from every sample of a block
+ * Offsets are rounded once, each channel array is then corrected in one pass.
+ *
+ * @param bias - estimator state
+ * @param block - raw samples, corrected in place
+ */
+void MPU6050_Bias_Apply_Block(const MPU6050_Bias* bias, MPU6050_Block* block){
+
+	const int32_t half = 1 << (MPU6050_BIAS_FRAC - 1);
+	int16_t* channel[6];
+	int32_t offset[6];
+	uint16_t i;
+	uint8_t k;
+
+	if(bias->state == MPU6050_BIAS_STARTUP) return;
+
+	channel[0] = block->accelX;
+	channel[1] = block->accelY;
+	channel[2] = block->accelZ;
+	channel[3] = block->gyroX;
+	channel[4] = block->gyroY;
+	channel[5] = block->gyroZ;
+
+	for(k = 0; k < 3; k++){
+		offset[k] = (bias->accel[k] + half) >> MPU6050_BIAS_FRAC;
+		offset[k + 3] = (bias->gyro[k] + half) >> MPU6050_BIAS_FRAC;
+	}
+
+	for(k = 0; k < 6; k++){
+		for(i = 0; i < block->count; i++){
+			channel[k][i] = MPU6050_Calib_Sat16(channel[k][i] - offset[k]);
+		}
+	}
+}
+
+/* @brief Fill calibration parameters with zero offsets and identity matrices
+ * @param params - parameters to fill
+ */
+void MPU6050_Calib_Identity(MPU6050_Calib_Params* params){
+
+	uint8_t k;
+
+	params->magic = MPU6050_CALIB_MAGIC;
+	for(k = 0; k < 3; k++){
+		params->accelOffset[k] = 0;
+		params->gyroOffset[k] = 0;
+	}
+	for(k = 0; k < 9; k++){
+		params->accelMatrix[k] = (k % 4 == 0) ? MPU6050_MATRIX_ONE : 0;
+		params->gyroMatrix[k] = (k % 4 == 0) ? MPU6050_MATRIX_ONE : 0;
+	}
+}
+
+/* @brief Pack offset and matrix of one triplet
+ * @retval 0 if every row fits the 32-bit accumulator, 1 otherwise
+ */
+static uint8_t MPU6050_Calib_Triplet_Init(MPU6050_Calib_Triplet* t, const int16_t* offset, const int16_t* matrix){
+
+	int32_t sum;
+	uint8_t r, c;
+
+	/* |d| <= 32768, the sum of |coefficients| of a row below 4.0 keeps
+	 * d * row + round inside int32, SMLAD does not saturate */
+	for(r = 0; r < 3; r++){
+		sum = 0;
+		for(c = 0; c < 3; c++) sum += MPU6050_Calib_Abs(matrix[3 * r + c]);
+		if(sum >= 4 * MPU6050_MATRIX_ONE) return 1;
+	}
+
+	t->offsetXY = (uint16_t)offset[0] | (uint32_t)(uint16_t)offset[1] << 16;
+	t->offsetZ = offset[2];
+	for(r = 0; r < 3; r++){
+		t->rowXY[r] = (uint16_t)matrix[3 * r] | (uint32_t)(uint16_t)matrix[3 * r + 1] << 16;
+		t->rowZ[r] = matrix[3 * r + 2];
+	}
+	return 0;
+}
+
+/* @brief Load misalignment and scale calibration, e.g. from a flash page
+ * @param calib - calibration to fill
+ * @param params - offsets and matrices, check MPU6050_Calib_Params
+ * @retval 0 on success, 1 if magic is wrong or a matrix row is too large,
+ * 		   calib is then left unchanged
+ */
+uint8_t MPU6050_Calib_Init(MPU6050_Calib* calib, const MPU6050_Calib_Params* params){
+
+	MPU6050_Calib tmp;
+
+	if(params->magic != MPU6050_CALIB_MAGIC) return 1;
+	if(MPU6050_Calib_Triplet_Init(&tmp.accel, params->accelOffset, params->accelMatrix)) return 1;
+	if(MPU6050_Calib_Triplet_Init(&tmp.gyro, params->gyroOffset, params->gyroMatrix)) return 1;
+
+	*calib = tmp;
+	return 0;
+}
+
+/* @brief Apply offset and matrix to one triplet, out = sat16((M * sat16(in - offset) + round) >> MPU6050_MATRIX_FRAC)
+ * With the DSP extension each row is one SMLAD for X and Y plus one multiply for Z,
+ * the C path gives the same result.
+ */
+static void MPU6050_Calib_Triplet_Apply(const MPU6050_Calib_Triplet* t, int16_t* x, int16_t* y, int16_t* z){
+
+	const int32_t round = 1 << (MPU6050_MATRIX_FRAC - 1);
+	int32_t dz = MPU6050_Calib_Sat16((int32_t)*z - t->offsetZ);
+	int32_t acc[3];
+	uint8_t r;
+
+#ifdef MPU6050_CALIB_SIMD
+
+	uint32_t dxy = __QSUB16(__PKHBT(*x, *y, 16), t->offsetXY);
+
+	for(r = 0; r < 3; r++){
+		acc[r] = (int32_t)__SMLAD(dxy, t->rowXY[r], dz * t->rowZ[r] + round);
+		acc[r] = __SSAT(acc[r] >> MPU6050_MATRIX_FRAC, 16);
+	}
+
+#else
+
+	int32_t dx = MPU6050_Calib_Sat16((int32_t)*x - (int16_t)(t->offsetXY & 0xFFFF));
+	int32_t dy = MPU6050_Calib_Sat16((int32_t)*y - (int16_t)(t->offsetXY >> 16));
+
+	for(r = 0; r < 3; r++){
+		acc[r] = dx * (int16_t)(t->rowXY[r] & 0xFFFF) + dy * (int16_t)(t->rowXY[r] >> 16) + dz * t->rowZ[r] + round;
+		acc[r] = MPU6050_Calib_Sat16(acc[r] >> MPU6050_MATRIX_FRAC);
+	}
+
+#endif
+
+	*x = (int16_t)acc[0];
+	*y = (int16_t)acc[1];
+	*z = (int16_t)acc[2];
+}
+
+/* @brief Correct misalignment, scale and offset of a raw sample
+ * Temperature is not touched. Apply after MPU6050_Bias_Apply when both are used.
+ * About 25 cycles per triplet with the DSP extension, 60 cycles per sample
+ * including the call, below 0.1% of a 72 MHz core at 1 kHz.
+ *
+ * @param calib - calibration loaded with MPU6050_Calib_Init
+ * @param data - raw sample, corrected in place
+ */
+void MPU6050_Calib_Apply(const MPU6050_Calib* calib, MPU6050_rawData* data){
+
+	MPU6050_Calib_Triplet_Apply(&calib->accel, &data->accelX, &data->accelY, &data->accelZ);
+	MPU6050_Calib_Triplet_Apply(&calib->gyro, &data->gyroX, &data->gyroY, &data->gyroZ);
+}
+
+/* @brief Correct misalignment, scale and offset of every sample of a block
+ * @param calib - calibration loaded with MPU6050_Calib_Init
+ * @param block - raw samples, corrected in place
+ */
+void MPU6050_Calib_Apply_Block(const MPU6050_Calib* calib, MPU6050_Block* block){
+
+	uint16_t i;
+
+	for(i = 0; i < block->count; i++){
+		MPU6050_Calib_Triplet_Apply(&calib->accel, &block->accelX[i], &block->accelY[i], &block->accelZ[i]);
+		MPU6050_Calib_Triplet_Apply(&calib->gyro, &block->gyroX[i], &block->gyroY[i], &block->gyroZ[i]);
+	}
+}
+
+/* @brief Prepare thermal bias compensation
+ * Params have to stay valid while thermal is used, e.g. a const table in flash.
+ * Typical use per sample: MPU6050_Thermal_Apply, then MPU6050_Bias_Update and
+ * MPU6050_Bias_Apply, then MPU6050_Calib_Apply. The online bias tracker then
+ * only sees what the thermal model leaves over.
+ *
+ * @param thermal - compensation state
+ * @param params - polynomial model, check MPU6050_Thermal_Params
+ * @param stepMilliC - temperature change in millidegrees that triggers a new evaluation,
+ * 					   0 for MPU6050_THERMAL_STEP_MC
+ */
+void MPU6050_Thermal_Init(MPU6050_Thermal* thermal, const MPU6050_Thermal_Params* params, uint16_t stepMilliC){
+
+	uint8_t k;
+
+	if(stepMilliC == 0) stepMilliC = MPU6050_THERMAL_STEP_MC;
+
+	thermal->params = params;
+	for(k = 0; k < 6; k++) thermal->offset[k] = 0;
+	thermal->lastTemp = 0;
+	/* 340 LSB per degree */
+	thermal->step = (int16_t)(((uint32_t)stepMilliC * 340 + 500) / 1000);
+	if(thermal->step == 0) thermal->step = 1;
+	thermal->valid = 0;
+}
+
+/* @brief Evaluate the bias model if the temperature moved by more than the step
+ * Polynomial is evaluated with 64-bit Horner steps, which is only done
+ * when the temperature changes, the per-sample cost is one compare.
+ *
+ * @param thermal - compensation state
+ * @param temp - raw temperature, e.g. MPU6050_rawData.temp of the burst read
+ *
+ * @retval 1 if the offsets were updated, 0 otherwise
+ */
+uint8_t MPU6050_Thermal_Update(MPU6050_Thermal* thermal, int16_t temp){
+
+	const MPU6050_Thermal_Params* params = thermal->params;
+	int32_t dT;
+	int64_t acc;
+	uint8_t k;
+	int8_t n;
+
+	if(thermal->valid && MPU6050_Calib_Abs((int32_t)temp - thermal->lastTemp) < thermal->step) return 0;
+
+	/* Degrees from the reference with 8 fractional bits */
+	dT = ((int32_t)temp - params->refTemp) * 256 / 340;
+
+	for(k = 0; k < 6; k++){
+		acc = params->coeff[k][MPU6050_THERMAL_ORDER];
+		for(n = MPU6050_THERMAL_ORDER - 1; n >= 0; n--){
+			acc = ((acc * dT) >> 8) + params->coeff[k][n];
+		}
+		acc = (acc + 32768) >> 16;
+		if(acc > 32767) acc = 32767;
+		if(acc < -32768) acc = -32768;
+		thermal->offset[k] = (int16_t)acc;
+	}
+
+	thermal->lastTemp = temp;
+	thermal->valid = 1;
+	return 1;
+}
+
+/* @brief Subtract the temperature dependent bias from a raw sample
+ * Offsets follow data->temp, so the sample has to come from a full burst
+ * read, e.g. MPU6050_Get_All_Data_Raw or the FIFO with temperature enabled.
+ *
+ * @param thermal - compensation state
+ * @param data - raw sample, corrected in place
+ */
+void MPU6050_Thermal_Apply(MPU6050_Thermal* thermal, MPU6050_rawData* data){
+
+	MPU6050_Thermal_Update(thermal, data->temp);
+
+	data->accelX = MPU6050_Calib_Sat16((int32_t)data->accelX - thermal->offset[0]);
+	data->accelY = MPU6050_Calib_Sat16((int32_t)data->accelY - thermal->offset[1]);
+	data->accelZ = MPU6050_Calib_Sat16((int32_t)data->accelZ - thermal->offset[2]);
+	data->gyroX = MPU6050_Calib_Sat16((int32_t)data->gyroX - thermal->offset[3]);
+	data->gyroY = MPU6050_Calib_Sat16((int32_t)data->gyroY - thermal->offset[4]);
+	data->gyroZ = MPU6050_Calib_Sat16((int32_t)data->gyroZ - thermal->offset[5]);
+}
+
+/* @brief Subtract the temperature dependent bias from every sample of a block
+ * Temperature barely moves within a block, the model is checked against the
+ * first sample only.
+ *
+ * @param thermal - compensation state
+ * @param block - raw samples with temperature, corrected in place
+ */
+void MPU6050_Thermal_Apply_Block(MPU6050_Thermal* thermal, MPU6050_Block* block){
+
+	int16_t* channel[6];
+	uint16_t i;
+	uint8_t k;
+
+	if(block->count == 0) return;
+
+	MPU6050_Thermal_Update(thermal, block->temp[0]);
+
+	channel[0] = block->accelX;
+	channel[1] = block->accelY;
+	channel[2] = block->accelZ;
+	channel[3] = block->gyroX;
+	channel[4] = block->gyroY;
+	channel[5] = block->gyroZ;
+
+	for(k = 0; k < 6; k++){
+		for(i = 0; i < block->count; i++){
+			channel[k][i] = MPU6050_Calib_Sat16((int32_t)channel[k][i] - thermal->offset[k]);
+		}
+	}
+}
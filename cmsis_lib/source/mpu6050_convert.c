@@ -0,0 +1,179 @@
+/**
+ * @file mpu6050_convert.c
+ * @brief Batch conversion of raw sensor triplets, e.g. a FIFO drain
+ *
+ * MPU6050_Convert_Batch works on interleaved X, Y, Z int16 triplets, e.g. the
+ * gyro words of a FIFO frame copied to a 4-byte aligned buffer. MPU6050_rawData
+ * arrays are not triplets (temperature sits between accel and gyro) and have
+ * to be repacked. MPU6050_Convert_Channel works on one channel array, e.g.
+ * MPU6050_Block.gyroX, in place.
+ *
+ * On a core with the DSP extension (Cortex-M4) two lanes are processed per
+ * instruction with the CMSIS SIMD intrinsics, everywhere else the plain C
+ * reference is used. Both give bit-identical results, the reference builds on
+ * a host compiler:
+ *	gcc -c cmsis_lib/source/mpu6050_convert.c -Icmsis_lib/include
+ */
+
+#include "mpu6050_convert.h"
+
+#if defined(__ARM_FEATURE_DSP) && !defined(MPU6050_CONVERT_NO_SIMD)
+#include "stm32f30x.h"
+#define MPU6050_CONVERT_SIMD
+#endif
+
+/* @brief Saturate to int16 range */
+static int32_t MPU6050_Sat16(int32_t x){
+
+	if(x > 32767) return 32767;
+	if(x < -32768) return -32768;
+	return x;
+}
+
+/* @brief Convert one value the way the SIMD kernel does */
+static int16_t MPU6050_Convert_One(int16_t raw, int16_t offset, int16_t scale, uint8_t shift){
+
+	/* Offset subtraction saturates like QSUB16 */
+	int32_t d = MPU6050_Sat16((int32_t)raw - offset);
+
+	return (int16_t)MPU6050_Sat16((d * scale + (1 << (shift - 1))) >> shift);
+}
+
+/* @brief Convert raw triplets to scaled fixed point, plain C reference
+ * @param params - offset, scale and shift of the three axes
+ * @param raw - count interleaved X, Y, Z raw triplets
+ * @param out - count interleaved X, Y, Z converted triplets, can be the same buffer as raw
+ * @param count - number of triplets
+ */
+void MPU6050_Convert_Batch_Ref(const MPU6050_Convert_Params* params, const int16_t* raw, int16_t* out, uint16_t count){
+
+	uint32_t i;
+
+	for(i = 0; i < (uint32_t)count * 3; i++){
+		out[i] = MPU6050_Convert_One(raw[i], params->offset[i % 3], params->scale[i % 3], params->shift);
+	}
+}
+
+/* @brief Convert raw triplets to scaled fixed point
+ * Same result as MPU6050_Convert_Batch_Ref. The SIMD kernel loads two triplets
+ * as three 32-bit words, raw and out must be 4-byte aligned.
+ *
+ * @param params - offset, scale and shift of the three axes
+ * @param raw - count interleaved X, Y, Z raw triplets
+ * @param out - count interleaved X, Y, Z converted triplets, can be the same buffer as raw
+ * @param count - number of triplets
+ */
+void MPU6050_Convert_Batch(const MPU6050_Convert_Params* params, const int16_t* raw, int16_t* out, uint16_t count){
+
+#ifdef MPU6050_CONVERT_SIMD
+
+	const uint32_t* in32 = (const uint32_t*)raw;
+	uint32_t* out32 = (uint32_t*)out;
+	uint32_t off[3], sLo[3], sHi[3];
+	uint32_t d;
+	int32_t lo, hi;
+	int32_t round = 1 << (params->shift - 1);
+	uint8_t shift = params->shift;
+	uint16_t pairs = count / 2;
+	uint8_t k;
+
+	/* Two triplets are the words (X0,Y0) (Z0,X1) (Y1,Z1), lane k of word w is axis (2w + k) % 3.
+	 * Multiplier of the low lane sits in the low half of sLo, of the high lane in the low half
+	 * of sHi, so SMLAD and SMLADX each produce one lane product. */
+	for(k = 0; k < 3; k++){
+		off[k] = __PKHBT(params->offset[(2 * k) % 3], params->offset[(2 * k + 1) % 3], 16);
+		sLo[k] = (uint16_t)params->scale[(2 * k) % 3];
+		sHi[k] = (uint16_t)params->scale[(2 * k + 1) % 3];
+	}
+
+	while(pairs--){
+		for(k = 0; k < 3; k++){
+			d = __QSUB16(*in32++, off[k]);
+			lo = (int32_t)__SMLAD(d, sLo[k], round) >> shift;
+			hi = (int32_t)__SMLADX(d, sHi[k], round) >> shift;
+			*out32++ = __PKHBT(__SSAT(lo, 16), __SSAT(hi, 16), 16);
+		}
+	}
+
+	/* Odd triplet */
+	if(count & 1){
+		raw = (const int16_t*)in32;
+		out = (int16_t*)out32;
+		for(k = 0; k < 3; k++){
+			out[k] = MPU6050_Convert_One(raw[k], params->offset[k], params->scale[k], shift);
+		}
+	}
+
+#else
+	MPU6050_Convert_Batch_Ref(params, raw, out, count);
+#endif
+}
+
+/* @brief Convert one channel of raw samples to scaled fixed point
+ * Same result per value as MPU6050_Convert_Batch_Ref. Arrays of an
+ * MPU6050_Block are 4-byte aligned, other arrays not aligned to 4 bytes use
+ * the plain C loop.
+ *
+ * @param offset - offset in raw LSB
+ * @param scale - multiplier, fixed point with shift fractional bits
+ * @param shift - fractional bits of scale, 1..16
+ * @param raw - count raw values of one channel
+ * @param out - count converted values, can be the same array as raw
+ * @param count - number of values
+ */
+void MPU6050_Convert_Channel(int16_t offset, int16_t scale, uint8_t shift, const int16_t* raw, int16_t* out, uint16_t count){
+
+#ifdef MPU6050_CONVERT_SIMD
+
+	if((((uint32_t)raw | (uint32_t)out) & 3) == 0){
+
+		const uint32_t* in32 = (const uint32_t*)raw;
+		uint32_t* out32 = (uint32_t*)out;
+		uint32_t off = __PKHBT(offset, offset, 16);
+		uint32_t s = (uint16_t)scale;
+		uint32_t d;
+		int32_t lo, hi;
+		int32_t round = 1 << (shift - 1);
+		uint16_t pairs = count / 2;
+
+		/* Multiplier only in the low half, SMLAD gives the low lane product, SMLADX the high one */
+		while(pairs--){
+			d = __QSUB16(*in32++, off);
+			lo = (int32_t)__SMLAD(d, s, round) >> shift;
+			hi = (int32_t)__SMLADX(d, s, round) >> shift;
+			*out32++ = __PKHBT(__SSAT(lo, 16), __SSAT(hi, 16), 16);
+		}
+
+		raw = (const int16_t*)in32;
+		out = (int16_t*)out32;
+		count &= 1;
+	}
+
+#endif
+
+	while(count--){
+		*out++ = MPU6050_Convert_One(*raw++, offset, scale, shift);
+	}
+}
+
+/* @brief Convert raw triplets to float
+ * Offset is subtracted with saturation as in the fixed-point path.
+ *
+ * @param offset - X, Y, Z offset in raw LSB
+ * @param scale - X, Y, Z multiplier, e.g. 1/MPU6050_GYRO_RANGE_250
+ * @param raw - count interleaved X, Y, Z raw triplets
+ * @param out - count interleaved X, Y, Z converted triplets
+ * @param count - number of triplets
+ */
+void MPU6050_Convert_Batch_Float(const int16_t* offset, const float* scale, const int16_t* raw, float* out, uint16_t count){
+
+	float sx = scale[0], sy = scale[1], sz = scale[2];
+
+	while(count--){
+		out[0] = (float)MPU6050_Sat16((int32_t)raw[0] - offset[0]) * sx;
+		out[1] = (float)MPU6050_Sat16((int32_t)raw[1] - offset[1]) * sy;
+		out[2] = (float)MPU6050_Sat16((int32_t)raw[2] - offset[2]) * sz;
+		raw += 3;
+		out += 3;
+	}
+}
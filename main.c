@@ -31,11 +31,15 @@
 
 #include <stdio.h>
 #include "dboardsetup.h"
-#include "mpu6050.h"
+#include "complementary_filter.h"
 
 int main(void)
 {
 	MPU6050_errorstatus err;
+	MPU6050_Device imu;
+	MPU6050_rawData sample;
+	MPU6050_CF cf;
+	uint8_t booted = 0;
 	float gyro_xdata;
 	float gyro_ydata;
 	float gyro_zdata;
@@ -45,18 +49,44 @@ int main(void)
 	gpio_init();
 	//tim_init(); // Timers are set in the dboardsetup.h for quadcopter
 	uart_init();
-	i2c_init();
+	/* MPU6050 supports up to Fast-mode */
+	if(i2c_init(I2C_SPEED_FAST) != I2C_SPEED_FAST){
+		printf("I2C: no Fast-mode timing for this clock and rise time, bus runs slower\n");
+	}
 	uint8_t str[25];
 
-	err = MPU6050_Initialization();
+	/* Sensor on I2C1 with AD0 pulled low */
+	MPU6050_Device_Init(&imu, &MPU6050_Bus1, MPU6050_ADDRESS);
+	err = MPU6050_Initialization(&imu);
+
+	/* Attitude from every sample, period follows the configured rate */
+	MPU6050_CF_Init(&cf, &imu, MPU6050_CF_TAU_MS, 0);
+
+	/* Sensor is read once per new sample on the data ready interrupt */
+	MPU6050_Async_Config();
+	err = MPU6050_DRDY_Config(&imu);
 
     while(1)
     {
-    	/* Read data from the sensor */
-		err = MPU6050_Get_Gyro_Data(&gyro_xdata, &gyro_ydata, &gyro_zdata);
-		err = MPU6050_Get_Accel_Data(&accel_xdata, &accel_ydata, &accel_zdata);
+    	/* Wait for a new sample from the sensor */
+		if(!MPU6050_DRDY_Get_Sample(&sample)) continue;
+
+		/* Report start-up cost once, after the first sample arrived */
+		if(!booted){
+			printf("init: %lu us, first sample: %lu us\n", imu.stats.initUs, imu.stats.firstSampleUs);
+			booted = 1;
+		}
+
+		MPU6050_CF_Update(&cf, &sample);
+
+		gyro_xdata = sample.gyroX * imu.gyroMul;
+		gyro_ydata = sample.gyroY * imu.gyroMul;
+		gyro_zdata = sample.gyroZ * imu.gyroMul;
+		accel_xdata = sample.accelX * imu.accelMul;
+		accel_ydata = sample.accelY * imu.accelMul;
+		accel_zdata = sample.accelZ * imu.accelMul;
 
 		sprintf(str, "%f", gyro_xdata);
-		printf("gyroX: %s", gyro_xdata);
+		printf("gyroX: %s", str);
     }
 }
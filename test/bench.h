@@ -0,0 +1,97 @@
+/**
+ * @file bench.h
+ * @brief Time base and sample data for the benchmarks
+ *
+ * On the board a benchmark replaces main.c in the mpu6050 (soft-float) or
+ * mpu6050_fpu (hard-float) target, prints over the UART and counts core cycles
+ * with the DWT counter. On a host build it runs against the simulated
+ * peripherals of test/host and counts nanoseconds of the host clock, which
+ * only compare the variants with each other.
+ */
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#if defined(__arm__)
+
+#include "dboardsetup.h"
+
+#define BENCH_UNIT			"cycles"
+#define BENCH_TICKS_PER_S	SystemCoreClock
+
+#if defined(__ARM_PCS_VFP)
+#define BENCH_FLOAT_ABI		"hard-float"
+#else
+#define BENCH_FLOAT_ABI		"soft-float"
+#endif
+
+/* @brief Board, UART for printf, I2C for the sensor and the cycle counter */
+static inline void Bench_Init(void){
+
+	gpio_init();
+	uart_init();
+	i2c_init(I2C_SPEED_FAST);
+	MPU6050_Timebase_Init();
+}
+
+static inline uint32_t Bench_Ticks(void){
+
+	return DWT->CYCCNT;
+}
+
+#else
+
+#include <time.h>
+
+#define BENCH_UNIT			"ns"
+#define BENCH_TICKS_PER_S	1000000000u
+#define BENCH_FLOAT_ABI		"host"
+
+static inline void Bench_Init(void){
+
+	Host_Reset();
+}
+
+static inline uint32_t Bench_Ticks(void){
+
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+#endif
+
+/* Results go here so the measured code is not optimized away */
+static volatile int32_t Bench_Sink;
+
+static uint32_t Bench_Seed = 1;
+
+/* @brief Pseudo random int16, the same sequence on every build */
+static inline int16_t Bench_Random16(void){
+
+	Bench_Seed = Bench_Seed * 1664525 + 1013904223;
+	return (int16_t)(Bench_Seed >> 16);
+}
+
+/* @brief Fill samples with random raw values, the first ones at the ends of the range */
+static inline void Bench_Samples(MPU6050_rawData* samples, uint16_t count){
+
+	int16_t* v = (int16_t*)samples;
+	uint32_t i;
+
+	for(i = 0; i < (uint32_t)count * 7; i++) v[i] = Bench_Random16();
+	if(count >= 2){
+		samples[0].accelX = samples[0].accelY = samples[0].accelZ = 32767;
+		samples[0].gyroX = samples[0].gyroY = samples[0].gyroZ = 32767;
+		samples[0].temp = 32767;
+		samples[1].accelX = samples[1].accelY = samples[1].accelZ = -32768;
+		samples[1].gyroX = samples[1].gyroY = samples[1].gyroZ = -32768;
+		samples[1].temp = -32768;
+	}
+}
+
+#endif /* __BENCH_H */
@@ -0,0 +1,144 @@
+/**
+ * @file bench_float_abi.c
+ * @brief Benchmark, float code on the soft-float and hard-float targets against the integer paths
+ *
+ * Prints the cost per sample of the float and Q16.16 conversions, the float and
+ * Q30 Madgwick updates and the integer complementary filter, labelled with the
+ * float ABI of the build. Running it on the mpu6050 and mpu6050_fpu targets
+ * gives the soft-float, hard-float and fixed-point columns; the integer paths
+ * cost the same on both. Before timing, the float and fixed-point filters must
+ * agree on a tilted sample, so the variants compute the same attitude.
+ *
+ *	gcc -std=gnu99 -O2 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest -Itest/host -include stm32_host.h test/bench_float_abi.c test/host/stm32_host.c \
+ *		cmsis_lib/source/mpu6050.c cmsis_lib/source/mpu6050_ahrs.c cmsis_lib/source/complementary_filter.c \
+ *		-lm -o bench_float_abi && ./bench_float_abi
+ */
+
+#include <math.h>
+#include "mpu6050_ahrs.h"
+#include "complementary_filter.h"
+#include "test.h"
+#include "bench.h"
+
+#define SAMPLES				256
+#define REPEATS				100
+
+static MPU6050_Device Dev;
+static MPU6050_rawData Samples[SAMPLES];
+
+/* Float conversion of one sample as done by the float getters */
+static void Convert_Float(const MPU6050_rawData* raw, float* out){
+
+	out[0] = raw->accelX * Dev.accelMul;
+	out[1] = raw->accelY * Dev.accelMul;
+	out[2] = raw->accelZ * Dev.accelMul;
+	out[3] = raw->gyroX * Dev.gyroMul;
+	out[4] = raw->gyroY * Dev.gyroMul;
+	out[5] = raw->gyroZ * Dev.gyroMul;
+}
+
+/* Float and Q30 filters settle to the same attitude, 30 degrees roll and 20 degrees pitch */
+static void Check_Agreement(void){
+
+	MPU6050_AHRS ahrs;
+	MPU6050_AHRS_Fixed fixed;
+	MPU6050_rawData tilted = {0};
+	double roll = 30 * M_PI / 180, pitch = 20 * M_PI / 180;
+	double dot = 0;
+	float r, p, y;
+	uint16_t i;
+	uint8_t k;
+
+	tilted.accelX = (int16_t)lround(-sin(pitch) / Dev.accelMul);
+	tilted.accelY = (int16_t)lround(cos(pitch) * sin(roll) / Dev.accelMul);
+	tilted.accelZ = (int16_t)lround(cos(pitch) * cos(roll) / Dev.accelMul);
+
+	MPU6050_AHRS_Init(&ahrs, &Dev, 0, 0);
+	MPU6050_AHRS_Fixed_Init(&fixed, &Dev, 0, 0);
+	for(i = 0; i < 5000; i++){
+		MPU6050_AHRS_Update(&ahrs, &tilted);
+		MPU6050_AHRS_Fixed_Update(&fixed, &tilted);
+	}
+
+	MPU6050_AHRS_Get_Euler(&ahrs, &r, &p, &y);
+	CHECK(fabs(r - 30) < 0.1 && fabs(p - 20) < 0.1);
+
+	/* Angle between the two quaternions below 0.1 degrees */
+	for(k = 0; k < 4; k++) dot += ahrs.q[k] * (fixed.q[k] / 1073741824.0);
+	CHECK(2 * acos(fmin(fabs(dot), 1.0)) * 180 / M_PI < 0.1);
+}
+
+static void Measure(void){
+
+	MPU6050_AHRS ahrs;
+	MPU6050_AHRS_Fixed ahrsFixed;
+	MPU6050_CF cf;
+	MPU6050_fixedData fixed;
+	float values[6];
+	uint32_t start, ticks[5];
+	uint16_t r, i;
+
+	MPU6050_AHRS_Init(&ahrs, &Dev, 0, 0);
+	MPU6050_AHRS_Fixed_Init(&ahrsFixed, &Dev, 0, 0);
+	MPU6050_CF_Init(&cf, &Dev, MPU6050_CF_TAU_MS, 0);
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < SAMPLES; i++){
+			Convert_Float(&Samples[i], values);
+			Bench_Sink = (int32_t)(values[0] + values[5]);
+		}
+	}
+	ticks[0] = Bench_Ticks() - start;
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < SAMPLES; i++){
+			MPU6050_Convert_Fixed(&Dev, &Samples[i], &fixed);
+			Bench_Sink = fixed.accelX + fixed.gyroZ;
+		}
+	}
+	ticks[1] = Bench_Ticks() - start;
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < SAMPLES; i++) MPU6050_AHRS_Update(&ahrs, &Samples[i]);
+	}
+	ticks[2] = Bench_Ticks() - start;
+	Bench_Sink = (int32_t)(ahrs.q[0] * 1000);
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < SAMPLES; i++) MPU6050_AHRS_Fixed_Update(&ahrsFixed, &Samples[i]);
+	}
+	ticks[3] = Bench_Ticks() - start;
+	Bench_Sink = ahrsFixed.q[0];
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < SAMPLES; i++) MPU6050_CF_Update(&cf, &Samples[i]);
+	}
+	ticks[4] = Bench_Ticks() - start;
+	Bench_Sink = cf.angle.roll;
+
+	printf("%s, %s per sample:\n", BENCH_FLOAT_ABI, BENCH_UNIT);
+	printf("  conversion    float %8.1f   Q16.16 %8.1f\n", (double)ticks[0] / (REPEATS * SAMPLES), (double)ticks[1] / (REPEATS * SAMPLES));
+	printf("  Madgwick      float %8.1f   Q30    %8.1f\n", (double)ticks[2] / (REPEATS * SAMPLES), (double)ticks[3] / (REPEATS * SAMPLES));
+	printf("  complementary               Q16.16 %8.1f\n", (double)ticks[4] / (REPEATS * SAMPLES));
+}
+
+int main(void){
+
+	Bench_Init();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Gyro_Set_Range(&Dev, MPU6050_GYRO_500), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Accel_Set_Range(&Dev, MPU6050_ACCEL_4g), MPU6050_NO_ERROR);
+	Bench_Samples(Samples, SAMPLES);
+
+	Check_Agreement();
+	Measure();
+
+	return TEST_RESULT("bench_float_abi");
+}
@@ -0,0 +1,193 @@
+/**
+ * @file bench_mpu6050_ahrs.c
+ * @brief Benchmark, Madgwick filter updates per second and accuracy on a synthetic trajectory
+ *
+ * The board turns about all three axes with slowly varying rates for 60 s at
+ * 1 kHz. Gyro and accelerometer samples are generated from the true attitude
+ * with white noise, so the tilt error of both filters is known at every step.
+ * After the first 2 s the RMS and largest tilt errors must stay within limits
+ * and float and fixed point must agree. Updates per second are measured on
+ * the first samples of the trajectory.
+ *
+ *	gcc -std=gnu99 -O2 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest -Itest/host -include stm32_host.h test/bench_mpu6050_ahrs.c test/host/stm32_host.c \
+ *		cmsis_lib/source/mpu6050.c cmsis_lib/source/mpu6050_ahrs.c -lm -o bench_mpu6050_ahrs && ./bench_mpu6050_ahrs
+ */
+
+#include <math.h>
+#include "mpu6050_ahrs.h"
+#include "test.h"
+#include "bench.h"
+
+#define RATE_HZ				1000
+#define DURATION_S			60
+#define SETTLE_S			2
+#define ACCEL_NOISE_LSB		8.0			//Accelerometer noise, 1 sigma
+#define GYRO_NOISE_LSB		2.0			//Gyro noise, 1 sigma
+
+/* Limits after settling, degrees */
+#define TILT_RMS_MAX		0.2
+#define TILT_ERROR_MAX		1.0
+#define VARIANT_ERROR_MAX	0.5
+
+#define TIMED_SAMPLES		256
+#define REPEATS				100
+
+static MPU6050_Device Dev;
+static MPU6050_rawData Timed[TIMED_SAMPLES];
+
+/* @brief Normal distributed noise, Box-Muller on the bench random numbers */
+static double Noise(void){
+
+	double u = ((uint16_t)Bench_Random16() + 1.0) / 65537.0;
+	double v = ((uint16_t)Bench_Random16() + 1.0) / 65537.0;
+
+	return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/* @brief Gravity in the sensor frame for attitude q, sensor to earth */
+static void Gravity(const double* q, double* g){
+
+	g[0] = 2 * (q[1] * q[3] - q[0] * q[2]);
+	g[1] = 2 * (q[0] * q[1] + q[2] * q[3]);
+	g[2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+}
+
+/* @brief Angle between the gravity directions of two attitudes, degrees */
+static double Tilt_Error(const double* a, const double* b){
+
+	double ga[3], gb[3];
+	double dot;
+
+	Gravity(a, ga);
+	Gravity(b, gb);
+	dot = ga[0] * gb[0] + ga[1] * gb[1] + ga[2] * gb[2];
+	return acos(fmin(dot, 1.0)) * 180 / M_PI;
+}
+
+/* @brief Advance the true attitude by one sample and produce the raw sample */
+static void Trajectory_Step(double* q, uint32_t n, MPU6050_rawData* data){
+
+	double t = (double)n / RATE_HZ;
+	double w[3], r[4], g[3], p[4];
+	double half, k;
+	uint8_t i;
+
+	/* Body rates in rad/s */
+	w[0] = 1.5 * sin(0.7 * t);
+	w[1] = 1.2 * sin(0.5 * t + 1);
+	w[2] = 0.8 * cos(0.3 * t);
+
+	/* q = q * rotation by w over one sample */
+	half = sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]) / (2 * RATE_HZ);
+	r[0] = cos(half);
+	k = (half > 0) ? sin(half) / (half * 2 * RATE_HZ) : 0;
+	r[1] = w[0] * k;
+	r[2] = w[1] * k;
+	r[3] = w[2] * k;
+	for(i = 0; i < 4; i++) p[i] = q[i];
+	q[0] = p[0] * r[0] - p[1] * r[1] - p[2] * r[2] - p[3] * r[3];
+	q[1] = p[0] * r[1] + p[1] * r[0] + p[2] * r[3] - p[3] * r[2];
+	q[2] = p[0] * r[2] - p[1] * r[3] + p[2] * r[0] + p[3] * r[1];
+	q[3] = p[0] * r[3] + p[1] * r[2] - p[2] * r[1] + p[3] * r[0];
+
+	Gravity(q, g);
+	data->accelX = (int16_t)lround(g[0] / Dev.accelMul + Noise() * ACCEL_NOISE_LSB);
+	data->accelY = (int16_t)lround(g[1] / Dev.accelMul + Noise() * ACCEL_NOISE_LSB);
+	data->accelZ = (int16_t)lround(g[2] / Dev.accelMul + Noise() * ACCEL_NOISE_LSB);
+	data->temp = 0;
+	data->gyroX = (int16_t)lround(w[0] * 180 / M_PI / Dev.gyroMul + Noise() * GYRO_NOISE_LSB);
+	data->gyroY = (int16_t)lround(w[1] * 180 / M_PI / Dev.gyroMul + Noise() * GYRO_NOISE_LSB);
+	data->gyroZ = (int16_t)lround(w[2] * 180 / M_PI / Dev.gyroMul + Noise() * GYRO_NOISE_LSB);
+}
+
+/* Both filters follow the trajectory */
+static void Check_Accuracy(void){
+
+	MPU6050_AHRS ahrs;
+	MPU6050_AHRS_Fixed fixed;
+	MPU6050_rawData data;
+	double truth[4] = {1, 0, 0, 0};
+	double qf[4], qx[4];
+	double e, ef, ex, sumF = 0, sumX = 0, maxF = 0, maxX = 0, maxVariant = 0;
+	uint32_t n, count = 0;
+	uint8_t k;
+
+	MPU6050_AHRS_Init(&ahrs, &Dev, 0, 1000000 / RATE_HZ);
+	MPU6050_AHRS_Fixed_Init(&fixed, &Dev, 0, 1000000 / RATE_HZ);
+
+	for(n = 0; n < (uint32_t)DURATION_S * RATE_HZ; n++){
+		Trajectory_Step(truth, n, &data);
+		if(n < TIMED_SAMPLES) Timed[n] = data;
+
+		MPU6050_AHRS_Update(&ahrs, &data);
+		MPU6050_AHRS_Fixed_Update(&fixed, &data);
+		if(n < (uint32_t)SETTLE_S * RATE_HZ) continue;
+
+		for(k = 0; k < 4; k++){
+			qf[k] = ahrs.q[k];
+			qx[k] = fixed.q[k] / 1073741824.0;
+		}
+		ef = Tilt_Error(qf, truth);
+		ex = Tilt_Error(qx, truth);
+		e = Tilt_Error(qf, qx);
+		sumF += ef * ef;
+		sumX += ex * ex;
+		if(ef > maxF) maxF = ef;
+		if(ex > maxX) maxX = ex;
+		if(e > maxVariant) maxVariant = e;
+		count++;
+	}
+
+	printf("tilt error, float: %.3f deg RMS %.3f deg max, Q30: %.3f deg RMS %.3f deg max, float against Q30 %.3f deg max\n",
+		   sqrt(sumF / count), maxF, sqrt(sumX / count), maxX, maxVariant);
+
+	CHECK(sqrt(sumF / count) < TILT_RMS_MAX);
+	CHECK(sqrt(sumX / count) < TILT_RMS_MAX);
+	CHECK(maxF < TILT_ERROR_MAX);
+	CHECK(maxX < TILT_ERROR_MAX);
+	CHECK(maxVariant < VARIANT_ERROR_MAX);
+}
+
+static void Measure(void){
+
+	MPU6050_AHRS ahrs;
+	MPU6050_AHRS_Fixed fixed;
+	uint32_t start, floatTicks, fixedTicks;
+	uint16_t r, i;
+
+	MPU6050_AHRS_Init(&ahrs, &Dev, 0, 1000000 / RATE_HZ);
+	MPU6050_AHRS_Fixed_Init(&fixed, &Dev, 0, 1000000 / RATE_HZ);
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < TIMED_SAMPLES; i++) MPU6050_AHRS_Update(&ahrs, &Timed[i]);
+	}
+	floatTicks = Bench_Ticks() - start;
+	Bench_Sink = (int32_t)(ahrs.q[0] * 1000);
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < TIMED_SAMPLES; i++) MPU6050_AHRS_Fixed_Update(&fixed, &Timed[i]);
+	}
+	fixedTicks = Bench_Ticks() - start;
+	Bench_Sink = fixed.q[0];
+
+	printf("%s: float %.1f %s per update, %.0f updates/s; Q30 %.1f %s per update, %.0f updates/s\n", BENCH_FLOAT_ABI,
+		   (double)floatTicks / (REPEATS * TIMED_SAMPLES), BENCH_UNIT, (double)BENCH_TICKS_PER_S * REPEATS * TIMED_SAMPLES / floatTicks,
+		   (double)fixedTicks / (REPEATS * TIMED_SAMPLES), BENCH_UNIT, (double)BENCH_TICKS_PER_S * REPEATS * TIMED_SAMPLES / fixedTicks);
+}
+
+int main(void){
+
+	Bench_Init();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Gyro_Set_Range(&Dev, MPU6050_GYRO_500), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Accel_Set_Range(&Dev, MPU6050_ACCEL_4g), MPU6050_NO_ERROR);
+
+	Check_Accuracy();
+	Measure();
+
+	return TEST_RESULT("bench_mpu6050_ahrs");
+}
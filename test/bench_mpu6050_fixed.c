@@ -0,0 +1,158 @@
+/**
+ * @file bench_mpu6050_fixed.c
+ * @brief Benchmark, Q16.16 sample conversion against the float conversion
+ *
+ * For every gyro and accel range MPU6050_Convert_Fixed must give exactly the
+ * product of the raw value and a multiplier rounded here independently of the
+ * driver macros, computed in 64-bit so no product overflows, and every value
+ * must be within one Q16.16 LSB of the exact value and of the float conversion.
+ * Prints the cost per sample of MPU6050_Convert_Fixed and of the float
+ * conversion of MPU6050_Get_Gyro_Data and MPU6050_Get_Accel_Data. Exits with a
+ * non-zero status on a mismatch.
+ *
+ *	gcc -std=gnu99 -O2 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest -Itest/host -include stm32_host.h test/bench_mpu6050_fixed.c test/host/stm32_host.c \
+ *		cmsis_lib/source/mpu6050.c -lm -o bench_mpu6050_fixed && ./bench_mpu6050_fixed
+ */
+
+#include <math.h>
+#include <float.h>
+#include "mpu6050.h"
+#include "test.h"
+#include "bench.h"
+
+#define SAMPLES				256
+#define REPEATS				200
+
+static const MPU6050_Gyro_Range Gyro_Ranges[4] = {MPU6050_GYRO_250, MPU6050_GYRO_500, MPU6050_GYRO_1000, MPU6050_GYRO_2000};
+static const float Gyro_Lsb[4] = {MPU6050_GYRO_RANGE_250, MPU6050_GYRO_RANGE_500, MPU6050_GYRO_RANGE_1000, MPU6050_GYRO_RANGE_2000};
+static const uint16_t Gyro_Dps[4] = {250, 500, 1000, 2000};
+static const MPU6050_Accel_Range Accel_Ranges[4] = {MPU6050_ACCEL_2g, MPU6050_ACCEL_4g, MPU6050_ACCEL_8g, MPU6050_ACCEL_16g};
+static const float Accel_Lsb[4] = {MPU6050_ACCEL_RANGE_2g, MPU6050_ACCEL_RANGE_4g, MPU6050_ACCEL_RANGE_8g, MPU6050_ACCEL_RANGE_16g};
+
+static MPU6050_Device Dev;
+static MPU6050_rawData Samples[SAMPLES];
+
+/* Float conversion of one sample as done by the float getters */
+static void Convert_Float(const MPU6050_rawData* raw, float* out){
+
+	out[0] = raw->accelX * Dev.accelMul;
+	out[1] = raw->accelY * Dev.accelMul;
+	out[2] = raw->accelZ * Dev.accelMul;
+	out[3] = raw->temp / 340.0f + 36.53f;
+	out[4] = raw->gyroX * Dev.gyroMul;
+	out[5] = raw->gyroY * Dev.gyroMul;
+	out[6] = raw->gyroZ * Dev.gyroMul;
+}
+
+/* @brief Q0.32 product rounded to Q16.16, the way the driver must do it */
+static int64_t Q32_To_Q16(int16_t raw, int64_t mulQ32){
+
+	return (raw * mulQ32 + 32768) >> 16;
+}
+
+/* @brief One value against the expected product, the exact value and the float conversion
+ * @param error - largest error against the exact value in Q16.16 LSBs so far, updated
+ */
+static void Check_Axis(int32_t fixed, int64_t expected, double exact, float converted, double* error){
+
+	double e = fabs(fixed - exact * 65536);
+
+	CHECK_EQ(fixed, expected);
+	/* Float keeps 24 significant bits, fewer than Q16.16 above 256 */
+	CHECK(fabs(fixed - (double)converted * 65536) <= 1 + fabs(converted) * 65536 * 2 * FLT_EPSILON);
+	if(e > *error) *error = e;
+}
+
+/* Every range, every sample bit-exact and within one LSB */
+static void Check_Ranges(void){
+
+	MPU6050_fixedData out;
+	int64_t gyroMul, accelMul, tempMul;
+	double gyroError, accelError, tempError;
+	uint8_t g, a;
+	uint16_t i;
+
+	for(g = 0; g < 4; g++){
+		for(a = 0; a < 4; a++){
+			CHECK_EQ(MPU6050_Gyro_Set_Range(&Dev, Gyro_Ranges[g]), MPU6050_NO_ERROR);
+			CHECK_EQ(MPU6050_Accel_Set_Range(&Dev, Accel_Ranges[a]), MPU6050_NO_ERROR);
+
+			/* Multipliers rounded to nearest independently of the driver macros,
+			 * gyro and temperature in Q0.32, accelerometer scales are whole Q16.16 numbers */
+			gyroMul = llround(4294967296.0 / Gyro_Lsb[g]);
+			accelMul = llround(65536000.0 / Accel_Lsb[a]);
+			tempMul = llround(4294967296.0 / 340);
+			CHECK_EQ(Dev.gyroMulQ32, gyroMul);
+			CHECK_EQ(Dev.accelMulQ16, accelMul);
+			CHECK_EQ(65536000.0 / Accel_Lsb[a], accelMul);
+
+			gyroError = accelError = tempError = 0;
+			for(i = 0; i < SAMPLES; i++){
+				const MPU6050_rawData* s = &Samples[i];
+				float values[7];
+
+				MPU6050_Convert_Fixed(&Dev, s, &out);
+				Convert_Float(s, values);
+				Check_Axis(out.accelX, s->accelX * accelMul, s->accelX * 1000.0 / Accel_Lsb[a], values[0] * 1000, &accelError);
+				Check_Axis(out.accelY, s->accelY * accelMul, s->accelY * 1000.0 / Accel_Lsb[a], values[1] * 1000, &accelError);
+				Check_Axis(out.accelZ, s->accelZ * accelMul, s->accelZ * 1000.0 / Accel_Lsb[a], values[2] * 1000, &accelError);
+				Check_Axis(out.temp, Q32_To_Q16(s->temp, tempMul) + MPU6050_TEMP_Q16_OFFSET, s->temp / 340.0 + 36.53, values[3], &tempError);
+				Check_Axis(out.gyroX, Q32_To_Q16(s->gyroX, gyroMul), s->gyroX / (double)Gyro_Lsb[g], values[4], &gyroError);
+				Check_Axis(out.gyroY, Q32_To_Q16(s->gyroY, gyroMul), s->gyroY / (double)Gyro_Lsb[g], values[5], &gyroError);
+				Check_Axis(out.gyroZ, Q32_To_Q16(s->gyroZ, gyroMul), s->gyroZ / (double)Gyro_Lsb[g], values[6], &gyroError);
+			}
+
+			/* Half an LSB of rounding plus 32768 times the multiplier rounding, a quarter LSB */
+			CHECK(gyroError <= 1);
+			CHECK(accelError <= 1);
+			CHECK(tempError <= 1);
+			if(a == 0){
+				printf("gyro %4u deg/s: largest error %.3f LSB (%.7f deg/s), accel 2g %.3f LSB, temp %.3f LSB, Q16.16\n",
+					   Gyro_Dps[g], gyroError, gyroError / 65536, accelError, tempError);
+			}
+		}
+	}
+}
+
+static void Measure(void){
+
+	MPU6050_fixedData fixed;
+	float values[7];
+	uint32_t start, fixedTicks, floatTicks;
+	uint16_t r, i;
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < SAMPLES; i++){
+			MPU6050_Convert_Fixed(&Dev, &Samples[i], &fixed);
+			Bench_Sink = fixed.accelX + fixed.gyroZ + fixed.temp;
+		}
+	}
+	fixedTicks = Bench_Ticks() - start;
+
+	start = Bench_Ticks();
+	for(r = 0; r < REPEATS; r++){
+		for(i = 0; i < SAMPLES; i++){
+			Convert_Float(&Samples[i], values);
+			Bench_Sink = (int32_t)(values[0] + values[6] + values[3]);
+		}
+	}
+	floatTicks = Bench_Ticks() - start;
+
+	printf("%s, per sample of 7 values: Q16.16 %.1f %s, float %.1f %s\n", BENCH_FLOAT_ABI,
+		   (double)fixedTicks / (REPEATS * SAMPLES), BENCH_UNIT, (double)floatTicks / (REPEATS * SAMPLES), BENCH_UNIT);
+}
+
+int main(void){
+
+	Bench_Init();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	Bench_Samples(Samples, SAMPLES);
+
+	Check_Ranges();
+	Measure();
+
+	return TEST_RESULT("bench_mpu6050_fixed");
+}
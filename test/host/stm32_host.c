@@ -0,0 +1,737 @@
+/**
+ * @file stm32_host.c
+ * @brief Simulated STM32F303 peripherals for the host tests, check stm32_host.h
+ *
+ * I2C1 follows the reference manual master sequence closely enough for the
+ * driver: TXIS asks for the next byte to send, RXNE holds a received byte, TC
+ * and TCR end a transfer in software end and reload mode, STOPF ends a
+ * transaction in auto end mode. Flags live in Host_I2C1.ISR, interrupt and DMA
+ * enables in Host_I2C1.CR1, so tests can check the registers directly.
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+
+I2C_TypeDef Host_I2C1;
+I2C_TypeDef Host_I2C2;
+DMA_TypeDef Host_DMA1;
+DMA_Channel_TypeDef Host_DMA1_Channel7;
+GPIO_TypeDef Host_GPIO[6];
+SPI_TypeDef Host_SPI[3];
+TIM_TypeDef Host_TIM2;
+EXTI_TypeDef Host_EXTI;
+SYSCFG_TypeDef Host_SYSCFG;
+DWT_Type Host_DWT;
+CoreDebug_Type Host_CoreDebug;
+
+uint32_t SystemCoreClock = HOST_CORE_CLOCK_HZ;
+
+uint8_t Host_Regs[128];
+Host_Bus_Stats Host_Bus;
+void (*Host_Idle_Hook)(void) = 0;
+
+/* Interrupt handlers of the driver */
+void I2C1_EV_IRQHandler(void);
+void DMA1_Channel7_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+
+/* Cycles that pass with every flag poll, keeps timeouts of the driver finite */
+#define HOST_POLL_CYCLES		8
+
+/* Transfer state of the I2C1 model */
+static uint8_t Host_Busy;				//Between START and STOP
+static uint8_t Host_Reading;			//Current phase is a read
+static uint8_t Host_Reg_Phase;			//Next byte written is the register address
+static uint8_t Host_Pointer;			//Register pointer of the slave
+static uint16_t Host_Remaining;			//Bytes left in the current NBYTES count
+static uint32_t Host_End_Mode;			//I2C_SoftEnd_Mode, I2C_Reload_Mode or I2C_AutoEnd_Mode
+static uint8_t* Host_DMA_Target;		//Memory DMA1 channel 7 writes to
+static uint32_t Host_NVIC_Enabled;		//IRQ channels enabled with NVIC_Init, bit per IRQn
+static uint8_t Host_SDA_Held;			//SCL pulses until the slave releases SDA
+static uint8_t Host_FIFO[MPU6050_FIFO_SIZE];	//FIFO of the slave, ring buffer
+static uint16_t Host_FIFO_Head;			//Oldest byte
+static uint16_t Host_FIFO_Length;		//Bytes stored
+
+/* @brief Lets cycles pass, the counter only runs once enabled as on the core */
+static void Host_Cycles(uint32_t cycles){
+
+	if((Host_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) && (Host_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk)){
+		Host_DWT.CYCCNT += cycles;
+	}
+}
+
+/* @brief Clears all peripherals, the register file and the counters */
+void Host_Reset(void){
+
+	memset(&Host_I2C1, 0, sizeof(Host_I2C1));
+	memset(&Host_I2C2, 0, sizeof(Host_I2C2));
+	memset(&Host_DMA1, 0, sizeof(Host_DMA1));
+	memset(&Host_DMA1_Channel7, 0, sizeof(Host_DMA1_Channel7));
+	memset(Host_GPIO, 0, sizeof(Host_GPIO));
+	memset(Host_SPI, 0, sizeof(Host_SPI));
+	memset(&Host_TIM2, 0, sizeof(Host_TIM2));
+	memset(&Host_EXTI, 0, sizeof(Host_EXTI));
+	memset(&Host_SYSCFG, 0, sizeof(Host_SYSCFG));
+	memset(&Host_DWT, 0, sizeof(Host_DWT));
+	memset(&Host_CoreDebug, 0, sizeof(Host_CoreDebug));
+	memset(Host_Regs, 0, sizeof(Host_Regs));
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+
+	/* Reset values of the registers the driver reads back */
+	Host_Regs[PWR_MGMT_1] = 0x40;
+	Host_Regs[WHO_AM_I] = 0x68;
+
+	Host_Busy = 0;
+	Host_Reading = 0;
+	Host_Reg_Phase = 0;
+	Host_Pointer = 0;
+	Host_Remaining = 0;
+	Host_End_Mode = 0;
+	Host_DMA_Target = 0;
+	Host_NVIC_Enabled = 0;
+	Host_SDA_Held = 0;
+	Host_FIFO_Head = 0;
+	Host_FIFO_Length = 0;
+	Host_Idle_Hook = 0;
+
+	/* CYCCNT 0 marks an unset start time in the driver */
+	Host_DWT.CYCCNT = 1;
+}
+
+/* @brief Lets time pass on the cycle counter */
+void Host_Advance_Us(uint32_t us){
+
+	Host_Cycles(us * (HOST_CORE_CLOCK_HZ / 1000000));
+}
+
+/* @brief Stores a sample in ACCEL_XOUT_H..GYRO_ZOUT_L, big endian as on the sensor */
+void Host_Set_Sample(int16_t accelX, int16_t accelY, int16_t accelZ, int16_t temp, int16_t gyroX, int16_t gyroY, int16_t gyroZ){
+
+	int16_t values[7];
+	uint8_t i;
+
+	values[0] = accelX;
+	values[1] = accelY;
+	values[2] = accelZ;
+	values[3] = temp;
+	values[4] = gyroX;
+	values[5] = gyroY;
+	values[6] = gyroZ;
+
+	for(i = 0; i < 7; i++){
+		Host_Regs[ACCEL_XOUT_H + 2 * i] = (uint8_t)((uint16_t)values[i] >> 8);
+		Host_Regs[ACCEL_XOUT_H + 2 * i + 1] = (uint8_t)values[i];
+	}
+}
+
+DWT_Type* Host_DWT_Access(void){
+
+	Host_Cycles(HOST_POLL_CYCLES);
+	return &Host_DWT;
+}
+
+/* @brief Sensor writes bytes to its FIFO, only while USER_CTRL FIFO_EN is set
+ * Oldest bytes are lost on overflow and INT_STATUS FIFO_OFLOW_INT is set.
+ */
+void Host_FIFO_Push(const uint8_t* data, uint16_t length){
+
+	uint16_t i;
+
+	if(!(Host_Regs[USER_CTRL] & MPU6050_USER_FIFO_EN)) return;
+
+	for(i = 0; i < length; i++){
+		if(Host_FIFO_Length == MPU6050_FIFO_SIZE){
+			Host_FIFO_Head = (Host_FIFO_Head + 1) % MPU6050_FIFO_SIZE;
+			Host_FIFO_Length--;
+			Host_Regs[INT_STATUS] |= MPU6050_INT_FIFO_OFLOW;
+		}
+		Host_FIFO[(Host_FIFO_Head + Host_FIFO_Length) % MPU6050_FIFO_SIZE] = data[i];
+		Host_FIFO_Length++;
+	}
+}
+
+/* @brief Get number of bytes in the FIFO of the slave */
+uint16_t Host_FIFO_Count(void){
+
+	return Host_FIFO_Length;
+}
+
+/* @brief Register at the slave register pointer, without the side effects of a read */
+static uint8_t Host_Slave_Peek(void){
+
+	switch(Host_Pointer & 0x7F){
+	case FIFO_COUNTH:
+		return (uint8_t)(Host_FIFO_Length >> 8);
+	case FIFO_COUNTL:
+		return (uint8_t)Host_FIFO_Length;
+	case FIFO_R_W:
+		return Host_FIFO_Length ? Host_FIFO[Host_FIFO_Head] : 0;
+	default:
+		return Host_Regs[Host_Pointer & 0x7F];
+	}
+}
+
+/* @brief Reads the register at the slave register pointer
+ * FIFO_R_W pops the FIFO and keeps the pointer, so a burst drains the FIFO.
+ * Reading INT_STATUS clears it.
+ */
+static uint8_t Host_Slave_Read(void){
+
+	uint8_t data = Host_Slave_Peek();
+
+	if((Host_Pointer & 0x7F) == FIFO_R_W){
+		if(Host_FIFO_Length){
+			Host_FIFO_Head = (Host_FIFO_Head + 1) % MPU6050_FIFO_SIZE;
+			Host_FIFO_Length--;
+		}
+		return data;
+	}
+
+	if((Host_Pointer & 0x7F) == INT_STATUS) Host_Regs[INT_STATUS] = 0;
+	Host_Pointer++;
+	return data;
+}
+
+/* @brief Writes the register at the slave register pointer
+ * USER_CTRL FIFO_RESET empties the FIFO and clears itself.
+ */
+static void Host_Slave_Write(uint8_t data){
+
+	if((Host_Pointer & 0x7F) == USER_CTRL && (data & MPU6050_USER_FIFO_RESET)){
+		Host_FIFO_Head = 0;
+		Host_FIFO_Length = 0;
+		data &= ~MPU6050_USER_FIFO_RESET;
+	}
+	Host_Regs[Host_Pointer & 0x7F] = data;
+	Host_Pointer++;
+}
+
+void Host_WFI(void){
+
+	if(Host_Idle_Hook != 0) Host_Idle_Hook();
+}
+
+/* @brief Updates the flags after a byte went over the bus */
+static void Host_Byte_Done(void){
+
+	Host_I2C1.ISR &= ~(I2C_ISR_TXIS | I2C_ISR_RXNE);
+
+	if(Host_Remaining != 0){
+		Host_I2C1.ISR |= Host_Reading ? I2C_ISR_RXNE : I2C_ISR_TXIS;
+		if(Host_Reading) Host_I2C1.RXDR = Host_Slave_Peek();
+		return;
+	}
+
+	if(Host_End_Mode == I2C_AutoEnd_Mode){
+		Host_I2C1.ISR |= I2C_ISR_STOPF;
+		Host_Busy = 0;
+		Host_Bus.stops++;
+	}
+	else if(Host_End_Mode == I2C_Reload_Mode){
+		Host_I2C1.ISR |= I2C_ISR_TCR;
+	}
+	else{
+		Host_I2C1.ISR |= I2C_ISR_TC;
+	}
+}
+
+/* @brief Takes the received byte out of RXDR, for the CPU and for DMA */
+static uint8_t Host_Receive(void){
+
+	uint8_t data;
+
+	if(!(Host_I2C1.ISR & I2C_ISR_RXNE)){
+		Host_Bus.protocolErrors++;
+		return 0;
+	}
+
+	data = Host_Slave_Read();
+	Host_Remaining--;
+	Host_Bus.bytesRead++;
+	Host_Byte_Done();
+
+	return data;
+}
+
+void I2C_TransferHandling(I2C_TypeDef* I2Cx, uint16_t Address, uint8_t Number_Bytes, uint32_t ReloadEndMode, uint32_t StartStopMode){
+
+	uint8_t repeated;
+
+	if(I2Cx != I2C1) return;
+
+	/* A START on a busy bus is only valid as a repeated START after TC */
+	repeated = Host_Busy && (Host_I2C1.ISR & I2C_ISR_TC);
+
+	Host_I2C1.CR2 = (Address & I2C_CR2_SADD) | ((uint32_t)Number_Bytes << 16) | ReloadEndMode | StartStopMode;
+	Host_I2C1.ISR &= ~(I2C_ISR_TC | I2C_ISR_TCR | I2C_ISR_TXIS | I2C_ISR_RXNE);
+	Host_Remaining = Number_Bytes;
+	Host_End_Mode = ReloadEndMode;
+
+	if(StartStopMode == I2C_Generate_Start_Write || StartStopMode == I2C_Generate_Start_Read){
+		if(Host_Busy && !repeated) Host_Bus.protocolErrors++;
+		Host_Busy = 1;
+		Host_Bus.starts++;
+
+		if((Address >> 1) != MPU6050_ADDRESS){
+			Host_I2C1.ISR |= I2C_ISR_NACKF;
+			if(ReloadEndMode == I2C_AutoEnd_Mode){
+				Host_I2C1.ISR |= I2C_ISR_STOPF;
+				Host_Busy = 0;
+				Host_Bus.stops++;
+			}
+			return;
+		}
+
+		Host_Reading = (StartStopMode == I2C_Generate_Start_Read);
+		if(Host_Reading){
+			Host_Bus.reads++;
+			Host_Bus.lastReadReg = Host_Pointer;
+			Host_Bus.lastReadLength = Number_Bytes;
+		}
+		else{
+			Host_Bus.writes++;
+			Host_Reg_Phase = 1;
+		}
+	}
+
+	if(Host_Remaining == 0){
+		Host_Byte_Done();
+		return;
+	}
+
+	if(Host_Reading){
+		Host_I2C1.RXDR = Host_Slave_Peek();
+		Host_I2C1.ISR |= I2C_ISR_RXNE;
+	}
+	else{
+		Host_I2C1.ISR |= I2C_ISR_TXIS;
+	}
+}
+
+void I2C_SendData(I2C_TypeDef* I2Cx, uint8_t Data){
+
+	if(I2Cx != I2C1) return;
+
+	if(!(Host_I2C1.ISR & I2C_ISR_TXIS) || Host_Reading){
+		Host_Bus.protocolErrors++;
+		return;
+	}
+
+	Host_I2C1.TXDR = Data;
+	if(Host_Reg_Phase){
+		Host_Pointer = Data;
+		Host_Reg_Phase = 0;
+	}
+	else{
+		Host_Slave_Write(Data);
+	}
+	Host_Remaining--;
+	Host_Bus.bytesWritten++;
+	Host_Byte_Done();
+}
+
+uint8_t I2C_ReceiveData(I2C_TypeDef* I2Cx){
+
+	if(I2Cx != I2C1) return 0;
+
+	/* RXNE is served by DMA while RXDMAEN is set */
+	if(Host_I2C1.CR1 & I2C_CR1_RXDMAEN) Host_Bus.protocolErrors++;
+
+	return Host_Receive();
+}
+
+FlagStatus I2C_GetFlagStatus(I2C_TypeDef* I2Cx, uint32_t I2C_FLAG){
+
+	Host_Cycles(HOST_POLL_CYCLES);
+
+	if(I2Cx != I2C1) return RESET;
+
+	if(I2C_FLAG == I2C_FLAG_BUSY) return Host_Busy ? SET : RESET;
+	return (Host_I2C1.ISR & I2C_FLAG) ? SET : RESET;
+}
+
+void I2C_ClearFlag(I2C_TypeDef* I2Cx, uint32_t I2C_FLAG){
+
+	if(I2Cx != I2C1) return;
+
+	Host_I2C1.ISR &= ~(I2C_FLAG & (I2C_ISR_NACKF | I2C_ISR_STOPF | I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR));
+}
+
+void I2C_GenerateSTOP(I2C_TypeDef* I2Cx, FunctionalState NewState){
+
+	if(I2Cx != I2C1 || NewState == DISABLE) return;
+
+	Host_I2C1.ISR &= ~(I2C_ISR_TC | I2C_ISR_TCR | I2C_ISR_TXIS | I2C_ISR_RXNE);
+	Host_I2C1.ISR |= I2C_ISR_STOPF;
+	Host_Busy = 0;
+	Host_Bus.stops++;
+}
+
+void I2C_ITConfig(I2C_TypeDef* I2Cx, uint32_t I2C_IT, FunctionalState NewState){
+
+	if(NewState != DISABLE) I2Cx->CR1 |= I2C_IT;
+	else I2Cx->CR1 &= ~I2C_IT;
+}
+
+void I2C_DMACmd(I2C_TypeDef* I2Cx, uint32_t I2C_DMAReq, FunctionalState NewState){
+
+	if(NewState != DISABLE) I2Cx->CR1 |= I2C_DMAReq;
+	else I2Cx->CR1 &= ~I2C_DMAReq;
+}
+
+void I2C_Cmd(I2C_TypeDef* I2Cx, FunctionalState NewState){
+
+	if(NewState != DISABLE) I2Cx->CR1 |= I2C_CR1_PE;
+	else I2Cx->CR1 &= ~I2C_CR1_PE;
+}
+
+void I2C_SoftwareResetCmd(I2C_TypeDef* I2Cx){
+
+	if(I2Cx != I2C1) return;
+
+	Host_I2C1.ISR = 0;
+	Host_Busy = 0;
+	Host_Remaining = 0;
+	Host_Bus.softwareResets++;
+}
+
+/* @brief Runs I2C1_EV_IRQHandler once if an enabled event is pending
+ * @retval 1 if the handler ran, 0 if nothing was pending
+ */
+uint8_t Host_I2C_Step(void){
+
+	uint32_t isr = Host_I2C1.ISR;
+	uint32_t cr1 = Host_I2C1.CR1;
+	uint8_t pending = 0;
+
+	if(!(Host_NVIC_Enabled & (1UL << I2C1_EV_IRQn))) return 0;
+
+	if((isr & I2C_ISR_TXIS) && (cr1 & I2C_CR1_TXIE)) pending = 1;
+	if((isr & I2C_ISR_RXNE) && (cr1 & I2C_CR1_RXIE) && !(cr1 & I2C_CR1_RXDMAEN)) pending = 1;
+	if((isr & (I2C_ISR_TC | I2C_ISR_TCR)) && (cr1 & I2C_CR1_TCIE)) pending = 1;
+	if((isr & I2C_ISR_STOPF) && (cr1 & I2C_CR1_STOPIE)) pending = 1;
+	if((isr & I2C_ISR_NACKF) && (cr1 & I2C_CR1_NACKIE)) pending = 1;
+
+	if(!pending) return 0;
+
+	Host_Cycles(HOST_POLL_CYCLES);
+	I2C1_EV_IRQHandler();
+	return 1;
+}
+
+/* @brief Runs I2C1 event interrupts until none is pending
+ * @retval number of handler calls
+ */
+uint32_t Host_I2C_Run(void){
+
+	uint32_t calls = 0;
+
+	while(Host_I2C_Step()) calls++;
+	return calls;
+}
+
+/* @brief Memory buffer behind the 32-bit CMAR value the driver programs
+ * Pointers do not fit CMAR on a 64-bit host, DMA writes to this buffer and
+ * Host_DMA_Step only checks that CMAR holds its low 32 bits.
+ */
+void Host_DMA_Memory(uint8_t* memory){
+
+	Host_DMA_Target = memory;
+}
+
+/* @brief Moves received bytes from I2C1 to memory with DMA1 channel 7
+ * Transfer complete runs DMA1_Channel7_IRQHandler if the interrupt is enabled.
+ *
+ * @param bytes - most bytes to move
+ * @retval bytes moved
+ */
+uint16_t Host_DMA_Step(uint16_t bytes){
+
+	uint16_t moved = 0;
+
+	if(!(Host_DMA1_Channel7.CCR & DMA_CCR_EN) || !(Host_I2C1.CR1 & I2C_CR1_RXDMAEN)) return 0;
+
+	if(Host_DMA_Target == 0 || Host_DMA1_Channel7.CMAR != (uint32_t)(uintptr_t)Host_DMA_Target){
+		Host_Bus.protocolErrors++;
+		return 0;
+	}
+
+	while(moved < bytes && Host_DMA1_Channel7.CNDTR != 0 && (Host_I2C1.ISR & I2C_ISR_RXNE)){
+		*Host_DMA_Target++ = Host_Receive();
+		Host_DMA1_Channel7.CMAR++;
+		Host_DMA1_Channel7.CNDTR--;
+		moved++;
+	}
+
+	if(moved != 0 && Host_DMA1_Channel7.CNDTR == 0){
+		Host_DMA1.ISR |= DMA1_FLAG_TC7 | DMA1_FLAG_GL7;
+		if((Host_DMA1_Channel7.CCR & DMA_IT_TC) && (Host_NVIC_Enabled & (1UL << DMA1_Channel7_IRQn))){
+			DMA1_Channel7_IRQHandler();
+		}
+	}
+	return moved;
+}
+
+/* @brief Raises a transfer error on DMA1 channel 7, hardware disables the channel */
+void Host_DMA_Error(void){
+
+	Host_DMA1_Channel7.CCR &= ~DMA_CCR_EN;
+	Host_DMA1.ISR |= DMA1_FLAG_TE7 | DMA1_FLAG_GL7;
+	if(Host_NVIC_Enabled & (1UL << DMA1_Channel7_IRQn)){
+		DMA1_Channel7_IRQHandler();
+	}
+}
+
+void DMA_DeInit(DMA_Channel_TypeDef* DMAy_Channelx){
+
+	memset(DMAy_Channelx, 0, sizeof(*DMAy_Channelx));
+}
+
+void DMA_StructInit(DMA_InitTypeDef* DMA_InitStruct){
+
+	memset(DMA_InitStruct, 0, sizeof(*DMA_InitStruct));
+}
+
+void DMA_Init(DMA_Channel_TypeDef* DMAy_Channelx, DMA_InitTypeDef* DMA_InitStruct){
+
+	DMAy_Channelx->CCR = DMA_InitStruct->DMA_DIR | DMA_InitStruct->DMA_MemoryInc | DMA_InitStruct->DMA_Priority;
+	DMAy_Channelx->CPAR = DMA_InitStruct->DMA_PeripheralBaseAddr;
+}
+
+void DMA_ITConfig(DMA_Channel_TypeDef* DMAy_Channelx, uint32_t DMA_IT, FunctionalState NewState){
+
+	if(NewState != DISABLE) DMAy_Channelx->CCR |= DMA_IT;
+	else DMAy_Channelx->CCR &= ~DMA_IT;
+}
+
+void DMA_Cmd(DMA_Channel_TypeDef* DMAy_Channelx, FunctionalState NewState){
+
+	if(NewState != DISABLE) DMAy_Channelx->CCR |= DMA_CCR_EN;
+	else DMAy_Channelx->CCR &= ~DMA_CCR_EN;
+}
+
+void DMA_SetCurrDataCounter(DMA_Channel_TypeDef* DMAy_Channelx, uint16_t DataNumber){
+
+	DMAy_Channelx->CNDTR = DataNumber;
+}
+
+void DMA_ClearFlag(uint32_t DMAy_FLAG){
+
+	Host_DMA1.ISR &= ~DMAy_FLAG;
+}
+
+ITStatus DMA_GetITStatus(uint32_t DMAy_IT){
+
+	return (Host_DMA1.ISR & DMAy_IT) ? SET : RESET;
+}
+
+void DMA_ClearITPendingBit(uint32_t DMAy_IT){
+
+	/* Clearing the global flag clears all flags of the channel */
+	if(DMAy_IT & DMA1_IT_GL7) DMAy_IT |= DMA1_IT_TC7 | DMA1_IT_HT7 | DMA1_IT_TE7;
+	Host_DMA1.ISR &= ~DMAy_IT;
+}
+
+/* @brief Rising edge on the MPU6050 INT pin, runs EXTI1_IRQHandler if enabled */
+void Host_DRDY_Edge(void){
+
+	if(!(Host_EXTI.IMR & EXTI_Line1) || !(Host_EXTI.RTSR & EXTI_Line1)) return;
+
+	Host_EXTI.PR |= EXTI_Line1;
+	if(Host_NVIC_Enabled & (1UL << EXTI1_IRQn)) EXTI1_IRQHandler();
+}
+
+void EXTI_Init(EXTI_InitTypeDef* EXTI_InitStruct){
+
+	uint32_t line = EXTI_InitStruct->EXTI_Line;
+
+	if(EXTI_InitStruct->EXTI_LineCmd == DISABLE){
+		Host_EXTI.IMR &= ~line;
+		return;
+	}
+
+	if(EXTI_InitStruct->EXTI_Mode == EXTI_Mode_Interrupt) Host_EXTI.IMR |= line;
+	if(EXTI_InitStruct->EXTI_Trigger != EXTI_Trigger_Falling) Host_EXTI.RTSR |= line;
+	if(EXTI_InitStruct->EXTI_Trigger != EXTI_Trigger_Rising) Host_EXTI.FTSR |= line;
+}
+
+ITStatus EXTI_GetITStatus(uint32_t EXTI_Line){
+
+	return ((Host_EXTI.PR & EXTI_Line) && (Host_EXTI.IMR & EXTI_Line)) ? SET : RESET;
+}
+
+void EXTI_ClearITPendingBit(uint32_t EXTI_Line){
+
+	Host_EXTI.PR &= ~EXTI_Line;
+}
+
+void NVIC_Init(NVIC_InitTypeDef* NVIC_InitStruct){
+
+	if(NVIC_InitStruct->NVIC_IRQChannelCmd != DISABLE) Host_NVIC_Enabled |= 1UL << NVIC_InitStruct->NVIC_IRQChannel;
+	else Host_NVIC_Enabled &= ~(1UL << NVIC_InitStruct->NVIC_IRQChannel);
+}
+
+void GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_InitStruct){
+
+	uint32_t pin;
+
+	for(pin = 0; pin < 16; pin++){
+		if(!(GPIO_InitStruct->GPIO_Pin & (1UL << pin))) continue;
+
+		if(GPIO_InitStruct->GPIO_Mode == GPIO_Mode_OUT || GPIO_InitStruct->GPIO_Mode == GPIO_Mode_AF){
+			GPIOx->OSPEEDR = (GPIOx->OSPEEDR & ~(3UL << (2 * pin))) | ((uint32_t)GPIO_InitStruct->GPIO_Speed << (2 * pin));
+			GPIOx->OTYPER = (GPIOx->OTYPER & ~(1UL << pin)) | ((uint32_t)GPIO_InitStruct->GPIO_OType << pin);
+		}
+		GPIOx->MODER = (GPIOx->MODER & ~(3UL << (2 * pin))) | ((uint32_t)GPIO_InitStruct->GPIO_Mode << (2 * pin));
+		GPIOx->PUPDR = (GPIOx->PUPDR & ~(3UL << (2 * pin))) | ((uint32_t)GPIO_InitStruct->GPIO_PuPd << (2 * pin));
+	}
+}
+
+/* @brief Slave holds SDA low until the given number of SCL pulses, 255 holds it for ever */
+void Host_Hold_SDA(uint8_t pulses){
+
+	Host_SDA_Held = pulses;
+}
+
+/* @brief Pin of a single bit mask is driven as general purpose output */
+static uint8_t Host_Pin_Output(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin){
+
+	return ((GPIOx->MODER >> (2 * __builtin_ctz(GPIO_Pin))) & 3) == GPIO_Mode_OUT;
+}
+
+/* @brief SCL pulses and STOP conditions made with I2C1 pins as GPIO
+ * @param odr - output data register before the change
+ */
+static void Host_Bus_Pins(GPIO_TypeDef* GPIOx, uint32_t odr){
+
+	uint16_t scl = MPU6050_Bus1.sclPin, sda = MPU6050_Bus1.sdaPin;
+
+	if(GPIOx != MPU6050_Bus1.GPIOx || !Host_Pin_Output(GPIOx, scl) || !Host_Pin_Output(GPIOx, sda)) return;
+
+	/* Rising SCL with SDA released clocks the slave one bit further */
+	if(!(odr & scl) && (GPIOx->ODR & scl) && (GPIOx->ODR & sda) && Host_SDA_Held != 0){
+		if(Host_SDA_Held != 255) Host_SDA_Held--;
+		Host_Bus.sclPulses++;
+	}
+
+	/* SDA rising while SCL stays high */
+	if((odr & scl) && (GPIOx->ODR & scl) && !(odr & sda) && (GPIOx->ODR & sda)){
+		Host_Bus.gpioStops++;
+	}
+}
+
+/* SDA reads low while the slave holds it, every other input reads high */
+uint8_t GPIO_ReadInputDataBit(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin){
+
+	if(GPIOx == MPU6050_Bus1.GPIOx && GPIO_Pin == MPU6050_Bus1.sdaPin && Host_SDA_Held != 0) return (uint8_t)Bit_RESET;
+	return (uint8_t)Bit_SET;
+}
+
+void GPIO_SetBits(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin){
+
+	uint32_t odr = GPIOx->ODR;
+
+	GPIOx->ODR |= GPIO_Pin;
+	Host_Bus_Pins(GPIOx, odr);
+}
+
+void GPIO_ResetBits(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin){
+
+	uint32_t odr = GPIOx->ODR;
+
+	GPIOx->ODR &= ~GPIO_Pin;
+	Host_Bus_Pins(GPIOx, odr);
+}
+
+void SYSCFG_EXTILineConfig(uint8_t EXTI_PortSourceGPIOx, uint8_t EXTI_PinSourcex){
+
+	(void)EXTI_PortSourceGPIOx;
+	(void)EXTI_PinSourcex;
+}
+
+void RCC_AHBPeriphClockCmd(uint32_t RCC_AHBPeriph, FunctionalState NewState){
+
+	(void)RCC_AHBPeriph;
+	(void)NewState;
+}
+
+void RCC_APB1PeriphClockCmd(uint32_t RCC_APB1Periph, FunctionalState NewState){
+
+	(void)RCC_APB1Periph;
+	(void)NewState;
+}
+
+void RCC_APB2PeriphClockCmd(uint32_t RCC_APB2Periph, FunctionalState NewState){
+
+	(void)RCC_APB2Periph;
+	(void)NewState;
+}
+
+void RCC_GetClocksFreq(RCC_ClocksTypeDef* RCC_Clocks){
+
+	memset(RCC_Clocks, 0, sizeof(*RCC_Clocks));
+	RCC_Clocks->SYSCLK_Frequency = HOST_CORE_CLOCK_HZ;
+	RCC_Clocks->HCLK_Frequency = HOST_CORE_CLOCK_HZ;
+	RCC_Clocks->PCLK1_Frequency = HOST_CORE_CLOCK_HZ / 2;
+	RCC_Clocks->PCLK2_Frequency = HOST_CORE_CLOCK_HZ;
+}
+
+/* SPI is not simulated, transfers complete at once and read 0 */
+void SPI_Cmd(SPI_TypeDef* SPIx, FunctionalState NewState){
+
+	(void)SPIx;
+	(void)NewState;
+}
+
+FlagStatus SPI_I2S_GetFlagStatus(SPI_TypeDef* SPIx, uint16_t SPI_I2S_FLAG){
+
+	(void)SPIx;
+	Host_Cycles(HOST_POLL_CYCLES);
+	return (SPI_I2S_FLAG == SPI_I2S_FLAG_BSY) ? RESET : SET;
+}
+
+void SPI_RxFIFOThresholdConfig(SPI_TypeDef* SPIx, uint16_t SPI_RxFIFOThreshold){
+
+	(void)SPIx;
+	(void)SPI_RxFIFOThreshold;
+}
+
+void SPI_SendData8(SPI_TypeDef* SPIx, uint8_t Data){
+
+	(void)SPIx;
+	(void)Data;
+}
+
+uint8_t SPI_ReceiveData8(SPI_TypeDef* SPIx){
+
+	(void)SPIx;
+	return 0;
+}
+
+void TIM_TimeBaseStructInit(TIM_TimeBaseInitTypeDef* TIM_TimeBaseInitStruct){
+
+	memset(TIM_TimeBaseInitStruct, 0, sizeof(*TIM_TimeBaseInitStruct));
+}
+
+void TIM_TimeBaseInit(TIM_TypeDef* TIMx, TIM_TimeBaseInitTypeDef* TIM_TimeBaseInitStruct){
+
+	TIMx->PSC = TIM_TimeBaseInitStruct->TIM_Prescaler;
+	TIMx->ARR = TIM_TimeBaseInitStruct->TIM_Period;
+}
+
+void TIM_Cmd(TIM_TypeDef* TIMx, FunctionalState NewState){
+
+	if(NewState != DISABLE) TIMx->CR1 |= TIM_CR1_CEN;
+	else TIMx->CR1 &= ~TIM_CR1_CEN;
+}
+
+void TIM_SetCounter(TIM_TypeDef* TIMx, uint32_t Counter){
+
+	TIMx->CNT = Counter;
+}
+
+uint32_t TIM_GetCounter(TIM_TypeDef* TIMx){
+
+	return TIMx->CNT;
+}
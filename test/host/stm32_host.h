@@ -0,0 +1,164 @@
+/**
+ * @file stm32_host.h
+ * @brief Host build of mpu6050.c against simulated STM32F303 peripherals
+ *
+ * Force included in front of mpu6050.c with -include. Peripheral pointers are
+ * redirected to register blocks in RAM, the Cortex-M intrinsics become plain
+ * functions and the StdPeriph calls of the driver are implemented in
+ * stm32_host.c. I2C1 is a model of the STM32F3 I2C master with an MPU6050
+ * register file and FIFO as its only slave, DMA1 channel 7 moves I2C1 RXDR
+ * bytes to memory and EXTI line 1 is the MPU6050 INT pin. The I2C1 pins can
+ * be driven as GPIO for bus recovery, with a slave that holds SDA low for
+ * some pulses. The DWT cycle counter runs only once it is enabled.
+ *
+ * Interrupts run only when the test asks for them, so a test decides exactly
+ * what happens between two bytes on the bus.
+ */
+
+#ifndef __STM32_HOST_H
+#define __STM32_HOST_H
+
+#include <stdint.h>
+#include "stm32f30x.h"
+
+/* Simulated core clock */
+#define HOST_CORE_CLOCK_HZ		72000000
+
+/* Peripheral register blocks */
+extern I2C_TypeDef Host_I2C1;
+extern I2C_TypeDef Host_I2C2;
+extern DMA_TypeDef Host_DMA1;
+extern DMA_Channel_TypeDef Host_DMA1_Channel7;
+extern GPIO_TypeDef Host_GPIO[6];
+extern SPI_TypeDef Host_SPI[3];
+extern TIM_TypeDef Host_TIM2;
+extern EXTI_TypeDef Host_EXTI;
+extern SYSCFG_TypeDef Host_SYSCFG;
+extern DWT_Type Host_DWT;
+extern CoreDebug_Type Host_CoreDebug;
+
+#undef I2C1
+#undef I2C2
+#undef DMA1
+#undef DMA1_Channel7
+#undef GPIOA
+#undef GPIOB
+#undef GPIOC
+#undef GPIOD
+#undef GPIOE
+#undef GPIOF
+#undef SPI1
+#undef SPI2
+#undef SPI3
+#undef TIM2
+#undef EXTI
+#undef SYSCFG
+#undef DWT
+#undef CoreDebug
+
+#define I2C1				(&Host_I2C1)
+#define I2C2				(&Host_I2C2)
+#define DMA1				(&Host_DMA1)
+#define DMA1_Channel7		(&Host_DMA1_Channel7)
+#define GPIOA				(&Host_GPIO[0])
+#define GPIOB				(&Host_GPIO[1])
+#define GPIOC				(&Host_GPIO[2])
+#define GPIOD				(&Host_GPIO[3])
+#define GPIOE				(&Host_GPIO[4])
+#define GPIOF				(&Host_GPIO[5])
+#define SPI1				(&Host_SPI[0])
+#define SPI2				(&Host_SPI[1])
+#define SPI3				(&Host_SPI[2])
+#define TIM2				(&Host_TIM2)
+#define EXTI				(&Host_EXTI)
+#define SYSCFG				(&Host_SYSCFG)
+#define DWT					(Host_DWT_Access())
+#define CoreDebug			(&Host_CoreDebug)
+
+/* Every access to DWT lets a few cycles pass, so busy waits on CYCCNT end */
+DWT_Type* Host_DWT_Access(void);
+
+/* Cortex-M intrinsics used by the driver */
+void Host_WFI(void);
+
+#define __WFI()				Host_WFI()
+#define __disable_irq()		((void)0)
+#define __enable_irq()		((void)0)
+#define __get_PRIMASK()		((uint32_t)0)
+#define __set_PRIMASK(x)	((void)(x))
+
+/* Cortex-M4 DSP intrinsics used by mpu6050_convert.c, built with -D__ARM_FEATURE_DSP.
+ * Each one follows the instruction description in the ARMv7-M reference manual. */
+static inline int32_t Host_Sat16(int32_t x){
+
+	if(x > 32767) return 32767;
+	if(x < -32768) return -32768;
+	return x;
+}
+
+static inline uint32_t Host_QSUB16(uint32_t a, uint32_t b){
+
+	int32_t lo = Host_Sat16((int32_t)(int16_t)a - (int16_t)b);
+	int32_t hi = Host_Sat16((int32_t)(int16_t)(a >> 16) - (int16_t)(b >> 16));
+
+	return ((uint32_t)hi << 16) | ((uint32_t)lo & 0xFFFF);
+}
+
+static inline uint32_t Host_SMLAD(uint32_t a, uint32_t b, uint32_t acc){
+
+	return (uint32_t)((int32_t)(int16_t)a * (int16_t)b + (int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16) + (int32_t)acc);
+}
+
+static inline uint32_t Host_SMLADX(uint32_t a, uint32_t b, uint32_t acc){
+
+	return (uint32_t)((int32_t)(int16_t)a * (int16_t)(b >> 16) + (int32_t)(int16_t)(a >> 16) * (int16_t)b + (int32_t)acc);
+}
+
+#undef __SSAT
+#undef __PKHBT
+
+#define __QSUB16			Host_QSUB16
+#define __SMLAD				Host_SMLAD
+#define __SMLADX			Host_SMLADX
+#define __SSAT(x, n)		((uint32_t)Host_Sat16(x))
+#define __PKHBT(lo, hi, sh)	(((uint32_t)(lo) & 0x0000FFFF) | (((uint32_t)(hi) << (sh)) & 0xFFFF0000))
+
+/* Bus activity on I2C1 since the last Host_Reset */
+typedef struct{
+
+	uint32_t starts;			//START and repeated START conditions
+	uint32_t stops;				//STOP conditions, one per transaction
+	uint32_t reads;				//Read phases
+	uint32_t writes;			//Write phases, a register address on its own counts
+	uint32_t bytesRead;
+	uint32_t bytesWritten;		//Register address bytes included
+	uint8_t lastReadReg;		//First register of the last read phase
+	uint16_t lastReadLength;	//Bytes requested by the last read phase
+	uint32_t protocolErrors;	//Data register accessed without TXIS or RXNE, or transfer started on a busy bus
+	uint32_t sclPulses;			//SCL pulses made with the pins as GPIO, SDA released by the master and held by the slave
+	uint32_t gpioStops;			//STOP conditions made with the pins as GPIO
+	uint32_t softwareResets;	//I2C1 software resets
+
+}Host_Bus_Stats;
+
+/* MPU6050 register file behind I2C1, address MPU6050_ADDRESS */
+extern uint8_t Host_Regs[128];
+extern Host_Bus_Stats Host_Bus;
+
+/* Called from Host_WFI, e.g. to deliver an interrupt while the driver sleeps */
+extern void (*Host_Idle_Hook)(void);
+
+void Host_Reset(void);
+void Host_Advance_Us(uint32_t us);
+void Host_Set_Sample(int16_t accelX, int16_t accelY, int16_t accelZ, int16_t temp, int16_t gyroX, int16_t gyroY, int16_t gyroZ);
+uint8_t Host_I2C_Step(void);
+uint32_t Host_I2C_Run(void);
+void Host_DMA_Memory(uint8_t* memory);
+uint16_t Host_DMA_Step(uint16_t bytes);
+void Host_DMA_Error(void);
+void Host_DRDY_Edge(void);
+void Host_Hold_SDA(uint8_t pulses);
+void Host_FIFO_Push(const uint8_t* data, uint16_t length);
+uint16_t Host_FIFO_Count(void);
+
+#endif /* __STM32_HOST_H */
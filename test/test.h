@@ -0,0 +1,34 @@
+/**
+ * @file test.h
+ * @brief Checks for the host tests, a failed check prints its line and the test goes on
+ */
+
+#ifndef __TEST_H
+#define __TEST_H
+
+#include <stdio.h>
+
+static int Test_Checks = 0;
+static int Test_Failures = 0;
+
+#define CHECK(cond)		do{ \
+	Test_Checks++; \
+	if(!(cond)){ \
+		printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		Test_Failures++; \
+	} \
+}while(0)
+
+#define CHECK_EQ(a, b)	do{ \
+	long long test_a = (long long)(a), test_b = (long long)(b); \
+	Test_Checks++; \
+	if(test_a != test_b){ \
+		printf("%s:%d: CHECK_EQ(%s, %s) failed, %lld != %lld\n", __FILE__, __LINE__, #a, #b, test_a, test_b); \
+		Test_Failures++; \
+	} \
+}while(0)
+
+/* Prints the summary, value for main to return */
+#define TEST_RESULT(name)	(printf("%s: %d checks, %d failed\n", name, Test_Checks, Test_Failures), Test_Failures != 0)
+
+#endif /* __TEST_H */
@@ -0,0 +1,196 @@
+/**
+ * @file test_i2c_timing.c
+ * @brief Host test, I2C_TIMINGR values against the reference manual and the bus specification
+ *
+ * Every computed value is decoded and checked with the reference manual
+ * formulas, independently of the search in i2c_timing.c: SCL low and high
+ * periods, SCL frequency not above the requested one, SCLDEL and SDADEL
+ * windows. The reference manual examples for 8 MHz are checked the same way.
+ * They are not reproduced bit for bit, check I2C_Timing_Calc, but the data
+ * setup delay matches them when the same rise times are used.
+ *
+ *	gcc -std=gnu99 -Wall -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest test/test_i2c_timing.c cmsis_lib/source/i2c_timing.c -o test_i2c_timing && ./test_i2c_timing
+ */
+
+#include "i2c_timing.h"
+#include "test.h"
+
+/* Reference manual examples, I2CCLK = 8 MHz */
+#define RM_TIMING_8MHZ_STANDARD		0x10420F13
+#define RM_TIMING_8MHZ_FAST			0x00310309
+
+/* Rounding margin for comparing ns computed in floating point */
+#define EPS							0.001
+
+/* Analog filter delay in ns */
+#define AF_MIN						50.0
+#define AF_MAX						260.0
+
+/* Bus specification limits in ns, tHD;DAT(min) is 0 in every mode */
+typedef struct{
+
+	double freqMin;
+	double vdDatMax;
+	double suDatMin;
+	double lowMin;
+	double highMin;
+
+}Bus_Limits;
+
+static const Bus_Limits Limits_Standard = {80000, 3450, 250, 4700, 4000};
+static const Bus_Limits Limits_Fast = {320000, 900, 100, 1300, 600};
+static const Bus_Limits Limits_Fast_Plus = {800000, 450, 50, 500, 260};
+
+/* TIMINGR decoded to ns */
+typedef struct{
+
+	double tlow;
+	double thigh;
+	double freq;
+	double scldel;
+	double sdadel;
+
+}Decoded;
+
+static const Bus_Limits* Limits(I2C_Speed speed){
+
+	if(speed == I2C_SPEED_STANDARD) return &Limits_Standard;
+	if(speed == I2C_SPEED_FAST) return &Limits_Fast;
+	return &Limits_Fast_Plus;
+}
+
+static Decoded Decode(uint32_t timing, double clockHz, double riseNs, double fallNs){
+
+	Decoded d;
+	double tclk = 1e9 / clockHz;
+	double tpresc = (((timing >> 28) & 0x0F) + 1) * tclk;
+
+	d.tlow = AF_MIN + 2 * tclk + ((timing & 0xFF) + 1) * tpresc;
+	d.thigh = AF_MIN + 2 * tclk + (((timing >> 8) & 0xFF) + 1) * tpresc;
+	d.freq = 1e9 / (fallNs + d.tlow + riseNs + d.thigh);
+	d.scldel = (((timing >> 20) & 0x0F) + 1) * tpresc;
+	d.sdadel = ((timing >> 16) & 0x0F) * tpresc;
+	return d;
+}
+
+/* @brief Check a TIMINGR value with the reference manual formulas
+ * A zero SDADEL is accepted above the data valid limit, it is the shortest
+ * hold time the peripheral can produce.
+ *
+ * @retval 1 if legal
+ */
+static int Legal(uint32_t timing, I2C_Speed speed, double clockHz, double riseNs, double fallNs){
+
+	const Bus_Limits* lim = Limits(speed);
+	Decoded d = Decode(timing, clockHz, riseNs, fallNs);
+	double tclk = 1e9 / clockHz;
+
+	if(d.tlow + EPS < lim->lowMin) return 0;
+	if(d.thigh + EPS < lim->highMin) return 0;
+	if(d.freq > (double)speed * 1.000001 || d.freq < lim->freqMin) return 0;
+	if(d.scldel + EPS < riseNs + lim->suDatMin) return 0;
+	if(d.sdadel + EPS < fallNs - AF_MIN - 3 * tclk) return 0;
+	if(d.sdadel != 0 && d.sdadel > lim->vdDatMax - riseNs - AF_MAX - 4 * tclk + EPS) return 0;
+	return 1;
+}
+
+/* Reference manual examples have legal SCL periods at or below the speed */
+static void Test_RM_Examples(void){
+
+	Decoded d;
+
+	d = Decode(RM_TIMING_8MHZ_STANDARD, 8e6, 1000, 300);
+	CHECK(d.tlow >= Limits_Standard.lowMin && d.thigh >= Limits_Standard.highMin);
+	CHECK(d.freq <= I2C_SPEED_STANDARD && d.freq >= Limits_Standard.freqMin);
+	CHECK(Legal(RM_TIMING_8MHZ_STANDARD, I2C_SPEED_STANDARD, 8e6, 1000, 300));
+
+	/* Fast-mode example exceeds tVD;DAT(max) with SDADEL 1 at 300 ns rise time,
+	 * only its SCL periods are checked */
+	d = Decode(RM_TIMING_8MHZ_FAST, 8e6, 300, 300);
+	CHECK(d.tlow >= Limits_Fast.lowMin && d.thigh >= Limits_Fast.highMin);
+	CHECK(d.freq <= I2C_SPEED_FAST && d.freq >= Limits_Fast.freqMin);
+}
+
+/* With the rise times of the reference manual the data setup delay is the same */
+static void Test_RM_Setup_Delay(void){
+
+	uint32_t timing;
+
+	CHECK_EQ(I2C_Timing_Calc(8000000, I2C_SPEED_STANDARD, 1000, 300, &timing), 0);
+	CHECK(Legal(timing, I2C_SPEED_STANDARD, 8e6, 1000, 300));
+	CHECK(Decode(timing, 8e6, 1000, 300).scldel == Decode(RM_TIMING_8MHZ_STANDARD, 8e6, 1000, 300).scldel);
+
+	CHECK_EQ(I2C_Timing_Calc(8000000, I2C_SPEED_FAST, 300, 300, &timing), 0);
+	CHECK(Legal(timing, I2C_SPEED_FAST, 8e6, 300, 300));
+	CHECK(Decode(timing, 8e6, 300, 300).scldel == Decode(RM_TIMING_8MHZ_FAST, 8e6, 300, 300).scldel);
+}
+
+/* Values for the board rise and fall times, 250 and 100 ns */
+static void Test_Board_Values(void){
+
+	uint32_t timing;
+
+	CHECK_EQ(I2C_Timing_Calc(8000000, I2C_SPEED_STANDARD, 250, 100, &timing), 0);
+	CHECK_EQ(timing, 0x00302423);
+	CHECK_EQ(I2C_Timing_Calc(8000000, I2C_SPEED_FAST, 250, 100, &timing), 0);
+	CHECK_EQ(timing, 0x00200407);
+	CHECK_EQ(I2C_Timing_Calc(72000000, I2C_SPEED_STANDARD, 250, 100, &timing), 0);
+	CHECK_EQ(timing, 0x20B1746E);
+	CHECK_EQ(I2C_Timing_Calc(72000000, I2C_SPEED_FAST, 250, 100, &timing), 0);
+	CHECK_EQ(timing, 0x10C11A2C);
+}
+
+/* Every value found is legal. Fast-mode Plus stays well below 1 MHz, the
+ * minimum low and high periods plus rise and fall times are close to 1 us */
+static void Test_Sweep(void){
+
+	static const uint32_t rise[] = {20, 120, 250, 300, 1000};
+	static const uint32_t fall[] = {10, 10, 100, 300, 300};
+	static const I2C_Speed speeds[] = {I2C_SPEED_STANDARD, I2C_SPEED_FAST, I2C_SPEED_FAST_PLUS};
+	uint32_t clockHz, timing;
+	uint8_t s, r;
+
+	for(clockHz = 8000000; clockHz <= 72000000; clockHz += 4000000){
+		for(s = 0; s < 3; s++){
+			for(r = 0; r < 5; r++){
+				if(I2C_Timing_Calc(clockHz, speeds[s], rise[r], fall[r], &timing) != 0) continue;
+				CHECK(Legal(timing, speeds[s], clockHz, rise[r], fall[r]));
+				if(speeds[s] != I2C_SPEED_FAST_PLUS) CHECK(Decode(timing, clockHz, rise[r], fall[r]).freq >= 0.95 * speeds[s]);
+			}
+			/* Standard and Fast-mode always have a setting with board rise times */
+			if(speeds[s] != I2C_SPEED_FAST_PLUS) CHECK_EQ(I2C_Timing_Calc(clockHz, speeds[s], 250, 100, &timing), 0);
+		}
+	}
+}
+
+/* Fast-mode Plus needs short rise times, the fallback is reported */
+static void Test_Fast_Plus(void){
+
+	uint32_t timing;
+
+	CHECK_EQ(I2C_Timing_Calc(64000000, I2C_SPEED_FAST_PLUS, 250, 100, &timing), 1);
+	CHECK_EQ(I2C_Timing_Calc(72000000, I2C_SPEED_FAST_PLUS, 250, 100, &timing), 1);
+	CHECK_EQ(I2C_Timing_Calc(72000000, I2C_SPEED_FAST_PLUS, 120, 10, &timing), 0);
+	CHECK_EQ(timing, 0x00C01022);
+	CHECK(Legal(timing, I2C_SPEED_FAST_PLUS, 72e6, 120, 10));
+
+	CHECK_EQ(I2C_Timing_Select(72000000, I2C_SPEED_FAST_PLUS, 250, 100, &timing), I2C_SPEED_FAST);
+	CHECK_EQ(timing, 0x10C11A2C);
+	CHECK_EQ(I2C_Timing_Select(72000000, I2C_SPEED_FAST_PLUS, 120, 10, &timing), I2C_SPEED_FAST_PLUS);
+
+	/* No setting at all, slowest value */
+	CHECK_EQ(I2C_Timing_Select(0, I2C_SPEED_FAST, 250, 100, &timing), I2C_SPEED_STANDARD);
+	CHECK_EQ(timing, I2C_TIMING_SLOWEST);
+}
+
+int main(void){
+
+	Test_RM_Examples();
+	Test_RM_Setup_Delay();
+	Test_Board_Values();
+	Test_Sweep();
+	Test_Fast_Plus();
+
+	return TEST_RESULT("test_i2c_timing");
+}
@@ -0,0 +1,264 @@
+/**
+ * @file test_mpu6050_async.c
+ * @brief Host test, interrupt driven asynchronous engine on the simulated I2C1
+ *
+ * A callback that queues the next request must not start a second transfer on
+ * the bus, requests complete in the order they were queued, a NACK and a bus
+ * error complete the head request with an error and the queue goes on. A
+ * request that never completes is aborted after MPU6050_TIMEOUT_US, the bus
+ * is recovered and data ready reads start again.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_async.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_async && ./test_mpu6050_async
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+#define CHAIN_READS			4
+
+void I2C1_ER_IRQHandler(void);
+
+static MPU6050_Device Dev;
+static MPU6050_Device Absent;
+
+static uint8_t Buffer[CHAIN_READS][MPU6050_SAMPLE_LENGTH];
+static MPU6050_errorstatus Status[CHAIN_READS + 2];
+static uint8_t Done;
+static uint8_t Chained;
+static char Order[CHAIN_READS + 2];
+
+/* @brief Sensor initialized with the asynchronous engine, counters cleared */
+static void Setup(void){
+
+	Host_Reset();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	MPU6050_Device_Init(&Absent, &MPU6050_Bus1, MPU6050_ADDRESS_AD0_HIGH);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	MPU6050_Async_Config();
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	memset(Buffer, 0, sizeof(Buffer));
+	memset(Order, 0, sizeof(Order));
+	Done = 0;
+	Chained = 0;
+}
+
+/* @brief Queues the next sample read until CHAIN_READS are done */
+static void Chain_Done(MPU6050_errorstatus status){
+
+	Status[Done] = status;
+	Order[Done++] = 'c';
+	if(++Chained < CHAIN_READS){
+		CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[Chained], MPU6050_SAMPLE_LENGTH, Chain_Done), MPU6050_NO_ERROR);
+	}
+}
+
+static void Other_Done(MPU6050_errorstatus status){
+
+	Status[Done] = status;
+	Order[Done++] = 'o';
+}
+
+/* Reads queued from the callback run one after another, one START pair each */
+static void Test_Chained_Reads(void){
+
+	uint8_t i;
+
+	Setup();
+	Host_Set_Sample(1, 2, 3, 4, 5, 6, 7);
+
+	CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[0], MPU6050_SAMPLE_LENGTH, Chain_Done), MPU6050_NO_ERROR);
+	Host_I2C_Run();
+
+	CHECK_EQ(Done, CHAIN_READS);
+	CHECK_EQ(MPU6050_Async_Pending(), 0);
+	for(i = 0; i < CHAIN_READS; i++){
+		CHECK_EQ(Status[i], MPU6050_NO_ERROR);
+		CHECK_EQ(Buffer[i][1], 1);
+		CHECK_EQ(Buffer[i][13], 7);
+	}
+
+	/* START for the register address and repeated START for the data, per read */
+	CHECK_EQ(Host_Bus.starts, 2 * CHAIN_READS);
+	CHECK_EQ(Host_Bus.stops, CHAIN_READS);
+	CHECK_EQ(Host_Bus.reads, CHAIN_READS);
+	CHECK_EQ(Host_Bus.bytesRead, CHAIN_READS * MPU6050_SAMPLE_LENGTH);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Request queued by a callback runs after the ones queued before it */
+static void Test_Callback_Queues_Behind(void){
+
+	Setup();
+
+	CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[0], MPU6050_SAMPLE_LENGTH, Chain_Done), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Read_Async(&Dev, WHO_AM_I, Buffer[3], 1, Other_Done), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Async_Pending(), 2);
+	Host_I2C_Run();
+
+	CHECK_EQ(Done, CHAIN_READS + 1);
+	CHECK(strcmp(Order, "coccc") == 0);
+	CHECK_EQ(Host_Bus.starts, 2 * (CHAIN_READS + 1));
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* @brief Completes with a NACK and queues a sample read of the real sensor */
+static void Nack_Done(MPU6050_errorstatus status){
+
+	Status[Done++] = status;
+	CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[1], MPU6050_SAMPLE_LENGTH, Other_Done), MPU6050_NO_ERROR);
+}
+
+/* Absent slave completes with MPU6050_I2C_NACK, a read and a write */
+static void Test_Nack(void){
+
+	uint8_t value = 0x5A;
+
+	Setup();
+	Host_Set_Sample(100, 0, 0, 0, 0, 0, 0);
+
+	CHECK_EQ(MPU6050_Read_Async(&Absent, WHO_AM_I, Buffer[0], 1, Nack_Done), MPU6050_NO_ERROR);
+	Host_I2C_Run();
+
+	CHECK_EQ(Done, 2);
+	CHECK_EQ(Status[0], MPU6050_I2C_NACK);
+	CHECK_EQ(Status[1], MPU6050_NO_ERROR);
+	CHECK_EQ(Buffer[1][1], 100);
+	CHECK_EQ(MPU6050_Async_Pending(), 0);
+
+	/* Write is in auto end mode, hardware sends the STOP */
+	CHECK_EQ(MPU6050_Write_Async(&Absent, SMPLRT_DIV, &value, 1, Other_Done), MPU6050_NO_ERROR);
+	Host_I2C_Run();
+	CHECK_EQ(Done, 3);
+	CHECK_EQ(Status[2], MPU6050_I2C_NACK);
+	CHECK(Host_Regs[SMPLRT_DIV] != 0x5A);
+
+	CHECK_EQ(Host_Bus.starts, 4);
+	CHECK_EQ(Host_Bus.stops, 3);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Bus error in the middle of a read completes it with MPU6050_I2C_ERROR, the next request runs */
+static void Test_Bus_Error(void){
+
+	uint8_t i;
+
+	Setup();
+	Host_Set_Sample(200, 0, 0, 0, 0, 0, 0);
+
+	CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[0], MPU6050_SAMPLE_LENGTH, Other_Done), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[1], MPU6050_SAMPLE_LENGTH, Other_Done), MPU6050_NO_ERROR);
+
+	/* Register address, repeated START and a few data bytes */
+	for(i = 0; i < 5; i++) CHECK(Host_I2C_Step());
+
+	Host_I2C1.ISR |= I2C_ISR_BERR;
+	I2C1_ER_IRQHandler();
+	CHECK_EQ(Done, 1);
+	CHECK_EQ(Status[0], MPU6050_I2C_ERROR);
+	CHECK_EQ(MPU6050_Async_Pending(), 1);
+
+	Host_I2C_Run();
+	CHECK_EQ(Done, 2);
+	CHECK_EQ(Status[1], MPU6050_NO_ERROR);
+	CHECK_EQ(Buffer[1][1], 200);
+	CHECK_EQ(MPU6050_Async_Pending(), 0);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+
+	/* Error interrupt with the queue empty changes nothing */
+	Host_I2C1.ISR |= I2C_ISR_ARLO;
+	I2C1_ER_IRQHandler();
+	CHECK_EQ(Done, 2);
+}
+
+/* Request without interrupts is aborted after MPU6050_TIMEOUT_US and the bus recovered */
+static void Test_Deadline(void){
+
+	uint8_t i;
+
+	Setup();
+	Host_Set_Sample(300, 0, 0, 0, 0, 0, 0);
+
+	CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[0], MPU6050_SAMPLE_LENGTH, Other_Done), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Read_Async(&Dev, ACCEL_XOUT_H, Buffer[1], MPU6050_SAMPLE_LENGTH, Other_Done), MPU6050_NO_ERROR);
+	for(i = 0; i < 3; i++) CHECK(Host_I2C_Step());
+
+	/* Interrupts stop coming, the slave holds the bus */
+	Host_Advance_Us(MPU6050_TIMEOUT_US / 2);
+	CHECK_EQ(MPU6050_Async_Pending(), 2);
+	CHECK_EQ(Done, 0);
+
+	Host_Advance_Us(MPU6050_TIMEOUT_US);
+	CHECK_EQ(MPU6050_Async_Pending(), 1);
+	CHECK_EQ(Done, 1);
+	CHECK_EQ(Status[0], MPU6050_I2C_ERROR);
+	CHECK_EQ(Dev.stats.recoveries, 1);
+
+	/* Next request was started on the recovered bus */
+	Host_I2C_Run();
+	CHECK_EQ(Done, 2);
+	CHECK_EQ(Status[1], MPU6050_NO_ERROR);
+	CHECK_EQ(Buffer[1][1], 300 & 0xFF);
+	CHECK_EQ(MPU6050_Async_Pending(), 0);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Stuck data ready read is aborted by the next edge after the deadline, reads start again */
+static void Test_DRDY_Deadline(void){
+
+	MPU6050_rawData data;
+	uint8_t n;
+
+	Setup();
+	CHECK_EQ(MPU6050_DRDY_Config(&Dev), MPU6050_NO_ERROR);
+
+	Host_Set_Sample(10, 0, 0, 0, 0, 0, 0);
+	Host_DRDY_Edge();
+	CHECK(Host_I2C_Step());
+
+	/* Edges during the deadline are missed */
+	for(n = 0; n < 5; n++){
+		Host_Advance_Us(1000);
+		Host_DRDY_Edge();
+	}
+	CHECK_EQ(MPU6050_DRDY_Missed(), 5);
+
+	Host_Advance_Us(MPU6050_TIMEOUT_US);
+	Host_Set_Sample(20, 0, 0, 0, 0, 0, 0);
+	Host_DRDY_Edge();
+	CHECK_EQ(Dev.stats.recoveries, 1);
+
+	/* Aborted read counts as missed, the edge started a new one */
+	CHECK_EQ(MPU6050_DRDY_Missed(), 6);
+	CHECK_EQ(MPU6050_Async_Pending(), 1);
+	Host_I2C_Run();
+	CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 1);
+	CHECK_EQ(data.accelX, 20);
+
+	/* And later edges are read again */
+	for(n = 0; n < 3; n++){
+		Host_Set_Sample(30 + n, 0, 0, 0, 0, 0, 0);
+		Host_Advance_Us(1000);
+		Host_DRDY_Edge();
+		Host_I2C_Run();
+		CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 1);
+		CHECK_EQ(data.accelX, 30 + n);
+	}
+	CHECK_EQ(MPU6050_DRDY_Missed(), 6);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+int main(void){
+
+	Test_Chained_Reads();
+	Test_Callback_Queues_Behind();
+	Test_Nack();
+	Test_Bus_Error();
+	Test_Deadline();
+	Test_DRDY_Deadline();
+
+	return TEST_RESULT("test_mpu6050_async");
+}
@@ -0,0 +1,129 @@
+/**
+ * @file test_mpu6050_burst.c
+ * @brief Host test, a sample read is one burst transaction on the bus
+ *
+ * MPU6050_Get_All_Data_Raw must read ACCEL_XOUT_H..GYRO_ZOUT_L in one
+ * transaction, register address write, repeated START, 14 bytes and one STOP,
+ * so that all values come from the same sample instant.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_burst.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_burst && ./test_mpu6050_burst
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+/* @brief Sensor initialized, bus counters cleared */
+static void Setup(MPU6050_Device* dev){
+
+	Host_Reset();
+	MPU6050_Device_Init(dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(dev), MPU6050_NO_ERROR);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	dev->stats.transfers = 0;
+}
+
+static void Test_Get_All_Data_Raw(void){
+
+	MPU6050_Device dev;
+	MPU6050_rawData data;
+
+	Setup(&dev);
+	Host_Set_Sample(-16384, 1234, 32767, -3000, -32768, 250, -1);
+	Host_Advance_Us(500);
+
+	CHECK_EQ(MPU6050_Get_All_Data_Raw(&dev, &data), MPU6050_NO_ERROR);
+
+	/* One transaction: address phase, repeated START as read, one STOP */
+	CHECK_EQ(Host_Bus.stops, 1);
+	CHECK_EQ(Host_Bus.starts, 2);
+	CHECK_EQ(Host_Bus.writes, 1);
+	CHECK_EQ(Host_Bus.reads, 1);
+	CHECK_EQ(Host_Bus.bytesWritten, 1);
+	CHECK_EQ(Host_Bus.lastReadReg, ACCEL_XOUT_H);
+	CHECK_EQ(Host_Bus.lastReadLength, MPU6050_SAMPLE_LENGTH);
+	CHECK_EQ(Host_Bus.bytesRead, MPU6050_SAMPLE_LENGTH);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+	CHECK_EQ(dev.stats.transfers, 1);
+
+	CHECK_EQ(data.accelX, -16384);
+	CHECK_EQ(data.accelY, 1234);
+	CHECK_EQ(data.accelZ, 32767);
+	CHECK_EQ(data.temp, -3000);
+	CHECK_EQ(data.gyroX, -32768);
+	CHECK_EQ(data.gyroY, 250);
+	CHECK_EQ(data.gyroZ, -1);
+
+	/* First sample after initialization is timed */
+	CHECK(dev.stats.firstSampleUs >= 500);
+}
+
+static void Test_Repeated_Reads(void){
+
+	MPU6050_Device dev;
+	MPU6050_rawData data;
+	int16_t i;
+
+	Setup(&dev);
+
+	for(i = 0; i < 50; i++){
+		Host_Set_Sample(i, -i, 2 * i, 0, 3 * i, -3 * i, i);
+		CHECK_EQ(MPU6050_Get_All_Data_Raw(&dev, &data), MPU6050_NO_ERROR);
+		CHECK_EQ(data.accelX, i);
+		CHECK_EQ(data.gyroY, -3 * i);
+	}
+
+	CHECK_EQ(Host_Bus.stops, 50);
+	CHECK_EQ(Host_Bus.reads, 50);
+	CHECK_EQ(Host_Bus.bytesRead, 50 * MPU6050_SAMPLE_LENGTH);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Reads of the configuration registers are served by the shadow, not the bus */
+static void Test_Shadowed_Config(void){
+
+	MPU6050_Device dev;
+
+	Setup(&dev);
+
+	CHECK_EQ(MPU6050_Gyro_Get_Range(&dev), MPU6050_GYRO_250);
+	CHECK_EQ(MPU6050_Accel_Get_Range(&dev), MPU6050_ACCEL_2g);
+	CHECK_EQ(Host_Bus.stops, 0);
+}
+
+/* Batch reads one burst per device, a failed device does not stop the others */
+static void Test_Read_Batch(void){
+
+	MPU6050_Device dev, absent;
+	MPU6050_Device* devs[MPU6050_BATCH_MAX + 1] = {&dev, &absent, &dev};
+	MPU6050_rawData samples[MPU6050_BATCH_MAX + 1];
+
+	Setup(&dev);
+	MPU6050_Device_Init(&absent, &MPU6050_Bus1, MPU6050_ADDRESS_AD0_HIGH);
+	memset(samples, 0, sizeof(samples));
+	Host_Set_Sample(7, 0, 0, 0, 0, 0, -7);
+
+	CHECK_EQ(MPU6050_Read_Batch(devs, 3, samples), MPU6050_I2C_ERROR);
+	CHECK_EQ(samples[0].accelX, 7);
+	CHECK_EQ(samples[1].accelX, 0);
+	CHECK_EQ(samples[2].gyroZ, -7);
+
+	/* Invalid device count is refused before the bus is used */
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	CHECK_EQ(MPU6050_Read_Batch(devs, 0, samples), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(MPU6050_Read_Batch(devs, MPU6050_BATCH_MAX + 1, samples), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(Host_Bus.starts, 0);
+}
+
+int main(void){
+
+	Test_Get_All_Data_Raw();
+	Test_Repeated_Reads();
+	Test_Shadowed_Config();
+	Test_Read_Batch();
+
+	return TEST_RESULT("test_mpu6050_burst");
+}
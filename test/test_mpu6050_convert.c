@@ -0,0 +1,189 @@
+/**
+ * @file test_mpu6050_convert.c
+ * @brief Host test, SIMD batch conversion is bit-exact against the plain C reference
+ *
+ * mpu6050_convert.c is built with __ARM_FEATURE_DSP, so the SIMD kernels run on
+ * the DSP intrinsics of stm32_host.h. Results are compared value by value with
+ * MPU6050_Convert_Batch_Ref and with the formula in mpu6050_convert.h, for
+ * random data, saturating offsets and scales, every shift, odd counts,
+ * unaligned arrays and in-place conversion.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -D__ARM_FEATURE_DSP -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot \
+ *		-Icmsis_lib/include -Itest/host -include stm32_host.h test/test_mpu6050_convert.c \
+ *		cmsis_lib/source/mpu6050_convert.c -o test_mpu6050_convert && ./test_mpu6050_convert
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "mpu6050_convert.h"
+#include "stm32_host.h"
+#include "test.h"
+
+#ifndef __ARM_FEATURE_DSP
+#error "build with -D__ARM_FEATURE_DSP, otherwise only the reference is tested"
+#endif
+
+#define TRIPLETS			33
+
+static uint32_t Seed = 12345;
+
+static int16_t Random16(void){
+
+	Seed = Seed * 1664525 + 1013904223;
+	return (int16_t)(Seed >> 16);
+}
+
+/* @brief Formula of mpu6050_convert.h in 64-bit, with both saturations */
+static int16_t Expected(int16_t raw, int16_t offset, int16_t scale, uint8_t shift){
+
+	int64_t d = (int64_t)raw - offset;
+	int64_t y;
+
+	if(d > 32767) d = 32767;
+	if(d < -32768) d = -32768;
+	y = (d * scale + ((int64_t)1 << (shift - 1))) >> shift;
+	if(y > 32767) y = 32767;
+	if(y < -32768) y = -32768;
+	return (int16_t)y;
+}
+
+/* @brief Batch, reference and formula agree for count triplets, also in place */
+static void Check_Batch(const MPU6050_Convert_Params* params, const int16_t* raw, uint16_t count){
+
+	static int16_t simd[TRIPLETS * 3] __attribute__((aligned(4)));
+	static int16_t ref[TRIPLETS * 3] __attribute__((aligned(4)));
+	static int16_t inPlace[TRIPLETS * 3] __attribute__((aligned(4)));
+	uint32_t i;
+	int mismatches = 0;
+
+	MPU6050_Convert_Batch(params, raw, simd, count);
+	MPU6050_Convert_Batch_Ref(params, raw, ref, count);
+	memcpy(inPlace, raw, (uint32_t)count * 3 * sizeof(int16_t));
+	MPU6050_Convert_Batch(params, inPlace, inPlace, count);
+
+	for(i = 0; i < (uint32_t)count * 3; i++){
+		int16_t e = Expected(raw[i], params->offset[i % 3], params->scale[i % 3], params->shift);
+
+		if(simd[i] != e || ref[i] != e || inPlace[i] != e){
+			if(mismatches++ == 0){
+				printf("value %u: raw %d offset %d scale %d shift %u, simd %d ref %d expected %d\n", i, raw[i],
+					   params->offset[i % 3], params->scale[i % 3], params->shift, simd[i], ref[i], e);
+			}
+		}
+	}
+	CHECK_EQ(mismatches, 0);
+}
+
+/* @brief Channel conversion and formula agree, out at a given element offset */
+static void Check_Channel(int16_t offset, int16_t scale, uint8_t shift, const int16_t* raw, uint16_t count, uint8_t outOffset){
+
+	static int16_t out[TRIPLETS * 3 + 2] __attribute__((aligned(4)));
+	uint32_t i;
+	int mismatches = 0;
+
+	MPU6050_Convert_Channel(offset, scale, shift, raw, out + outOffset, count);
+	for(i = 0; i < count; i++){
+		if(out[outOffset + i] != Expected(raw[i], offset, scale, shift)) mismatches++;
+	}
+	CHECK_EQ(mismatches, 0);
+}
+
+static void Test_Random(void){
+
+	static int16_t raw[TRIPLETS * 3] __attribute__((aligned(4)));
+	MPU6050_Convert_Params params;
+	uint32_t i;
+	uint8_t shift, k;
+	uint16_t count;
+
+	for(shift = 1; shift <= 16; shift++){
+		for(i = 0; i < 20; i++){
+			for(k = 0; k < 3; k++){
+				params.offset[k] = Random16();
+				params.scale[k] = Random16();
+			}
+			params.shift = shift;
+			for(k = 0; k < TRIPLETS * 3; k++) raw[k] = Random16();
+
+			/* Even and odd counts, the odd triplet takes the scalar tail */
+			for(count = 0; count <= TRIPLETS; count += 3) Check_Batch(&params, raw, count);
+			Check_Batch(&params, raw, TRIPLETS);
+		}
+	}
+}
+
+/* Offset subtraction and result at both ends of the int16 range */
+static void Test_Saturation(void){
+
+	static const int16_t extremes[] = {-32768, -32767, -16384, -1, 0, 1, 16383, 32766, 32767};
+	static int16_t raw[TRIPLETS * 3] __attribute__((aligned(4)));
+	MPU6050_Convert_Params params;
+	uint8_t r, o, s, k;
+
+	for(k = 0; k < TRIPLETS * 3; k++) raw[k] = extremes[k % 9];
+
+	for(o = 0; o < 9; o++){
+		for(s = 0; s < 9; s++){
+			for(r = 1; r <= 16; r += 5){
+				for(k = 0; k < 3; k++){
+					params.offset[k] = extremes[(o + k) % 9];
+					params.scale[k] = extremes[(s + 2 * k) % 9];
+				}
+				params.shift = r;
+				Check_Batch(&params, raw, TRIPLETS);
+				Check_Batch(&params, raw, TRIPLETS - 1);
+			}
+		}
+	}
+
+	/* -32768 - 32767 saturates in QSUB16, the product of the saturated difference then saturates again */
+	params.offset[0] = 32767;
+	params.offset[1] = -32768;
+	params.offset[2] = 1;
+	params.scale[0] = params.scale[1] = params.scale[2] = 32767;
+	params.shift = 1;
+	raw[0] = raw[3] = -32768;
+	raw[1] = raw[4] = 32767;
+	raw[2] = raw[5] = -32768;
+	Check_Batch(&params, raw, 2);
+}
+
+/* Block channels in place, unaligned arrays through the scalar path */
+static void Test_Channel(void){
+
+	static MPU6050_Block block;
+	static int16_t raw[TRIPLETS * 3 + 1] __attribute__((aligned(4)));
+	int16_t before[MPU6050_BLOCK_SIZE];
+	uint32_t i;
+	uint16_t count;
+	int mismatches = 0;
+
+	for(i = 0; i < TRIPLETS * 3 + 1; i++) raw[i] = Random16();
+	raw[0] = -32768;
+	raw[1] = 32767;
+
+	for(count = 0; count <= TRIPLETS; count++){
+		Check_Channel(-1000, 16384, 14, raw, count, 0);
+		Check_Channel(32767, 32767, 1, raw, count, 0);
+		Check_Channel(-32768, -32768, 16, raw + 1, count, 0);
+		Check_Channel(250, -12000, 15, raw, count, 1);
+	}
+
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++) block.gyroY[i] = Random16();
+	block.gyroY[3] = -32768;
+	memcpy(before, block.gyroY, sizeof(before));
+	MPU6050_Convert_Channel(-3000, 31000, 15, block.gyroY, block.gyroY, MPU6050_BLOCK_SIZE);
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++){
+		if(block.gyroY[i] != Expected(before[i], -3000, 31000, 15)) mismatches++;
+	}
+	CHECK_EQ(mismatches, 0);
+}
+
+int main(void){
+
+	Test_Random();
+	Test_Saturation();
+	Test_Channel();
+
+	return TEST_RESULT("test_mpu6050_convert");
+}
@@ -0,0 +1,209 @@
+/**
+ * @file test_mpu6050_dma.c
+ * @brief Host test, DMA reads on the simulated I2C1 and DMA1 channel 7 registers
+ *
+ * Checks the transfer count programmed into CNDTR and NBYTES, that completion
+ * is reported once and only after the last byte, that the channel and the I2C
+ * DMA request are off before the callback runs, and that reads started from
+ * the callback complete in order.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_dma.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_dma && ./test_mpu6050_dma
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+/* Completions seen by the callbacks, in order */
+static uint8_t Done_Order[8];
+static MPU6050_errorstatus Done_Status[8];
+static uint8_t Done_Count;
+static uint8_t Done_Busy;			//MPU6050_DMA_Busy() inside the last callback
+static uint32_t Done_Channel;		//CCR inside the last callback
+static uint32_t Done_I2C;			//I2C1 CR1 inside the last callback
+
+static MPU6050_Device Dev;
+static uint8_t Buffers[3][MPU6050_SAMPLE_LENGTH];
+
+static void Record(uint8_t id, MPU6050_errorstatus status){
+
+	Done_Order[Done_Count] = id;
+	Done_Status[Done_Count] = status;
+	Done_Count++;
+	Done_Busy = MPU6050_DMA_Busy();
+	Done_Channel = Host_DMA1_Channel7.CCR;
+	Done_I2C = Host_I2C1.CR1;
+}
+
+static void Done_C(MPU6050_errorstatus status){
+
+	Record(2, status);
+}
+
+/* Second read of the chain, gyro registers */
+static void Done_B(MPU6050_errorstatus status){
+
+	Record(1, status);
+	Host_DMA_Memory(Buffers[2]);
+	CHECK_EQ(MPU6050_Read_DMA(&Dev, GYRO_XOUT_H, Buffers[2], 6, Done_C), MPU6050_NO_ERROR);
+}
+
+/* First read of the chain, accelerometer registers */
+static void Done_A(MPU6050_errorstatus status){
+
+	Record(0, status);
+	Host_DMA_Memory(Buffers[1]);
+	CHECK_EQ(MPU6050_Read_DMA(&Dev, TEMP_OUT_H, Buffers[1], 2, Done_B), MPU6050_NO_ERROR);
+}
+
+static void Done_Single(MPU6050_errorstatus status){
+
+	Record(0, status);
+}
+
+/* @brief Sensor initialized and DMA set up, counters cleared */
+static void Setup(void){
+
+	Host_Reset();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	MPU6050_DMA_Config();
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	memset(Buffers, 0, sizeof(Buffers));
+	Done_Count = 0;
+}
+
+static void Test_Single_Read(void){
+
+	uint8_t i;
+
+	Setup();
+	Host_Set_Sample(100, -200, 16384, 512, -5, 6, -7);
+
+	/* Channel is peripheral to memory with both interrupts */
+	CHECK(!(Host_DMA1_Channel7.CCR & DMA_CCR_EN));
+	CHECK(Host_DMA1_Channel7.CCR & DMA_IT_TC);
+	CHECK(Host_DMA1_Channel7.CCR & DMA_IT_TE);
+	CHECK(Host_DMA1_Channel7.CCR & DMA_MemoryInc_Enable);
+	CHECK_EQ(Host_DMA1_Channel7.CCR & DMA_DIR_PeripheralDST, DMA_DIR_PeripheralSRC);
+
+	Host_DMA_Memory(Buffers[0]);
+	CHECK_EQ(MPU6050_Read_DMA(&Dev, ACCEL_XOUT_H, Buffers[0], MPU6050_SAMPLE_LENGTH, Done_Single), MPU6050_NO_ERROR);
+
+	/* Register address sent in blocking mode, data phase handed to DMA */
+	CHECK(MPU6050_DMA_Busy());
+	CHECK(Host_DMA1_Channel7.CCR & DMA_CCR_EN);
+	CHECK(Host_I2C1.CR1 & I2C_CR1_RXDMAEN);
+	CHECK_EQ(Host_DMA1_Channel7.CNDTR, MPU6050_SAMPLE_LENGTH);
+	CHECK_EQ((Host_I2C1.CR2 & I2C_CR2_NBYTES) >> 16, MPU6050_SAMPLE_LENGTH);
+	CHECK(Host_I2C1.CR2 & I2C_CR2_AUTOEND);
+	CHECK_EQ(Host_Bus.reads, 1);
+	CHECK_EQ(Host_Bus.lastReadReg, ACCEL_XOUT_H);
+	CHECK_EQ(Host_Bus.bytesRead, 0);
+
+	/* A second read is refused while the first one runs */
+	CHECK_EQ(MPU6050_Read_DMA(&Dev, ACCEL_XOUT_H, Buffers[1], 6, Done_Single), MPU6050_I2C_ERROR);
+	CHECK_EQ(Host_Bus.starts, 2);
+
+	/* Nothing is reported before the last byte */
+	for(i = 0; i < MPU6050_SAMPLE_LENGTH - 1; i++){
+		CHECK_EQ(Host_DMA_Step(1), 1);
+		CHECK_EQ(Done_Count, 0);
+		CHECK(MPU6050_DMA_Busy());
+	}
+	CHECK_EQ(Host_DMA1_Channel7.CNDTR, 1);
+
+	CHECK_EQ(Host_DMA_Step(1), 1);
+	CHECK_EQ(Done_Count, 1);
+	CHECK_EQ(Done_Status[0], MPU6050_NO_ERROR);
+	CHECK(!Done_Busy);
+	CHECK(!(Done_Channel & DMA_CCR_EN));
+	CHECK(!(Done_I2C & I2C_CR1_RXDMAEN));
+	CHECK_EQ(MPU6050_DMA_Status(), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_DMA1.ISR & (DMA1_FLAG_GL7 | DMA1_FLAG_TC7), 0);
+
+	/* One transaction with exactly the requested bytes */
+	CHECK_EQ(Host_Bus.stops, 1);
+	CHECK_EQ(Host_Bus.bytesRead, MPU6050_SAMPLE_LENGTH);
+	CHECK_EQ(Host_DMA_Step(1), 0);
+	CHECK_EQ(Done_Count, 1);
+	CHECK(memcmp(Buffers[0], &Host_Regs[ACCEL_XOUT_H], MPU6050_SAMPLE_LENGTH) == 0);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+
+	/* Blocking transfers work again after the DMA read */
+	{
+		MPU6050_rawData data;
+
+		CHECK_EQ(MPU6050_Get_All_Data_Raw(&Dev, &data), MPU6050_NO_ERROR);
+		CHECK_EQ(data.accelZ, 16384);
+		CHECK_EQ(Host_Bus.protocolErrors, 0);
+	}
+}
+
+static void Test_Chained_Reads(void){
+
+	Setup();
+	Host_Set_Sample(1, 2, 3, 4, 5, 6, 7);
+
+	Host_DMA_Memory(Buffers[0]);
+	CHECK_EQ(MPU6050_Read_DMA(&Dev, ACCEL_XOUT_H, Buffers[0], 6, Done_A), MPU6050_NO_ERROR);
+
+	/* Each step finishes one read, its callback starts the next */
+	CHECK_EQ(Host_DMA_Step(MPU6050_SAMPLE_LENGTH), 6);
+	CHECK_EQ(Done_Count, 1);
+	CHECK_EQ(Host_DMA1_Channel7.CNDTR, 2);
+	CHECK(MPU6050_DMA_Busy());
+
+	CHECK_EQ(Host_DMA_Step(MPU6050_SAMPLE_LENGTH), 2);
+	CHECK_EQ(Done_Count, 2);
+	CHECK_EQ(Host_DMA1_Channel7.CNDTR, 6);
+
+	CHECK_EQ(Host_DMA_Step(MPU6050_SAMPLE_LENGTH), 6);
+	CHECK_EQ(Done_Count, 3);
+	CHECK(!MPU6050_DMA_Busy());
+
+	CHECK_EQ(Done_Order[0], 0);
+	CHECK_EQ(Done_Order[1], 1);
+	CHECK_EQ(Done_Order[2], 2);
+	CHECK_EQ(Done_Status[0], MPU6050_NO_ERROR);
+	CHECK_EQ(Done_Status[1], MPU6050_NO_ERROR);
+	CHECK_EQ(Done_Status[2], MPU6050_NO_ERROR);
+
+	CHECK(memcmp(Buffers[0], &Host_Regs[ACCEL_XOUT_H], 6) == 0);
+	CHECK(memcmp(Buffers[1], &Host_Regs[TEMP_OUT_H], 2) == 0);
+	CHECK(memcmp(Buffers[2], &Host_Regs[GYRO_XOUT_H], 6) == 0);
+
+	CHECK_EQ(Host_Bus.reads, 3);
+	CHECK_EQ(Host_Bus.stops, 3);
+	CHECK_EQ(Host_Bus.bytesRead, 14);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+static void Test_Transfer_Error(void){
+
+	Setup();
+
+	Host_DMA_Memory(Buffers[0]);
+	CHECK_EQ(MPU6050_Read_DMA(&Dev, ACCEL_XOUT_H, Buffers[0], MPU6050_SAMPLE_LENGTH, Done_Single), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_DMA_Step(4), 4);
+
+	Host_DMA_Error();
+	CHECK_EQ(Done_Count, 1);
+	CHECK_EQ(Done_Status[0], MPU6050_I2C_RX_ERROR);
+	CHECK_EQ(MPU6050_DMA_Status(), MPU6050_I2C_RX_ERROR);
+	CHECK(!MPU6050_DMA_Busy());
+	CHECK(!(Host_I2C1.CR1 & I2C_CR1_RXDMAEN));
+	CHECK_EQ(Host_DMA1.ISR & (DMA1_FLAG_GL7 | DMA1_FLAG_TE7), 0);
+}
+
+int main(void){
+
+	Test_Single_Read();
+	Test_Chained_Reads();
+	Test_Transfer_Error();
+
+	return TEST_RESULT("test_mpu6050_dma");
+}
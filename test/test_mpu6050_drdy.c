@@ -0,0 +1,166 @@
+/**
+ * @file test_mpu6050_drdy.c
+ * @brief Host test, data ready edges on the simulated EXTI line 1
+ *
+ * Every rising edge of INT must start exactly one burst read of the sample and
+ * give exactly one sample to the application, no duplicates and no silent
+ * drops. An edge that arrives while the previous read is still on the bus is
+ * counted by MPU6050_DRDY_Missed and does not start a second read.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_drdy.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_drdy && ./test_mpu6050_drdy
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+#define EDGES				200
+
+static MPU6050_Device Dev;
+
+/* @brief Sensor initialized with data ready acquisition, counters cleared */
+static void Setup(void){
+
+	Host_Reset();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	MPU6050_Async_Config();
+	CHECK_EQ(MPU6050_DRDY_Config(&Dev), MPU6050_NO_ERROR);
+	CHECK(Host_Regs[INT_ENABLE] & MPU6050_INT_DATA_RDY);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+}
+
+/* @brief Sample number n in every axis, so a stale or mixed sample is visible */
+static void Put_Sample(int16_t n){
+
+	Host_Set_Sample(n, n + 1, n + 2, n + 3, n + 4, n + 5, n + 6);
+}
+
+static void Check_Sample(const MPU6050_rawData* data, int16_t n){
+
+	CHECK_EQ(data->accelX, n);
+	CHECK_EQ(data->accelY, n + 1);
+	CHECK_EQ(data->accelZ, n + 2);
+	CHECK_EQ(data->temp, n + 3);
+	CHECK_EQ(data->gyroX, n + 4);
+	CHECK_EQ(data->gyroY, n + 5);
+	CHECK_EQ(data->gyroZ, n + 6);
+}
+
+/* Reads finish before the next edge: one read and one sample per edge */
+static void Test_One_Read_Per_Edge(void){
+
+	MPU6050_rawData data;
+	int16_t n;
+
+	Setup();
+
+	for(n = 0; n < EDGES; n++){
+		Put_Sample(n * 10);
+		Host_Advance_Us(1000);
+		Host_DRDY_Edge();
+
+		/* Read is queued from the EXTI handler and runs in I2C interrupts */
+		CHECK_EQ(MPU6050_Async_Pending(), 1);
+		CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 0);
+		CHECK(Host_I2C_Run() > 0);
+		CHECK_EQ(MPU6050_Async_Pending(), 0);
+
+		CHECK_EQ(Host_Bus.reads, n + 1);
+		CHECK_EQ(Host_Bus.lastReadReg, ACCEL_XOUT_H);
+		CHECK_EQ(Host_Bus.lastReadLength, MPU6050_SAMPLE_LENGTH);
+
+		CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 1);
+		Check_Sample(&data, n * 10);
+
+		/* Same sample is not returned twice */
+		CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 0);
+	}
+
+	CHECK_EQ(Host_Bus.stops, EDGES);
+	CHECK_EQ(Host_Bus.bytesRead, EDGES * MPU6050_SAMPLE_LENGTH);
+	CHECK_EQ(MPU6050_DRDY_Missed(), 0);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Edge during a read is dropped and counted, the read in progress is not disturbed */
+static void Test_Edge_During_Read(void){
+
+	MPU6050_rawData data;
+	uint8_t i;
+
+	Setup();
+
+	Put_Sample(100);
+	Host_DRDY_Edge();
+
+	/* Register address, repeated START and a few data bytes */
+	for(i = 0; i < 5; i++) CHECK(Host_I2C_Step());
+	CHECK_EQ(Host_Bus.reads, 1);
+	CHECK_EQ(MPU6050_Async_Pending(), 1);
+
+	Host_DRDY_Edge();
+	CHECK_EQ(MPU6050_DRDY_Missed(), 1);
+	CHECK_EQ(MPU6050_Async_Pending(), 1);
+
+	Host_I2C_Run();
+	CHECK_EQ(Host_Bus.reads, 1);
+	CHECK_EQ(Host_Bus.stops, 1);
+	CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 1);
+	Check_Sample(&data, 100);
+	CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 0);
+
+	/* Next edge reads again */
+	Put_Sample(200);
+	Host_DRDY_Edge();
+	Host_I2C_Run();
+	CHECK_EQ(Host_Bus.reads, 2);
+	CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 1);
+	Check_Sample(&data, 200);
+	CHECK_EQ(MPU6050_DRDY_Missed(), 1);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Block timestamps are the edge times, one entry per edge */
+static void Test_Block_Timestamps(void){
+
+	MPU6050_Block block;
+	MPU6050_rawData data;
+	uint32_t edge[4];
+	uint8_t n;
+
+	Setup();
+	MPU6050_Block_Reset(&block);
+
+	for(n = 0; n < 4; n++){
+		Put_Sample(n);
+		Host_Advance_Us(2000);
+		edge[n] = MPU6050_Time_Us();
+		Host_DRDY_Edge();
+		Host_Advance_Us(300);
+		Host_I2C_Run();
+		CHECK_EQ(MPU6050_DRDY_Get_Block(&block), 1);
+		CHECK_EQ(MPU6050_DRDY_Get_Block(&block), 0);
+	}
+
+	CHECK_EQ(block.count, 4);
+	for(n = 0; n < 4; n++){
+		MPU6050_Block_Get(&block, n, &data);
+		Check_Sample(&data, n);
+		/* Edge time is taken in the EXTI handler, a few polls after edge[n] */
+		CHECK(block.timestamp[n] >= edge[n] && block.timestamp[n] < edge[n] + 50);
+	}
+	CHECK_EQ(MPU6050_DRDY_Missed(), 0);
+}
+
+int main(void){
+
+	Test_One_Read_Per_Edge();
+	Test_Edge_During_Read();
+	Test_Block_Timestamps();
+
+	return TEST_RESULT("test_mpu6050_drdy");
+}
@@ -0,0 +1,270 @@
+/**
+ * @file test_mpu6050_fifo.c
+ * @brief Host test, FIFO drain against the simulated sensor FIFO
+ *
+ * Whole frames are drained in order and decoded by the configured layout,
+ * including auxiliary slave bytes. A frame the sensor has only partly written
+ * stays in the FIFO and is returned whole by the next drain. Only an overflow
+ * or a full FIFO resets it, after which draining starts again on frame
+ * boundaries.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_fifo.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_fifo && ./test_mpu6050_fifo
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+#define MAX_SAMPLES			100
+#define AUX_FRAME			8		//Slave 0 and slave 2 bytes in a frame
+
+static MPU6050_Device Dev;
+static MPU6050_rawData Samples[MAX_SAMPLES];
+static uint8_t Aux[MAX_SAMPLES * AUX_FRAME];
+
+/* @brief Sensor initialized, FIFO writing the given sensors */
+static void Setup(uint8_t sensors){
+
+	Host_Reset();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_FIFO_Config(&Dev, sensors), MPU6050_NO_ERROR);
+	CHECK(Host_Regs[USER_CTRL] & MPU6050_USER_FIFO_EN);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+}
+
+/* @brief Builds frame n as the sensor writes it, big endian, aux bytes last */
+static uint8_t Make_Frame(uint16_t n, uint8_t* frame){
+
+	int16_t values[7];
+	uint8_t len = 0;
+	uint8_t i;
+
+	for(i = 0; i < 7; i++) values[i] = (int16_t)(n * 16 + i);
+
+	if(Dev.fifoSensors & MPU6050_FIFO_ACCEL){
+		for(i = 0; i < 3; i++){
+			frame[len++] = (uint8_t)((uint16_t)values[i] >> 8);
+			frame[len++] = (uint8_t)values[i];
+		}
+	}
+	if(Dev.fifoSensors & MPU6050_FIFO_TEMP){
+		frame[len++] = (uint8_t)((uint16_t)values[3] >> 8);
+		frame[len++] = (uint8_t)values[3];
+	}
+	for(i = 0; i < 3; i++){
+		if(Dev.fifoSensors & (MPU6050_FIFO_XG >> i)){
+			frame[len++] = (uint8_t)((uint16_t)values[4 + i] >> 8);
+			frame[len++] = (uint8_t)values[4 + i];
+		}
+	}
+	for(i = 0; i < Dev.auxFifoLen; i++) frame[len++] = (uint8_t)(n + 100 + i);
+
+	return len;
+}
+
+static void Push_Frames(uint16_t first, uint16_t count){
+
+	uint8_t frame[32];
+	uint16_t n;
+
+	for(n = first; n < first + count; n++) Host_FIFO_Push(frame, Make_Frame(n, frame));
+}
+
+/* @brief Sample holds frame n, sensors not in the FIFO are 0 */
+static void Check_Sample(const MPU6050_rawData* s, uint16_t n){
+
+	uint8_t accel = (Dev.fifoSensors & MPU6050_FIFO_ACCEL) != 0;
+
+	CHECK_EQ(s->accelX, accel ? n * 16 : 0);
+	CHECK_EQ(s->accelY, accel ? n * 16 + 1 : 0);
+	CHECK_EQ(s->accelZ, accel ? n * 16 + 2 : 0);
+	CHECK_EQ(s->temp, (Dev.fifoSensors & MPU6050_FIFO_TEMP) ? n * 16 + 3 : 0);
+	CHECK_EQ(s->gyroX, (Dev.fifoSensors & MPU6050_FIFO_XG) ? n * 16 + 4 : 0);
+	CHECK_EQ(s->gyroY, (Dev.fifoSensors & MPU6050_FIFO_YG) ? n * 16 + 5 : 0);
+	CHECK_EQ(s->gyroZ, (Dev.fifoSensors & MPU6050_FIFO_ZG) ? n * 16 + 6 : 0);
+}
+
+/* Every frame comes out once and in order, in bursts of whole frames */
+static void Test_Drain(void){
+
+	uint16_t num, i;
+
+	Setup(MPU6050_FIFO_ACCEL | MPU6050_FIFO_GYRO);
+	CHECK_EQ(Dev.fifoFrameLen, 12);
+
+	Push_Frames(0, 50);
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 50);
+	for(i = 0; i < num; i++) Check_Sample(&Samples[i], i);
+	CHECK_EQ(Host_FIFO_Count(), 0);
+
+	/* 21 frames fit a 255 byte burst: 21 + 21 + 8 */
+	CHECK_EQ(Host_Bus.lastReadReg, FIFO_R_W);
+	CHECK_EQ(Host_Bus.lastReadLength, 8 * 12);
+
+	/* Less room than frames, the rest stays for the next call */
+	Push_Frames(50, 30);
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, 8, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 8);
+	for(i = 0; i < num; i++) Check_Sample(&Samples[i], 50 + i);
+	CHECK_EQ(Host_FIFO_Count(), 22 * 12);
+
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 22);
+	for(i = 0; i < num; i++) Check_Sample(&Samples[i], 58 + i);
+
+	/* Empty FIFO */
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 0);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Frame being written is left in the FIFO and completed by the sensor */
+static void Test_Partial_Frame(void){
+
+	uint8_t frame[32];
+	uint8_t len, cut;
+	uint16_t num, i;
+
+	Setup(MPU6050_FIFO_ACCEL | MPU6050_FIFO_TEMP | MPU6050_FIFO_GYRO);
+
+	for(cut = 1; cut < Dev.fifoFrameLen; cut += 3){
+		Push_Frames(0, 10);
+		len = Make_Frame(10, frame);
+		Host_FIFO_Push(frame, cut);
+
+		CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+		CHECK_EQ(num, 10);
+		for(i = 0; i < num; i++) Check_Sample(&Samples[i], i);
+		CHECK_EQ(Host_FIFO_Count(), cut);
+
+		/* Rest of the frame and one more, both come out whole */
+		Host_FIFO_Push(frame + cut, len - cut);
+		Push_Frames(11, 1);
+		CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+		CHECK_EQ(num, 2);
+		Check_Sample(&Samples[0], 10);
+		Check_Sample(&Samples[1], 11);
+		CHECK_EQ(Host_FIFO_Count(), 0);
+	}
+}
+
+/* Overflow and a full FIFO reset it, draining goes on from frame boundaries */
+static void Test_Overflow(void){
+
+	static const uint8_t fill[MPU6050_FIFO_SIZE];
+	uint16_t num, i;
+
+	Setup(MPU6050_FIFO_ACCEL | MPU6050_FIFO_GYRO);
+
+	/* Older bytes were lost, the first frame in the FIFO is cut */
+	Push_Frames(0, 90);
+	CHECK(Host_Regs[INT_STATUS] & MPU6050_INT_FIFO_OFLOW);
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_FIFO_OVERFLOW);
+	CHECK_EQ(num, 0);
+	CHECK_EQ(Host_FIFO_Count(), 0);
+	CHECK(Host_Regs[USER_CTRL] & MPU6050_USER_FIFO_EN);
+	CHECK_EQ(Host_Regs[USER_CTRL] & MPU6050_USER_FIFO_RESET, 0);
+
+	Push_Frames(200, 3);
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 3);
+	for(i = 0; i < num; i++) Check_Sample(&Samples[i], 200 + i);
+
+	/* Full to the last byte, the next sample would overflow it */
+	Host_FIFO_Push(fill, MPU6050_FIFO_SIZE);
+	CHECK_EQ(Host_Regs[INT_STATUS] & MPU6050_INT_FIFO_OFLOW, 0);
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_FIFO_OVERFLOW);
+	CHECK_EQ(Host_FIFO_Count(), 0);
+
+	Push_Frames(300, 2);
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 2);
+	Check_Sample(&Samples[0], 300);
+	Check_Sample(&Samples[1], 301);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Auxiliary slave bytes follow the gyro in every frame, slaves outside the FIFO are skipped */
+static void Test_Aux_Layout(void){
+
+	static const MPU6050_AuxSlave slaves[3] = {
+		{0x1E, 0x03, 6, 1},
+		{0x77, 0xF6, 3, 0},
+		{0x0C, 0x10, 2, 1}
+	};
+	static const MPU6050_AuxSlave invalid[5] = {
+		{0x1E, 0x03, 0, 0},
+		{0x1E, 0x03, MPU6050_SLV_LEN_MASK + 1, 0},
+		{0x1E, 0x03, 12, 0},
+		{0x1E, 0x03, 13, 0},
+		{0x1E, 0x03, 1, 0}
+	};
+	MPU6050_Block block;
+	uint32_t now;
+	uint16_t num, i, k;
+
+	Setup(MPU6050_FIFO_ACCEL | MPU6050_FIFO_TEMP | MPU6050_FIFO_GYRO);
+
+	/* Zero or too long slave reads, more than MPU6050_AUX_MAX_BYTES in all or
+	 * too many slaves are refused before the bus is used */
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	CHECK_EQ(MPU6050_Aux_Config_Slaves(&Dev, &invalid[0], 1), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(MPU6050_Aux_Config_Slaves(&Dev, &invalid[1], 1), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(MPU6050_Aux_Config_Slaves(&Dev, &invalid[2], 2), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(MPU6050_Aux_Config_Slaves(&Dev, invalid, MPU6050_AUX_MAX_SLAVES + 1), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(Host_Bus.starts, 0);
+	CHECK_EQ(Dev.auxLen, 0);
+
+	/* FIFO is reconfigured for the new frame layout */
+	CHECK_EQ(MPU6050_Aux_Config_Slaves(&Dev, slaves, 3), MPU6050_NO_ERROR);
+	CHECK_EQ(Dev.auxFifoLen, AUX_FRAME);
+	CHECK_EQ(Dev.fifoFrameLen, 14 + AUX_FRAME);
+	CHECK_EQ(Host_Regs[FIFO_EN], MPU6050_FIFO_ACCEL | MPU6050_FIFO_TEMP | MPU6050_FIFO_GYRO | MPU6050_FIFO_SLV0 | MPU6050_FIFO_SLV2);
+
+	Push_Frames(0, 40);
+	memset(Aux, 0, sizeof(Aux));
+	CHECK_EQ(MPU6050_FIFO_Read_Samples_Aux(&Dev, Samples, Aux, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 40);
+	for(i = 0; i < num; i++){
+		Check_Sample(&Samples[i], i);
+		for(k = 0; k < AUX_FRAME; k++) CHECK_EQ(Aux[i * AUX_FRAME + k], (uint8_t)(i + 100 + k));
+	}
+
+	/* Without an aux buffer the bytes are skipped */
+	Push_Frames(40, 5);
+	CHECK_EQ(MPU6050_FIFO_Read_Samples(&Dev, Samples, MAX_SAMPLES, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 5);
+	for(i = 0; i < num; i++) Check_Sample(&Samples[i], 40 + i);
+
+	/* Block timestamps end at the drain time, one sample period apart */
+	MPU6050_Block_Reset(&block);
+	Push_Frames(45, 6);
+	now = MPU6050_Time_Us();
+	CHECK_EQ(MPU6050_FIFO_Read_Block(&Dev, &block, &num), MPU6050_NO_ERROR);
+	CHECK_EQ(num, 6);
+	CHECK_EQ(block.count, 6);
+	for(i = 0; i < 6; i++){
+		MPU6050_rawData s;
+
+		MPU6050_Block_Get(&block, i, &s);
+		Check_Sample(&s, 45 + i);
+		if(i != 0) CHECK_EQ(block.timestamp[i] - block.timestamp[i - 1], Dev.samplePeriodUs);
+	}
+	CHECK(block.timestamp[5] >= now && block.timestamp[5] < now + 50);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+int main(void){
+
+	Test_Drain();
+	Test_Partial_Frame();
+	Test_Overflow();
+	Test_Aux_Layout();
+
+	return TEST_RESULT("test_mpu6050_fifo");
+}
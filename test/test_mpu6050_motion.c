@@ -0,0 +1,239 @@
+/**
+ * @file test_mpu6050_motion.c
+ * @brief Host test, motion wake-up on the simulated sensor and EXTI line 1
+ *
+ * MPU6050_Motion_Enter must save the registers it changes, arm the motion
+ * interrupt in cycle mode and stop sample reads, MPU6050_Motion_Exit must
+ * write the saved registers back. Wake latency is measured from the motion
+ * edge to the first full-rate sample. A sample read that does not finish
+ * makes MPU6050_Motion_Enter fail without touching the sensor.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_motion.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_motion && ./test_mpu6050_motion
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+/* Simulated time of one WFI and the WFI that gets the motion edge */
+#define SLEEP_US			10000
+#define MOTION_AFTER		3
+
+static MPU6050_Device Dev;
+static uint8_t Sleeps;
+static uint8_t Done;
+static MPU6050_errorstatus Status;
+
+/* @brief Sensor streaming with data ready reads, 8 g range, counters cleared */
+static void Setup(void){
+
+	Host_Reset();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Accel_Set_Range(&Dev, MPU6050_ACCEL_8g), MPU6050_NO_ERROR);
+	MPU6050_Async_Config();
+	CHECK_EQ(MPU6050_DRDY_Config(&Dev), MPU6050_NO_ERROR);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	Sleeps = 0;
+	Done = 0;
+}
+
+/* @brief Registers changed by MPU6050_Motion_Enter */
+static void Save_Regs(uint8_t* regs){
+
+	regs[0] = Host_Regs[ACCEL_CONFIG];
+	regs[1] = Host_Regs[INT_ENABLE];
+	regs[2] = Host_Regs[PWR_MGMT_1];
+	regs[3] = Host_Regs[PWR_MGMT_2];
+}
+
+/* @brief Full-rate sample after a data ready edge */
+static void Check_Sample(int16_t n){
+
+	MPU6050_rawData data;
+
+	Host_Set_Sample(n, 0, 0, 0, 0, 0, 0);
+	Host_DRDY_Edge();
+	Host_I2C_Run();
+	CHECK_EQ(MPU6050_DRDY_Get_Sample(&data), 1);
+	CHECK_EQ(data.accelX, n);
+}
+
+static void Other_Done(MPU6050_errorstatus status){
+
+	Status = status;
+	Done++;
+}
+
+/* Enter arms cycle mode with the motion interrupt, Exit restores streaming */
+static void Test_Enter_Exit(void){
+
+	uint8_t before[4], after[4];
+	MPU6050_Device other;
+
+	Setup();
+	Save_Regs(before);
+
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 100, MPU6050_WAKE_20HZ), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Regs[INT_ENABLE], MPU6050_INT_MOT);
+	CHECK_EQ(Host_Regs[MOT_THR], 100 / MPU6050_MOT_THR_MG);
+	CHECK_EQ(Host_Regs[MOT_DUR], 1);
+	CHECK_EQ(Host_Regs[MOT_DETECT_CTRL], MPU6050_MOT_DETECT_DEFAULT);
+	CHECK_EQ(Host_Regs[ACCEL_CONFIG], MPU6050_ACCEL_8g | MPU6050_ACCEL_HPF_HOLD);
+	CHECK_EQ(Host_Regs[PWR_MGMT_2], MPU6050_WAKE_20HZ | MPU6050_PWR2_STBY_GYRO);
+	CHECK_EQ(Host_Regs[PWR_MGMT_1], MPU6050_PWR1_CYCLE | MPU6050_PWR1_TEMP_DIS | MPU6050_INTERNAL_OSC);
+
+	/* Armed twice, or by a device without data ready, is refused */
+	MPU6050_Device_Init(&other, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 100, MPU6050_WAKE_20HZ), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(MPU6050_Motion_Exit(&other), MPU6050_CONFIG_ERROR);
+
+	/* INT edges in cycle mode are motion, they start no read */
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	Host_DRDY_Edge();
+	Host_DRDY_Edge();
+	CHECK_EQ(Host_Bus.starts, 0);
+	CHECK_EQ(MPU6050_Async_Pending(), 0);
+
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_NO_ERROR);
+	Save_Regs(after);
+	CHECK(memcmp(before, after, sizeof(before)) == 0);
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_CONFIG_ERROR);
+
+	Check_Sample(11);
+	Check_Sample(12);
+	CHECK_EQ(MPU6050_DRDY_Missed(), 0);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+
+	/* Threshold is limited to the MOT_THR range */
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 1, MPU6050_WAKE_1_25HZ), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Regs[MOT_THR], 1);
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 2000, MPU6050_WAKE_40HZ), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Regs[MOT_THR], 0xFF);
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_NO_ERROR);
+	Save_Regs(after);
+	CHECK(memcmp(before, after, sizeof(before)) == 0);
+}
+
+/* Wake latency runs from the motion edge, or from Exit without motion */
+static void Test_Wake_Latency(void){
+
+	Setup();
+
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 100, MPU6050_WAKE_5HZ), MPU6050_NO_ERROR);
+	Host_Advance_Us(1000);
+	Host_DRDY_Edge();
+	Host_Advance_Us(2000);
+
+	/* Later edges do not move the start of the measurement */
+	Host_DRDY_Edge();
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_NO_ERROR);
+	Host_Advance_Us(3000);
+	Check_Sample(21);
+	CHECK(Dev.stats.wakeLatencyUs >= 5000);
+	CHECK(Dev.stats.wakeLatencyUs < 5500);
+
+	/* Only the first sample after Exit is measured */
+	Host_Advance_Us(1000);
+	Check_Sample(22);
+	CHECK(Dev.stats.wakeLatencyUs < 5500);
+
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 100, MPU6050_WAKE_5HZ), MPU6050_NO_ERROR);
+	Host_Advance_Us(4000);
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_NO_ERROR);
+	Host_Advance_Us(2000);
+	Check_Sample(23);
+	CHECK(Dev.stats.wakeLatencyUs >= 2000);
+	CHECK(Dev.stats.wakeLatencyUs < 2500);
+}
+
+/* @brief WFI of the parked MCU, the sensor sees motion after a few sleeps */
+static void Sleep_Hook(void){
+
+	Host_TIM2.CNT += SLEEP_US;
+	Host_Advance_Us(SLEEP_US);
+	if(++Sleeps == MOTION_AFTER) Host_DRDY_Edge();
+}
+
+/* MCU sleeps until the motion edge, time parked and slept is counted */
+static void Test_Park(void){
+
+	Setup();
+	Host_Idle_Hook = Sleep_Hook;
+
+	/* No sample is delivered while the driver waits for it */
+	CHECK_EQ(MPU6050_Motion_Park(&Dev, 100, MPU6050_WAKE_40HZ), MPU6050_WAKE_TIMEOUT);
+	CHECK_EQ(Sleeps, MOTION_AFTER);
+	CHECK_EQ(Host_TIM2.PSC, HOST_CORE_CLOCK_HZ / 1000000 - 1);
+	CHECK_EQ(Dev.stats.parkedUs, MOTION_AFTER * SLEEP_US);
+	CHECK_EQ(Dev.stats.sleepUs, MOTION_AFTER * SLEEP_US);
+	CHECK_EQ(MPU6050_Motion_Duty(&Dev), 0);
+	CHECK_EQ(Host_Regs[INT_ENABLE], MPU6050_INT_DATA_RDY);
+	CHECK_EQ(Host_Regs[PWR_MGMT_1] & MPU6050_PWR1_CYCLE, 0);
+
+	Host_Idle_Hook = 0;
+	Check_Sample(31);
+}
+
+/* Stuck sample read is aborted by the asynchronous deadline, Enter goes on */
+static void Test_Enter_Aborts_Read(void){
+
+	Setup();
+
+	Host_DRDY_Edge();
+	CHECK(Host_I2C_Step());
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 100, MPU6050_WAKE_20HZ), MPU6050_NO_ERROR);
+	CHECK_EQ(Dev.stats.recoveries, 1);
+	CHECK_EQ(MPU6050_DRDY_Missed(), 1);
+	CHECK_EQ(Host_Regs[INT_ENABLE], MPU6050_INT_MOT);
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_NO_ERROR);
+
+	Check_Sample(41);
+}
+
+/* Sample read still queued after MPU6050_TIMEOUT_US, Enter fails and streaming goes on */
+static void Test_Enter_Timeout(void){
+
+	uint8_t before[4], after[4];
+	uint8_t value;
+
+	Setup();
+	Save_Regs(before);
+
+	/* Application request on the bus, the sample read queued behind it */
+	CHECK_EQ(MPU6050_Read_Async(&Dev, WHO_AM_I, &value, 1, Other_Done), MPU6050_NO_ERROR);
+	Host_Set_Sample(51, 0, 0, 0, 0, 0, 0);
+	Host_DRDY_Edge();
+	CHECK_EQ(MPU6050_Async_Pending(), 2);
+
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 100, MPU6050_WAKE_20HZ), MPU6050_I2C_ERROR);
+	Save_Regs(after);
+	CHECK(memcmp(before, after, sizeof(before)) == 0);
+	CHECK_EQ(Done, 1);
+	CHECK_EQ(Status, MPU6050_I2C_ERROR);
+
+	/* Not armed, the queued read completes and edges are data ready again */
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_CONFIG_ERROR);
+	Host_I2C_Run();
+	Check_Sample(52);
+	CHECK_EQ(MPU6050_Async_Pending(), 0);
+
+	CHECK_EQ(MPU6050_Motion_Enter(&Dev, 100, MPU6050_WAKE_20HZ), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Motion_Exit(&Dev), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+int main(void){
+
+	Test_Enter_Exit();
+	Test_Wake_Latency();
+	Test_Park();
+	Test_Enter_Aborts_Read();
+	Test_Enter_Timeout();
+
+	return TEST_RESULT("test_mpu6050_motion");
+}
@@ -0,0 +1,175 @@
+/**
+ * @file test_mpu6050_recover.c
+ * @brief Host test, bus recovery and the cycle counter time base
+ *
+ * MPU6050_Bus_Recover must clock at most nine SCL pulses while the slave holds
+ * SDA low, end with a STOP condition, software reset I2C1, give the pins back
+ * with their complete configuration and write the shadow registers back to a
+ * sensor that lost them. Transfer timeouts must work right after
+ * MPU6050_Device_Init, before the sensor is initialized.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_recover.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_recover && ./test_mpu6050_recover
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+static MPU6050_Device Dev;
+
+/* @brief Sensor initialized, I2C pins in their alternate function setup */
+static void Setup(void){
+
+	GPIO_InitTypeDef GPIO_InitStructure;
+
+	Host_Reset();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+
+	/* Neighbour pins in other modes, recovery must not touch them */
+	GPIO_InitStructure.GPIO_Pin = GPIO_Pin_7 | GPIO_Pin_10;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_OUT;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_10MHz;
+	GPIO_InitStructure.GPIO_OType = GPIO_OType_PP;
+	GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_DOWN;
+	GPIO_Init(MPU6050_Bus1.GPIOx, &GPIO_InitStructure);
+
+	/* Slow open drain outputs without pull-up, unlike the recovery setup */
+	GPIO_InitStructure.GPIO_Pin = MPU6050_Bus1.sclPin | MPU6050_Bus1.sdaPin;
+	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF;
+	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_Level_1;
+	GPIO_InitStructure.GPIO_OType = GPIO_OType_OD;
+	GPIO_InitStructure.GPIO_PuPd = GPIO_PuPd_NOPULL;
+	GPIO_Init(MPU6050_Bus1.GPIOx, &GPIO_InitStructure);
+
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+}
+
+/* @brief All four pin configuration registers are as before the recovery */
+static void Check_Pins(const GPIO_TypeDef* before){
+
+	CHECK_EQ(MPU6050_Bus1.GPIOx->MODER, before->MODER);
+	CHECK_EQ(MPU6050_Bus1.GPIOx->OTYPER, before->OTYPER);
+	CHECK_EQ(MPU6050_Bus1.GPIOx->OSPEEDR, before->OSPEEDR);
+	CHECK_EQ(MPU6050_Bus1.GPIOx->PUPDR, before->PUPDR);
+}
+
+/* Slave that never lets go gets nine pulses, then the STOP and the reset */
+static void Test_Nine_Pulses(void){
+
+	GPIO_TypeDef before;
+
+	Setup();
+	before = *MPU6050_Bus1.GPIOx;
+
+	Host_Hold_SDA(255);
+	MPU6050_Bus_Recover(&Dev);
+	Host_Hold_SDA(0);
+
+	CHECK_EQ(Host_Bus.sclPulses, 9);
+	CHECK_EQ(Host_Bus.gpioStops, 1);
+	CHECK_EQ(Host_Bus.softwareResets, 1);
+	CHECK(Host_I2C1.CR1 & I2C_CR1_PE);
+	Check_Pins(&before);
+
+	/* Nine 10 us pulses and the STOP */
+	CHECK_EQ(Dev.stats.recoveries, 1);
+	CHECK(Dev.stats.lastRecoveryUs >= 110);
+	CHECK_EQ(Dev.stats.maxRecoveryUs, Dev.stats.lastRecoveryUs);
+}
+
+/* Pulses stop as soon as SDA is released, a free bus only gets the STOP */
+static void Test_Released_Early(void){
+
+	GPIO_TypeDef before;
+	uint32_t first;
+
+	Setup();
+	before = *MPU6050_Bus1.GPIOx;
+
+	Host_Hold_SDA(3);
+	MPU6050_Bus_Recover(&Dev);
+	CHECK_EQ(Host_Bus.sclPulses, 3);
+	CHECK_EQ(Host_Bus.gpioStops, 1);
+	Check_Pins(&before);
+	first = Dev.stats.lastRecoveryUs;
+
+	MPU6050_Bus_Recover(&Dev);
+	CHECK_EQ(Host_Bus.sclPulses, 3);
+	CHECK_EQ(Host_Bus.gpioStops, 2);
+	CHECK_EQ(Host_Bus.softwareResets, 2);
+	Check_Pins(&before);
+
+	CHECK_EQ(Dev.stats.recoveries, 2);
+	CHECK(Dev.stats.lastRecoveryUs < first);
+	CHECK_EQ(Dev.stats.maxRecoveryUs, first);
+}
+
+/* Configuration lost by the sensor is written back from the shadow */
+static void Test_Shadow_Restore(void){
+
+	uint8_t config[4];
+
+	Setup();
+	CHECK_EQ(MPU6050_Gyro_Set_Range(&Dev, MPU6050_GYRO_1000), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Accel_Set_Range(&Dev, MPU6050_ACCEL_8g), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, SMPLRT_DIV, 9), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, INT_ENABLE, MPU6050_INT_DATA_RDY), MPU6050_NO_ERROR);
+	memcpy(config, &Host_Regs[SMPLRT_DIV], 4);
+
+	/* Sensor reset to its power-on values while the bus hung */
+	memset(&Host_Regs[SMPLRT_DIV], 0, 4);
+	Host_Regs[INT_ENABLE] = 0;
+	Host_Regs[PWR_MGMT_1] = 0x40;
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+
+	Host_Hold_SDA(5);
+	MPU6050_Bus_Recover(&Dev);
+
+	CHECK(memcmp(&Host_Regs[SMPLRT_DIV], config, 4) == 0);
+	CHECK_EQ(Host_Regs[GYRO_CONFIG], MPU6050_GYRO_1000);
+	CHECK_EQ(Host_Regs[ACCEL_CONFIG], MPU6050_ACCEL_8g);
+	CHECK_EQ(Host_Regs[INT_ENABLE], MPU6050_INT_DATA_RDY);
+	CHECK_EQ(Host_Regs[PWR_MGMT_1] & MPU6050_PWR1_SLEEP, 0);
+
+	/* Restore runs on the reset peripheral, after the GPIO STOP */
+	CHECK(Host_Bus.writes > 0);
+	CHECK_EQ(Host_Bus.sclPulses, 5);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Cycle counter runs after MPU6050_Device_Init, a transfer to an absent sensor times out */
+static void Test_Timeout_Before_Init(void){
+
+	MPU6050_Device absent, spi;
+	uint8_t value;
+	uint32_t start;
+
+	Host_Reset();
+	CHECK_EQ(Host_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk, 0);
+
+	MPU6050_Device_Init(&absent, &MPU6050_Bus1, MPU6050_ADDRESS_AD0_HIGH);
+	CHECK(Host_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk);
+	CHECK(Host_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk);
+
+	start = Host_DWT.CYCCNT;
+	CHECK(MPU6050_Read(&absent, WHO_AM_I, &value, 1) != MPU6050_NO_ERROR);
+	CHECK(Host_DWT.CYCCNT - start >= MPU6050_TIMEOUT_US * (HOST_CORE_CLOCK_HZ / 1000000));
+
+	Host_Reset();
+	MPU6050_Device_Init_SPI(&spi, &MPU6050_SPI_Bus2, GPIOB, GPIO_Pin_12);
+	CHECK(Host_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk);
+}
+
+int main(void){
+
+	Test_Nine_Pulses();
+	Test_Released_Early();
+	Test_Shadow_Restore();
+	Test_Timeout_Before_Init();
+
+	return TEST_RESULT("test_mpu6050_recover");
+}
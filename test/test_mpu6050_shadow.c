@@ -0,0 +1,216 @@
+/**
+ * @file test_mpu6050_shadow.c
+ * @brief Host test, register shadow of the configuration registers
+ *
+ * Once the shadow of a register is valid its getters do not touch the bus and
+ * a write of the value it already holds is skipped. A failed write leaves the
+ * register content unknown, the next read goes to the sensor. After the
+ * sensor lost its registers MPU6050_Shadow_Resync reads them back in bursts.
+ *
+ *	gcc -std=gnu99 -Wall -Wno-pointer-to-int-cast -DUSE_STDPERIPH_DRIVER -Icmsis -Icmsis_boot -Icmsis_lib/include \
+ *		-Itest/host -include stm32_host.h test/test_mpu6050_shadow.c test/host/stm32_host.c cmsis_lib/source/mpu6050.c \
+ *		-o test_mpu6050_shadow && ./test_mpu6050_shadow
+ */
+
+#include <string.h>
+#include "mpu6050.h"
+#include "stm32_host.h"
+#include "test.h"
+
+static MPU6050_Device Dev;
+
+/* @brief Sensor initialized, bus counters cleared */
+static void Setup(void){
+
+	Host_Reset();
+	MPU6050_Device_Init(&Dev, &MPU6050_Bus1, MPU6050_ADDRESS);
+	CHECK_EQ(MPU6050_Initialization(&Dev), MPU6050_NO_ERROR);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+}
+
+/* @brief Write sent to a slave that does not answer, as if the sensor dropped off the bus */
+static MPU6050_errorstatus Write_Absent(uint8_t RegAddr, const uint8_t* values, uint8_t count){
+
+	MPU6050_errorstatus errorstatus;
+
+	Dev.address = MPU6050_ADDRESS_AD0_HIGH;
+	errorstatus = (count == 1) ? MPU6050_Write_Reg(&Dev, RegAddr, values[0]) : MPU6050_Write_Regs(&Dev, RegAddr, values, count);
+	Dev.address = MPU6050_ADDRESS;
+	return errorstatus;
+}
+
+/* Getters read a register once, then serve it from RAM */
+static void Test_Getters(void){
+
+	uint8_t value;
+
+	Setup();
+
+	CHECK_EQ(MPU6050_Gyro_Get_Range(&Dev), Host_Regs[GYRO_CONFIG] & MPU6050_RANGE_MASK);
+	CHECK_EQ(MPU6050_Accel_Get_Range(&Dev), Host_Regs[ACCEL_CONFIG] & MPU6050_RANGE_MASK);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, SMPLRT_DIV, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, Host_Regs[SMPLRT_DIV]);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, PWR_MGMT_1, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, Host_Regs[PWR_MGMT_1]);
+	CHECK_EQ(Host_Bus.starts, 0);
+
+	/* Not written by the initialization, the first read goes to the sensor */
+	Host_Regs[INT_PIN_CFG] = 0x30;
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, INT_PIN_CFG, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, 0x30);
+	CHECK_EQ(Host_Bus.reads, 1);
+	CHECK_EQ(Host_Bus.lastReadReg, INT_PIN_CFG);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, INT_PIN_CFG, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, 0x30);
+	CHECK_EQ(Host_Bus.reads, 1);
+
+	/* Registers outside the shadow are read every time */
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, WHO_AM_I, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, WHO_AM_I, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, 0x68);
+	CHECK_EQ(Host_Bus.reads, 3);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Write of the value a register already holds is skipped */
+static void Test_Unchanged_Write(void){
+
+	uint8_t values[4] = {4, 3, MPU6050_GYRO_500, MPU6050_ACCEL_4g};
+
+	Setup();
+
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, SMPLRT_DIV, Host_Regs[SMPLRT_DIV]), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Gyro_Set_Range(&Dev, MPU6050_GYRO_250), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Modify_Reg(&Dev, PWR_MGMT_1, MPU6050_PWR1_SLEEP, 0), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.starts, 0);
+
+	/* New value is sent once */
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, SMPLRT_DIV, 19), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, SMPLRT_DIV, 19), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Regs[SMPLRT_DIV], 19);
+	CHECK_EQ(Host_Bus.writes, 1);
+
+	/* Bursts are always sent and fill the shadow */
+	CHECK_EQ(MPU6050_Write_Regs(&Dev, SMPLRT_DIV, values, 4), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.writes, 2);
+	CHECK(memcmp(&Host_Regs[SMPLRT_DIV], values, 4) == 0);
+	CHECK_EQ(MPU6050_Gyro_Get_Range(&Dev), MPU6050_GYRO_500);
+	CHECK_EQ(MPU6050_Accel_Get_Range(&Dev), MPU6050_ACCEL_4g);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, CONFIG, 3), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.writes, 2);
+	CHECK_EQ(Host_Bus.reads, 0);
+
+	/* Registers outside the shadow are written every time */
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, MOT_THR, 20), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, MOT_THR, 20), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.writes, 4);
+
+	/* Empty or oversized burst is refused before the bus is used */
+	CHECK_EQ(MPU6050_Write_Regs(&Dev, SMPLRT_DIV, values, 0), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(MPU6050_Write_Regs(&Dev, SMPLRT_DIV, values, MPU6050_WRITE_BURST_MAX + 1), MPU6050_CONFIG_ERROR);
+	CHECK_EQ(Host_Bus.writes, 4);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Failed write invalidates the entry, the next read and write go to the sensor */
+static void Test_Failed_Write(void){
+
+	uint8_t values[4] = {9, 1, MPU6050_GYRO_2000, MPU6050_ACCEL_16g};
+	uint8_t before[4];
+	uint8_t value;
+
+	Setup();
+	memcpy(before, &Host_Regs[SMPLRT_DIV], 4);
+
+	CHECK(Write_Absent(SMPLRT_DIV, values, 1) != MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Regs[SMPLRT_DIV], before[0]);
+
+	/* Restore to the absent slave failed too, the bus was released again */
+	CHECK_EQ(Dev.stats.recoveries, 1);
+	CHECK_EQ(Host_Bus.softwareResets, 2);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, SMPLRT_DIV, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, before[0]);
+	CHECK_EQ(Host_Bus.reads, 1);
+
+	/* Value the sensor may or may not hold is written again */
+	Setup();
+	CHECK(Write_Absent(SMPLRT_DIV, values, 1) != MPU6050_NO_ERROR);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, SMPLRT_DIV, before[0]), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.writes, 1);
+
+	/* Failed burst invalidates every register it covers, and no other */
+	Setup();
+	CHECK(Write_Absent(SMPLRT_DIV, values, 4) != MPU6050_NO_ERROR);
+	CHECK(memcmp(&Host_Regs[SMPLRT_DIV], before, 4) == 0);
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+
+	CHECK_EQ(MPU6050_Gyro_Get_Range(&Dev), before[2] & MPU6050_RANGE_MASK);
+	CHECK_EQ(MPU6050_Accel_Get_Range(&Dev), before[3] & MPU6050_RANGE_MASK);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, CONFIG, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.reads, 3);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, PWR_MGMT_1, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.reads, 3);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+/* Sensor reset behind the driver's back, the resync reads the registers back */
+static void Test_Resync(void){
+
+	uint8_t value;
+
+	Setup();
+	CHECK_EQ(MPU6050_Gyro_Set_Range(&Dev, MPU6050_GYRO_1000), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, INT_ENABLE, MPU6050_INT_DATA_RDY), MPU6050_NO_ERROR);
+
+	/* Power-on values, the shadow does not know */
+	memset(&Host_Regs[SMPLRT_DIV], 0, 4);
+	Host_Regs[INT_ENABLE] = 0;
+	Host_Regs[PWR_MGMT_1] = 0x40;
+	Host_Regs[PWR_MGMT_2] = 0;
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	CHECK_EQ(MPU6050_Gyro_Get_Range(&Dev), MPU6050_GYRO_1000);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, INT_ENABLE, MPU6050_INT_DATA_RDY), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.starts, 0);
+
+	/* One burst per run of consecutive registers, four in all */
+	CHECK_EQ(MPU6050_Shadow_Resync(&Dev), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.reads, 4);
+	CHECK_EQ(Host_Bus.bytesRead, MPU6050_SHADOW_SIZE);
+
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	CHECK_EQ(MPU6050_Gyro_Get_Range(&Dev), MPU6050_GYRO_250);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, PWR_MGMT_1, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, 0x40);
+	CHECK_EQ(MPU6050_Read_Reg(&Dev, INT_ENABLE, &value), MPU6050_NO_ERROR);
+	CHECK_EQ(value, 0);
+	CHECK_EQ(Host_Bus.starts, 0);
+
+	/* Lost configuration is written again */
+	CHECK_EQ(MPU6050_Gyro_Set_Range(&Dev, MPU6050_GYRO_1000), MPU6050_NO_ERROR);
+	CHECK_EQ(MPU6050_Write_Reg(&Dev, INT_ENABLE, MPU6050_INT_DATA_RDY), MPU6050_NO_ERROR);
+	CHECK_EQ(Host_Bus.writes, 2);
+	CHECK_EQ(Host_Regs[GYRO_CONFIG], MPU6050_GYRO_1000);
+	CHECK_EQ(Host_Regs[INT_ENABLE], MPU6050_INT_DATA_RDY);
+
+	/* Failed resync leaves nothing valid */
+	Dev.address = MPU6050_ADDRESS_AD0_HIGH;
+	CHECK(MPU6050_Shadow_Resync(&Dev) != MPU6050_NO_ERROR);
+	Dev.address = MPU6050_ADDRESS;
+	memset(&Host_Bus, 0, sizeof(Host_Bus));
+	CHECK_EQ(MPU6050_Gyro_Get_Range(&Dev), MPU6050_GYRO_1000);
+	CHECK_EQ(Host_Bus.reads, 1);
+	CHECK_EQ(Host_Bus.protocolErrors, 0);
+}
+
+int main(void){
+
+	Test_Getters();
+	Test_Unchanged_Write();
+	Test_Failed_Write();
+	Test_Resync();
+
+	return TEST_RESULT("test_mpu6050_shadow");
+}
@@ -0,0 +1,439 @@
+/**
+ * @file mpu6050_calfit.cpp
+ * @brief Host tool, accelerometer calibration from raw captures by ellipsoid fit
+ *
+ * Each input file is the log of one board, one raw sample per line as printed
+ * from MPU6050_Get_Accel_Data_Raw, e.g. printf("%d %d %d\n", X, Y, Z), with
+ * the board held still in many orientations. Spaces, tabs, commas and
+ * semicolons separate the values, other lines are skipped.
+ *
+ * For every log a quadric is fitted by linear least squares, its center is the
+ * offset and the symmetric square root of its shape matrix the scale and
+ * misalignment correction. The result is written next to the log as <log>.cal,
+ * a blob in the MPU6050_Calib_Params layout of mpu6050_calib_params.h, gyro part left
+ * at identity. Logs are processed in parallel on a thread pool.
+ *
+ *	g++ -std=c++11 -O2 -pthread -Icmsis_lib/include tools/mpu6050_calfit.cpp -o mpu6050_calfit
+ *	./mpu6050_calfit [-j threads] [-g lsb_per_g] board1.txt board2.txt ...
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mpu6050_calib_params.h"
+
+/* Default LSB per g, 2 g range */
+#define CALFIT_LSB_PER_G			16384.0
+
+/* Fewest samples accepted for a fit */
+#define CALFIT_MIN_SAMPLES			50
+
+/* Result of one board */
+struct Calfit_Result{
+
+	std::string path;
+	bool ok;
+	std::string error;
+	size_t samples;
+	int16_t offset[3];
+	int16_t matrix[9];
+	double rms;				//RMS of the remaining magnitude error, g
+};
+
+/* @brief Fixed size pool of worker threads running queued jobs */
+class Calfit_Pool{
+
+public:
+
+	explicit Calfit_Pool(unsigned threads) : stop(false){
+
+		for(unsigned i = 0; i < threads; i++){
+			workers.emplace_back([this]{ run(); });
+		}
+	}
+
+	~Calfit_Pool(){
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		cond.notify_all();
+		for(std::thread& t : workers) t.join();
+	}
+
+	void submit(std::function<void()> job){
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push(std::move(job));
+		}
+		cond.notify_one();
+	}
+
+private:
+
+	/* @brief Worker loop, leaves once stopped and the queue is empty */
+	void run(){
+
+		std::function<void()> job;
+
+		for(;;){
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cond.wait(lock, [this]{ return stop || !jobs.empty(); });
+				if(jobs.empty()) return;
+				job = std::move(jobs.front());
+				jobs.pop();
+			}
+			job();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::queue<std::function<void()> > jobs;
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool stop;
+};
+
+/* @brief Read raw X, Y, Z triplets of a log
+ * @retval false if the file can not be opened
+ */
+static bool Calfit_Load(const std::string& path, std::vector<double>& samples){
+
+	std::ifstream in(path.c_str());
+	std::string line;
+	long x, y, z;
+
+	if(!in) return false;
+
+	while(std::getline(in, line)){
+		for(char& c : line){
+			if(c == ',' || c == ';' || c == '\t') c = ' ';
+		}
+		std::istringstream fields(line);
+		if(!(fields >> x >> y >> z)) continue;
+		if(x < -32768 || x > 32767 || y < -32768 || y > 32767 || z < -32768 || z > 32767) continue;
+		samples.push_back((double)x);
+		samples.push_back((double)y);
+		samples.push_back((double)z);
+	}
+	return true;
+}
+
+/* @brief Solve a * x = b by Gaussian elimination with partial pivoting, a is n x n row major
+ * @retval false if a is singular
+ */
+static bool Calfit_Solve(std::vector<double> a, std::vector<double> b, int n, double* x){
+
+	int r, c, k, p;
+
+	for(c = 0; c < n; c++){
+		p = c;
+		for(r = c + 1; r < n; r++){
+			if(std::fabs(a[r * n + c]) > std::fabs(a[p * n + c])) p = r;
+		}
+		if(std::fabs(a[p * n + c]) < 1e-300) return false;
+		if(p != c){
+			for(k = 0; k < n; k++) std::swap(a[p * n + k], a[c * n + k]);
+			std::swap(b[p], b[c]);
+		}
+		for(r = c + 1; r < n; r++){
+			double f = a[r * n + c] / a[c * n + c];
+			for(k = c; k < n; k++) a[r * n + k] -= f * a[c * n + k];
+			b[r] -= f * b[c];
+		}
+	}
+	for(r = n - 1; r >= 0; r--){
+		double s = b[r];
+		for(k = r + 1; k < n; k++) s -= a[r * n + k] * x[k];
+		x[r] = s / a[r * n + r];
+	}
+	return true;
+}
+
+/* @brief Eigen decomposition of a symmetric 3x3 matrix by Jacobi rotations
+ * @param a - matrix, row major, destroyed
+ * @param v - eigenvectors as columns
+ * @param d - eigenvalues
+ */
+static void Calfit_Eigen(double a[9], double v[9], double d[3]){
+
+	int sweep, p, q, k;
+
+	for(k = 0; k < 9; k++) v[k] = (k % 4 == 0) ? 1.0 : 0.0;
+
+	for(sweep = 0; sweep < 50; sweep++){
+		double off = a[1] * a[1] + a[2] * a[2] + a[5] * a[5];
+		if(off < 1e-30) break;
+
+		for(p = 0; p < 2; p++){
+			for(q = p + 1; q < 3; q++){
+				double apq = a[p * 3 + q];
+				if(std::fabs(apq) < 1e-300) continue;
+
+				double theta = (a[q * 3 + q] - a[p * 3 + p]) / (2 * apq);
+				double t = (theta >= 0 ? 1.0 : -1.0) / (std::fabs(theta) + std::sqrt(theta * theta + 1));
+				double c = 1 / std::sqrt(t * t + 1);
+				double s = t * c;
+
+				for(k = 0; k < 3; k++){
+					double akp = a[k * 3 + p], akq = a[k * 3 + q];
+					a[k * 3 + p] = c * akp - s * akq;
+					a[k * 3 + q] = s * akp + c * akq;
+				}
+				for(k = 0; k < 3; k++){
+					double apk = a[p * 3 + k], aqk = a[q * 3 + k];
+					a[p * 3 + k] = c * apk - s * aqk;
+					a[q * 3 + k] = s * apk + c * aqk;
+				}
+				for(k = 0; k < 3; k++){
+					double vkp = v[k * 3 + p], vkq = v[k * 3 + q];
+					v[k * 3 + p] = c * vkp - s * vkq;
+					v[k * 3 + q] = s * vkp + c * vkq;
+				}
+			}
+		}
+	}
+
+	d[0] = a[0];
+	d[1] = a[4];
+	d[2] = a[8];
+}
+
+/* @brief Fit an ellipsoid to one board's samples
+ * Quadric A x^2 + B y^2 + C z^2 + 2D xy + 2E xz + 2F yz + 2G x + 2H y + 2I z = 1
+ * is solved from the normal equations. With Q = [A D E; D B F; E F C] the center
+ * is c = -Q^-1 [G H I], and W = g * sqrtm(Q / k), k = 1 + c' Q c, maps the
+ * ellipsoid onto a sphere of radius g, so out = W * (raw - c).
+ */
+static void Calfit_Fit(const std::vector<double>& samples, double lsbPerG, Calfit_Result& result){
+
+	const size_t n = samples.size() / 3;
+	std::vector<double> ata(81, 0.0), atb(9, 0.0);
+	double p[9], q[9], v[9], d[3], w[9], center[3];
+	double scale = 1.0, k, sum;
+	size_t i;
+	int r, c, j;
+
+	result.samples = n;
+	if(n < CALFIT_MIN_SAMPLES){
+		result.error = "too few samples";
+		return;
+	}
+
+	/* Samples are normalized to about 1 to keep the normal equations well conditioned */
+	for(i = 0; i < samples.size(); i++) scale = std::max(scale, std::fabs(samples[i]));
+
+	for(i = 0; i < n; i++){
+		double x = samples[3 * i] / scale, y = samples[3 * i + 1] / scale, z = samples[3 * i + 2] / scale;
+		double row[9] = {x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z};
+		for(r = 0; r < 9; r++){
+			for(c = 0; c < 9; c++) ata[r * 9 + c] += row[r] * row[c];
+			atb[r] += row[r];
+		}
+	}
+
+	if(!Calfit_Solve(ata, atb, 9, p)){
+		result.error = "orientations do not cover the sphere";
+		return;
+	}
+
+	double quad[9] = {p[0], p[3], p[4], p[3], p[1], p[5], p[4], p[5], p[2]};
+	std::vector<double> qa(quad, quad + 9), qb(3);
+	qb[0] = -p[6];
+	qb[1] = -p[7];
+	qb[2] = -p[8];
+	if(!Calfit_Solve(qa, qb, 3, center)){
+		result.error = "degenerate fit";
+		return;
+	}
+
+	k = 1;
+	for(r = 0; r < 3; r++){
+		for(c = 0; c < 3; c++) k += center[r] * quad[r * 3 + c] * center[c];
+	}
+	for(j = 0; j < 9; j++) q[j] = quad[j] / k;
+
+	Calfit_Eigen(q, v, d);
+	for(j = 0; j < 3; j++){
+		if(!(d[j] > 0)){
+			result.error = "fit is not an ellipsoid";
+			return;
+		}
+		d[j] = std::sqrt(d[j]);
+	}
+
+	/* W = g * V sqrt(D) V', raw units are restored with 1/scale */
+	for(r = 0; r < 3; r++){
+		for(c = 0; c < 3; c++){
+			sum = 0;
+			for(j = 0; j < 3; j++) sum += v[r * 3 + j] * d[j] * v[c * 3 + j];
+			w[r * 3 + c] = sum * lsbPerG / scale;
+		}
+	}
+
+	for(r = 0; r < 3; r++){
+		double o = std::floor(center[r] * scale + 0.5);
+		if(o < -32768 || o > 32767){
+			result.error = "offset out of range";
+			return;
+		}
+		result.offset[r] = (int16_t)o;
+
+		/* Firmware rejects rows whose coefficient magnitudes add up to 4.0 */
+		sum = 0;
+		for(c = 0; c < 3; c++){
+			double m = std::floor(w[r * 3 + c] * MPU6050_MATRIX_ONE + 0.5);
+			result.matrix[r * 3 + c] = (int16_t)std::max(-32768.0, std::min(32767.0, m));
+			sum += std::fabs(m);
+		}
+		if(sum >= 4.0 * MPU6050_MATRIX_ONE){
+			result.error = "scale out of range, check -g";
+			return;
+		}
+	}
+
+	/* Residual with the quantized parameters */
+	sum = 0;
+	for(i = 0; i < n; i++){
+		double e = 0;
+		for(r = 0; r < 3; r++){
+			double o = 0;
+			for(c = 0; c < 3; c++){
+				o += result.matrix[r * 3 + c] * (samples[3 * i + c] - result.offset[c]);
+			}
+			o /= MPU6050_MATRIX_ONE;
+			e += o * o;
+		}
+		e = std::sqrt(e) / lsbPerG - 1;
+		sum += e * e;
+	}
+	result.rms = std::sqrt(sum / n);
+	result.ok = true;
+}
+
+/* @brief Write the MPU6050_Calib_Params blob, little endian
+ * @retval false on a write error
+ */
+static bool Calfit_Write(const std::string& path, const Calfit_Result& result){
+
+	uint8_t blob[MPU6050_CALIB_PARAMS_SIZE];
+	uint16_t words[MPU6050_CALIB_PARAMS_SIZE / 2];
+	int k, n = 0;
+	FILE* f;
+
+	words[n++] = MPU6050_CALIB_MAGIC;
+	for(k = 0; k < 3; k++) words[n++] = (uint16_t)result.offset[k];
+	for(k = 0; k < 9; k++) words[n++] = (uint16_t)result.matrix[k];
+	for(k = 0; k < 3; k++) words[n++] = 0;
+	for(k = 0; k < 9; k++) words[n++] = (k % 4 == 0) ? MPU6050_MATRIX_ONE : 0;
+
+	for(k = 0; k < n; k++){
+		blob[2 * k] = (uint8_t)(words[k] & 0xFF);
+		blob[2 * k + 1] = (uint8_t)(words[k] >> 8);
+	}
+
+	f = std::fopen(path.c_str(), "wb");
+	if(f == NULL) return false;
+	if(std::fwrite(blob, 1, sizeof(blob), f) != sizeof(blob)){
+		std::fclose(f);
+		return false;
+	}
+	return std::fclose(f) == 0;
+}
+
+/* @brief Load, fit and write one board */
+static void Calfit_Board(Calfit_Result& result, double lsbPerG){
+
+	std::vector<double> samples;
+
+	if(!Calfit_Load(result.path, samples)){
+		result.error = "can not open";
+		return;
+	}
+
+	Calfit_Fit(samples, lsbPerG, result);
+	if(!result.ok) return;
+
+	if(!Calfit_Write(result.path + ".cal", result)){
+		result.ok = false;
+		result.error = "can not write " + result.path + ".cal";
+	}
+}
+
+static void Calfit_Usage(void){
+
+	std::fprintf(stderr, "usage: mpu6050_calfit [-j threads] [-g lsb_per_g] log...\n");
+}
+
+int main(int argc, char** argv){
+
+	unsigned threads = std::thread::hardware_concurrency();
+	double lsbPerG = CALFIT_LSB_PER_G;
+	std::vector<Calfit_Result> results;
+	int failed = 0;
+	int i, k;
+
+	if(threads == 0) threads = 1;
+
+	for(i = 1; i < argc; i++){
+		if(std::strcmp(argv[i], "-j") == 0 && i + 1 < argc){
+			threads = (unsigned)std::max(1, std::atoi(argv[++i]));
+		}else if(std::strcmp(argv[i], "-g") == 0 && i + 1 < argc){
+			lsbPerG = std::atof(argv[++i]);
+		}else if(argv[i][0] == '-'){
+			Calfit_Usage();
+			return 2;
+		}else{
+			Calfit_Result r;
+			r.path = argv[i];
+			r.ok = false;
+			r.samples = 0;
+			r.rms = 0;
+			results.push_back(r);
+		}
+	}
+
+	if(results.empty() || !(lsbPerG > 0)){
+		Calfit_Usage();
+		return 2;
+	}
+
+	/* Results are preallocated, each job only touches its own entry */
+	{
+		Calfit_Pool pool(std::min<size_t>(threads, results.size()));
+		for(Calfit_Result& r : results){
+			Calfit_Result* p = &r;
+			pool.submit([p, lsbPerG]{ Calfit_Board(*p, lsbPerG); });
+		}
+	}
+
+	for(const Calfit_Result& r : results){
+		if(!r.ok){
+			std::printf("%s: %s (%zu samples)\n", r.path.c_str(), r.error.c_str(), r.samples);
+			failed++;
+			continue;
+		}
+		std::printf("%s: %zu samples, rms %.4f g\n", r.path.c_str(), r.samples, r.rms);
+		std::printf("\t{MPU6050_CALIB_MAGIC, {%d, %d, %d}, {", r.offset[0], r.offset[1], r.offset[2]);
+		for(k = 0; k < 9; k++) std::printf(k ? ", %d" : "%d", r.matrix[k]);
+		std::printf("}, {0, 0, 0}, {%d, 0, 0, 0, %d, 0, 0, 0, %d}}\n", MPU6050_MATRIX_ONE, MPU6050_MATRIX_ONE, MPU6050_MATRIX_ONE);
+	}
+
+	return failed ? 1 : 0;
+}